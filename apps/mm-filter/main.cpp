@@ -62,6 +62,39 @@ struct Cli
         "\"NAME|NEW_NAME\"",
         cmd};
 
+    TCLAP::ValueArg<double> argTileSize{
+        "",
+        "tile-size",
+        "If provided, the pipeline is applied in tiled mode: point layers are "
+        "split into square XY tiles of this size [m], filtered in parallel, "
+        "and stitched together. Only for spatially local filters. See "
+        "mp2p_icp_filters::apply_filter_pipeline_tiled()",
+        false,
+        100.0,
+        "100.0",
+        cmd};
+
+    TCLAP::ValueArg<double> argTileHalo{
+        "",
+        "tile-halo",
+        "For --tile-size: margin [m] around each tile also passed to its "
+        "filters. It must be larger than the neighborhood radius used by any "
+        "filter (Default: 5.0)",
+        false,
+        5.0,
+        "5.0",
+        cmd};
+
+    TCLAP::ValueArg<size_t> argTilesPerBatch{
+        "",
+        "tiles-per-batch",
+        "For --tile-size: number of tiles processed in parallel at once. "
+        "Lower values reduce peak memory usage (Default: 32)",
+        false,
+        32,
+        "32",
+        cmd};
+
     TCLAP::ValueArg<std::string> arg_verbosity_level{
         "v",
         "verbosity",
@@ -114,13 +147,40 @@ void run_mm_filter(Cli& cli)
 
     if (cli.argPipeline.isSet())
     {
-        const auto pipeline = mp2p_icp_filters::filter_pipeline_from_yaml_file(
-            cli.argPipeline.getValue(), logLevel);
-
-        // Apply:
-        std::cout << "[mm-filter] Applying filter pipeline..." << std::endl;
-
-        mp2p_icp_filters::apply_filter_pipeline(pipeline, mm);
+        if (cli.argTileSize.isSet())
+        {
+            const auto yamlContent =
+                mrpt::containers::yaml::FromFile(cli.argPipeline.getValue());
+            ASSERT_(
+                yamlContent.has("filters") &&
+                yamlContent["filters"].isSequence());
+
+            mp2p_icp_filters::tiled_pipeline_options_t opts;
+            opts.tile_size       = cli.argTileSize.getValue();
+            opts.halo            = cli.argTileHalo.getValue();
+            opts.verbosity       = logLevel;
+            opts.tiles_per_batch = cli.argTilesPerBatch.getValue();
+
+            // Apply:
+            std::cout << "[mm-filter] Applying filter pipeline in tiles of "
+                      << opts.tile_size << " m (halo=" << opts.halo
+                      << " m)..." << std::endl;
+
+            mp2p_icp_filters::apply_filter_pipeline_tiled(
+                yamlContent["filters"], mm, opts);
+        }
+        else
+        {
+            const auto pipeline =
+                mp2p_icp_filters::filter_pipeline_from_yaml_file(
+                    cli.argPipeline.getValue(), logLevel);
+
+            // Apply:
+            std::cout << "[mm-filter] Applying filter pipeline..."
+                      << std::endl;
+
+            mp2p_icp_filters::apply_filter_pipeline(pipeline, mm);
+        }
     }
     else
     {
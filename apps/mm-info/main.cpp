@@ -15,15 +15,22 @@
 #include <mrpt/3rdparty/tclap/CmdLine.h>
 #include <mrpt/containers/yaml.h>
 #include <mrpt/system/filesystem.h>
+#include <mrpt/system/string_utils.h>  // unitsFormat()
 
 // CLI flags:
 namespace
 {
-TCLAP::CmdLine cmd("mm-filter");
+TCLAP::CmdLine cmd("mm-info");
 
 TCLAP::UnlabeledValueArg<std::string> argMapFile(
     "input", "Load this metric map file (*.mm)", true, "myMap.mm", "myMap.mm",
     cmd);
+
+TCLAP::SwitchArg argDecodeLayers(
+    "", "decode-layers",
+    "Decode all map layers, instead of only reading the layers directory "
+    "(metadata) from the file.",
+    cmd);
 }  // namespace
 
 void run_mm_info()
@@ -36,10 +43,56 @@ void run_mm_info()
               << std::endl;
 
     mp2p_icp::metric_map_t mm;
-    mm.load_from_file(filInput);
 
-    std::cout << "[mm-info] Done read map. Contents:\n"
-              << mm.contents_summary() << std::endl;
+    if (argDecodeLayers.isSet())
+    {
+        mm.load_from_file(filInput);
+
+        std::cout << "[mm-info] Done read map. Contents:\n"
+                  << mm.contents_summary() << "\n";
+
+        std::cout << "[mm-info] Memory footprint:\n"
+                  << mm.memory_footprint().asString() << std::endl;
+        return;
+    }
+
+    // Only read the layers directory:
+    std::vector<mp2p_icp::metric_map_t::layer_info_t> layersInfo;
+    mm.load_from_file(filInput, {} /*no layer*/, layersInfo);
+
+    std::cout << "[mm-info] Done read map metadata. Contents:\n"
+              << mm.contents_summary() << "\n";
+
+    std::cout << "[mm-info] " << layersInfo.size() << " layers:\n";
+    for (const auto& li : layersInfo)
+    {
+        std::cout << " - \"" << li.name << "\": " << li.className << ", "
+                  << mrpt::system::unitsFormat(
+                         static_cast<double>(li.pointCount), 2, false)
+                  << " points, "
+                  << mrpt::system::unitsFormat(
+                         static_cast<double>(li.voxelCount), 2, false)
+                  << " voxels";
+        if (li.serializedBytes != 0)
+        {
+            std::cout << ", "
+                      << mrpt::system::unitsFormat(
+                             static_cast<double>(li.serializedBytes), 2, false)
+                      << "B";
+        }
+        if (li.pointCount != 0)
+        {
+            // Lower bound, only x,y,z. Use --decode-layers for details.
+            std::cout << ", RAM >= "
+                      << mrpt::system::unitsFormat(
+                             static_cast<double>(
+                                 li.pointCount * 3 * sizeof(float)),
+                             2, false)
+                      << "B";
+        }
+        std::cout << "\n   " << li.description << "\n";
+    }
+    std::cout << std::endl;
 }
 
 int main(int argc, char** argv)
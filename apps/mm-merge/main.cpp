@@ -0,0 +1,307 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   mm-merge/main.cpp
+ * @brief  CLI tool to merge several mm files (e.g. sm2mm shards) into one
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/voxel_keys.h>
+#include <mrpt/3rdparty/tclap/CmdLine.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/math/TBoundingBox.h>
+#include <mrpt/system/filesystem.h>
+
+#include <iostream>
+#include <map>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+
+// CLI flags:
+struct Cli
+{
+    TCLAP::CmdLine cmd{"mm-merge"};
+
+    TCLAP::MultiArg<std::string> argInputs{
+        "i", "input",
+        "Input .mm file(s) to merge. Use it several times for multiple files.",
+        true, "shard.mm", cmd};
+
+    TCLAP::ValueArg<std::string> argOutput{
+        "o",      "output", "Output .mm file to write to", true, "out.mm",
+        "out.mm", cmd};
+
+    TCLAP::ValueArg<double> argDedupVoxelSize{
+        "",
+        "dedup-voxel-size",
+        "If provided, points of the --dedup-layer layers from each new input "
+        "map are dropped if they fall into a voxel of this size [m] already "
+        "occupied by a former input map. Only the overlapping borders of the "
+        "input maps are checked, the rest of the map remains unmodified. Use "
+        "the same voxel size than the decimation in the sm2mm pipeline.",
+        false,
+        0.0,
+        "0.20",
+        cmd};
+
+    TCLAP::MultiArg<std::string> argDedupLayers{
+        "", "dedup-layer",
+        "Point cloud layer to deduplicate with --dedup-voxel-size. Use it "
+        "several times for multiple layers.",
+        false, "map", cmd};
+};
+
+// merge_with() can only append to point cloud layers:
+void check_mergeable(
+    const mp2p_icp::metric_map_t& mm, const mp2p_icp::metric_map_t& shard,
+    const std::string& filInput)
+{
+    for (const auto& [name, layer] : shard.layers)
+    {
+        const auto it = mm.layers.find(name);
+        if (it == mm.layers.end()) continue;
+
+        if (!std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(it->second) ||
+            !std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(layer))
+        {
+            THROW_EXCEPTION_FMT(
+                "Layer '%s' in '%s' was already present in a former input "
+                "map, but only point cloud layers can be merged (this one is "
+                "'%s'). Rename or remove this layer from all but one input "
+                "map.",
+                name.c_str(), filInput.c_str(),
+                layer->GetRuntimeClass()->className);
+        }
+    }
+}
+
+// Points that one input map contributed to a deduplicated layer:
+struct ShardPoints
+{
+    mrpt::math::TBoundingBoxf bbox;
+    size_t                    first = 0, count = 0;  // In the merged layer
+};
+
+bool inside(const mrpt::math::TBoundingBoxf& bb, float x, float y, float z)
+{
+    return x >= bb.min.x && y >= bb.min.y && z >= bb.min.z &&
+           x <= bb.max.x && y <= bb.max.y && z <= bb.max.z;
+}
+
+mrpt::math::TBoundingBoxf grow(mrpt::math::TBoundingBoxf bb, float d)
+{
+    bb.min -= mrpt::math::TPoint3Df(d, d, d);
+    bb.max += mrpt::math::TPoint3Df(d, d, d);
+    return bb;
+}
+
+// Deduplication of point layers in the borders of overlapping input maps.
+// Only the points of former input maps whose bounding boxes overlap the new
+// one are voxelized, and only new points within those overlaps are dropped.
+class BorderDedup
+{
+   public:
+    BorderDedup(double voxelSize, const std::vector<std::string>& layers)
+        : layers_(layers)
+    {
+        keys_.mapping.setResolution(voxelSize);
+    }
+
+    // To be called before merging `shard` into `mm`:
+    void dedup(const mp2p_icp::metric_map_t& mm, mp2p_icp::metric_map_t& shard)
+    {
+        for (const auto& name : layers_)
+        {
+            const auto itShard = shard.layers.find(name);
+            if (itShard == shard.layers.end()) continue;
+
+            auto pts = std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(
+                itShard->second);
+            ASSERTMSG_(
+                pts,
+                mrpt::format(
+                    "--dedup-layer '%s' is not a point cloud layer (it is "
+                    "'%s'), only point layers can be deduplicated.",
+                    name.c_str(),
+                    itShard->second->GetRuntimeClass()->className));
+
+            const auto itMerged = mm.layers.find(name);
+            if (pts->empty() || itMerged == mm.layers.end()) continue;
+
+            const auto merged =
+                std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(
+                    itMerged->second);
+            ASSERT_(merged);
+
+            dedup_layer(*merged, shardPoints_[name], *pts, name);
+        }
+    }
+
+    // To be called after merging `shard` into `mm`:
+    void record(
+        const mp2p_icp::metric_map_t& mm, const mp2p_icp::metric_map_t& shard)
+    {
+        for (const auto& name : layers_)
+        {
+            const auto pts = shard.point_layer(name);
+            if (!pts || pts->empty()) continue;
+
+            ShardPoints sp;
+            sp.bbox  = pts->boundingBox();
+            sp.count = pts->size();
+            sp.first = mm.point_layer(name)->size() - sp.count;
+            shardPoints_[name].push_back(sp);
+        }
+    }
+
+   private:
+    std::vector<std::string>                        layers_;
+    mp2p_icp_filters::LinearVoxelKeys               keys_;
+    std::map<std::string, std::vector<ShardPoints>> shardPoints_;
+
+    void dedup_layer(
+        const mrpt::maps::CPointsMap& merged,
+        const std::vector<ShardPoints>& formerShards,
+        mrpt::maps::CPointsMap& pts, const std::string& name) const
+    {
+        const float d       = keys_.mapping.resolution();
+        const auto  newBbox = grow(pts.boundingBox(), d);
+
+        // Voxels occupied by former input maps around the new one:
+        std::vector<mrpt::math::TBoundingBoxf> overlaps;
+        std::unordered_set<uint64_t, mp2p_icp_filters::voxel_keys::KeyHash>
+            occupied;
+
+        const auto& mxs = merged.getPointsBufferRef_x();
+        const auto& mys = merged.getPointsBufferRef_y();
+        const auto& mzs = merged.getPointsBufferRef_z();
+
+        for (const auto& sp : formerShards)
+        {
+            const auto ov = newBbox.intersection(grow(sp.bbox, d));
+            if (!ov) continue;
+            overlaps.push_back(*ov);
+
+            for (size_t i = sp.first; i < sp.first + sp.count; i++)
+            {
+                if (!inside(*ov, mxs[i], mys[i], mzs[i])) continue;
+                occupied.insert(keys_.key(mxs[i], mys[i], mzs[i]));
+            }
+        }
+        if (occupied.empty()) return;
+
+        const auto& xs = pts.getPointsBufferRef_x();
+        const auto& ys = pts.getPointsBufferRef_y();
+        const auto& zs = pts.getPointsBufferRef_z();
+
+        std::vector<bool> deletionMask(xs.size(), false);
+        size_t            nDeleted = 0;
+        for (size_t i = 0; i < xs.size(); i++)
+        {
+            bool inOverlap = false;
+            for (const auto& ov : overlaps)
+                if (inside(ov, xs[i], ys[i], zs[i])) inOverlap = true;
+
+            if (inOverlap && occupied.count(keys_.key(xs[i], ys[i], zs[i])))
+            {
+                deletionMask[i] = true;
+                nDeleted++;
+            }
+        }
+        pts.applyDeletionMask(deletionMask);
+
+        std::cout << "[mm-merge] Layer '" << name << "': " << nDeleted
+                  << " duplicated points removed in overlapping borders."
+                  << std::endl;
+    }
+};
+
+void run_mm_merge(Cli& cli)
+{
+    std::optional<BorderDedup> dedup;
+    if (cli.argDedupVoxelSize.isSet())
+    {
+        const double voxelSize = cli.argDedupVoxelSize.getValue();
+        ASSERT_GT_(voxelSize, 0.0);
+        ASSERTMSG_(
+            !cli.argDedupLayers.getValue().empty(),
+            "--dedup-voxel-size requires at least one --dedup-layer");
+
+        dedup.emplace(voxelSize, cli.argDedupLayers.getValue());
+    }
+    else
+    {
+        ASSERTMSG_(
+            cli.argDedupLayers.getValue().empty(),
+            "--dedup-layer requires --dedup-voxel-size");
+    }
+
+    mp2p_icp::metric_map_t mm;
+
+    // Load one input map at a time, to keep memory usage as low as possible:
+    for (const auto& filInput : cli.argInputs.getValue())
+    {
+        ASSERT_FILE_EXISTS_(filInput);
+
+        std::cout << "[mm-merge] Reading input map from: '" << filInput
+                  << "'..." << std::endl;
+
+        mp2p_icp::metric_map_t shard;
+        if (!shard.load_from_file(filInput))
+            THROW_EXCEPTION_FMT(
+                "Error reading input file '%s'", filInput.c_str());
+
+        std::cout << "[mm-merge] Done read map: " << shard.contents_summary()
+                  << std::endl;
+
+        check_mergeable(mm, shard, filInput);
+
+        if (dedup) dedup->dedup(mm, shard);
+
+        mm.merge_with(shard);
+
+        if (dedup) dedup->record(mm, shard);
+    }
+
+    std::cout << "[mm-merge] Done. Output map: " << mm.contents_summary()
+              << std::endl;
+
+    // Save as mm file:
+    const auto filOut = cli.argOutput.getValue();
+    std::cout << "[mm-merge] Writing metric map to: '" << filOut << "'..."
+              << std::endl;
+
+    if (!mm.save_to_file(filOut))
+        THROW_EXCEPTION_FMT(
+            "Error writing to target file '%s'", filOut.c_str());
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        Cli cli;
+
+        // Parse arguments:
+        if (!cli.cmd.parse(argc, argv)) return 1;  // should exit.
+
+        run_mm_merge(cli);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what();
+        return 1;
+    }
+    return 0;
+}
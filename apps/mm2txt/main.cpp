@@ -14,9 +14,22 @@
 #include <mp2p_icp/metricmap.h>
 #include <mrpt/3rdparty/tclap/CmdLine.h>
 #include <mrpt/containers/yaml.h>
-#include <mrpt/maps/CPointsMapXYZI.h>
-#include <mrpt/maps/CPointsMapXYZIRT.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/math/TBoundingBox.h>
 #include <mrpt/system/filesystem.h>
+#include <mrpt/system/string_utils.h>
+#include <mrpt/version.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#if defined(MP2P_HAS_TBB)
+#include <tbb/parallel_for.h>
+#endif
 
 // CLI flags:
 static TCLAP::CmdLine cmd("mm2txt");
@@ -31,6 +44,299 @@ static TCLAP::MultiArg<std::string> argLayers(
     "appear several times.",
     false, "layerName", cmd);
 
+static TCLAP::ValueArg<std::string> argFormat(
+    "f", "format",
+    "Output file format: txt (space-separated columns, default), csv (with "
+    "a header line), ply (binary), or las (LAS 1.2, point format 1).",
+    false, "txt", "txt|csv|ply|las", cmd);
+
+static TCLAP::ValueArg<std::string> argBBox(
+    "", "bbox",
+    "If provided, only points within this bounding box will be exported. "
+    "Format: \"XMIN YMIN ZMIN XMAX YMAX ZMAX\"",
+    false, "", "\"XMIN YMIN ZMIN XMAX YMAX ZMAX\"", cmd);
+
+namespace
+{
+// SoA point buffers to export:
+struct PointChannels
+{
+    const mrpt::aligned_std_vector<float>*    xs = nullptr;
+    const mrpt::aligned_std_vector<float>*    ys = nullptr;
+    const mrpt::aligned_std_vector<float>*    zs = nullptr;
+    const mrpt::aligned_std_vector<float>*    Is = nullptr;
+    const mrpt::aligned_std_vector<uint16_t>* Rs = nullptr;
+    const mrpt::aligned_std_vector<float>*    Ts = nullptr;
+
+    explicit PointChannels(const mrpt::maps::CPointsMap& pts)
+        : xs(&pts.getPointsBufferRef_x()),
+          ys(&pts.getPointsBufferRef_y()),
+          zs(&pts.getPointsBufferRef_z())
+    {
+#if MRPT_VERSION >= 0x020b04
+        const size_t n = xs->size();
+        // Only use non-empty optional channels:
+        Is = pts.getPointsBufferRef_intensity();
+        if (Is && Is->size() != n) Is = nullptr;
+        Rs = pts.getPointsBufferRef_ring();
+        if (Rs && Rs->size() != n) Rs = nullptr;
+        Ts = pts.getPointsBufferRef_timestamp();
+        if (Ts && Ts->size() != n) Ts = nullptr;
+#endif
+    }
+
+    size_t size() const { return xs->size(); }
+};
+
+// Points are processed in chunks of this size, in parallel, and in batches
+// of chunks, which are written to the output stream in order:
+constexpr size_t CHUNK_SIZE       = 1 << 16;
+constexpr size_t CHUNKS_PER_BATCH = 64;
+
+template <typename FormatChunk>
+void write_chunks(std::ostream& f, size_t N, FormatChunk&& formatChunk)
+{
+    const size_t nChunks = (N + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    std::vector<std::string> buffers;
+
+    for (size_t b = 0; b < nChunks; b += CHUNKS_PER_BATCH)
+    {
+        const size_t nBatch = std::min(CHUNKS_PER_BATCH, nChunks - b);
+        buffers.resize(nBatch);
+
+#if defined(MP2P_HAS_TBB)
+        tbb::parallel_for(
+            static_cast<size_t>(0), nBatch,
+            [&](size_t k)
+#else
+        for (size_t k = 0; k < nBatch; k++)
+#endif
+            {
+                const size_t i0 = (b + k) * CHUNK_SIZE;
+                const size_t i1 = std::min(N, i0 + CHUNK_SIZE);
+                buffers[k].clear();
+                formatChunk(i0, i1, buffers[k]);
+            }
+#if defined(MP2P_HAS_TBB)
+        );
+#endif
+
+        for (const auto& buf : buffers) f.write(buf.data(), buf.size());
+    }
+}
+
+template <typename T>
+void append_binary(std::string& buf, const T& value)
+{
+    // Note: assumes a little-endian host, as all formats here are LE:
+    const auto* p = reinterpret_cast<const char*>(&value);
+    buf.append(p, sizeof(T));
+}
+
+template <typename T>
+void append_number(std::string& buf, const T& value)
+{
+    char       tmp[32];
+    const auto r = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    buf.append(tmp, r.ptr);
+}
+
+void export_text(
+    const std::string& filName, const PointChannels& ch,
+    const std::vector<uint8_t>& selected, bool csv)
+{
+    std::ofstream f(filName, std::ios::binary);
+    ASSERTMSG_(f.is_open(), "Cannot create file: " + filName);
+
+    const char sep = csv ? ',' : ' ';
+
+    if (csv)
+    {
+        f << "x,y,z";
+        if (ch.Is) f << ",intensity";
+        if (ch.Rs) f << ",ring";
+        if (ch.Ts) f << ",timestamp";
+        f << "\n";
+    }
+
+    write_chunks(
+        f, ch.size(),
+        [&](size_t i0, size_t i1, std::string& buf)
+        {
+            buf.reserve((i1 - i0) * 48);
+            for (size_t i = i0; i < i1; i++)
+            {
+                if (!selected.empty() && !selected[i]) continue;
+
+                append_number(buf, (*ch.xs)[i]);
+                buf.push_back(sep);
+                append_number(buf, (*ch.ys)[i]);
+                buf.push_back(sep);
+                append_number(buf, (*ch.zs)[i]);
+                if (ch.Is)
+                {
+                    buf.push_back(sep);
+                    append_number(buf, (*ch.Is)[i]);
+                }
+                if (ch.Rs)
+                {
+                    buf.push_back(sep);
+                    append_number(buf, (*ch.Rs)[i]);
+                }
+                if (ch.Ts)
+                {
+                    buf.push_back(sep);
+                    append_number(buf, (*ch.Ts)[i]);
+                }
+                buf.push_back('\n');
+            }
+        });
+}
+
+void export_ply(
+    const std::string& filName, const PointChannels& ch,
+    const std::vector<uint8_t>& selected, size_t nSelected)
+{
+    std::ofstream f(filName, std::ios::binary);
+    ASSERTMSG_(f.is_open(), "Cannot create file: " + filName);
+
+    f << "ply\n"
+         "format binary_little_endian 1.0\n"
+         "comment Generated by mm2txt\n"
+         "element vertex "
+      << nSelected
+      << "\n"
+         "property float x\n"
+         "property float y\n"
+         "property float z\n";
+    if (ch.Is) f << "property float intensity\n";
+    if (ch.Rs) f << "property ushort ring\n";
+    if (ch.Ts) f << "property float timestamp\n";
+    f << "end_header\n";
+
+    write_chunks(
+        f, ch.size(),
+        [&](size_t i0, size_t i1, std::string& buf)
+        {
+            buf.reserve((i1 - i0) * (3 + 3) * sizeof(float));
+            for (size_t i = i0; i < i1; i++)
+            {
+                if (!selected.empty() && !selected[i]) continue;
+
+                append_binary(buf, (*ch.xs)[i]);
+                append_binary(buf, (*ch.ys)[i]);
+                append_binary(buf, (*ch.zs)[i]);
+                if (ch.Is) append_binary(buf, (*ch.Is)[i]);
+                if (ch.Rs) append_binary(buf, (*ch.Rs)[i]);
+                if (ch.Ts) append_binary(buf, (*ch.Ts)[i]);
+            }
+        });
+}
+
+void export_las(
+    const std::string& filName, const PointChannels& ch,
+    const std::vector<uint8_t>& selected, size_t nSelected)
+{
+    ASSERTMSG_(
+        nSelected <= std::numeric_limits<uint32_t>::max(),
+        "Too many points for LAS 1.2 format");
+
+    // Bounding box and max intensity of the exported points:
+    auto  bbox         = mrpt::math::TBoundingBoxf::PlusMinusInfinity();
+    float maxIntensity = 0;
+    for (size_t i = 0; i < ch.size(); i++)
+    {
+        if (!selected.empty() && !selected[i]) continue;
+        bbox.updateWithPoint({(*ch.xs)[i], (*ch.ys)[i], (*ch.zs)[i]});
+        if (ch.Is) maxIntensity = std::max(maxIntensity, (*ch.Is)[i]);
+    }
+    if (nSelected == 0) bbox = mrpt::math::TBoundingBoxf({0, 0, 0}, {0, 0, 0});
+
+    // Intensities in the range [0,1] are scaled to the full uint16 range:
+    const float intensityScale = maxIntensity <= 1.0f ? 65535.0f : 1.0f;
+
+    constexpr double   SCALE         = 1e-3;  // [m]
+    constexpr uint16_t HEADER_SIZE   = 227;
+    constexpr uint16_t RECORD_LENGTH = 28;  // Point data format 1
+
+    // LAS 1.2 public header block:
+    std::string h;
+    h.append("LASF", 4);
+    append_binary(h, uint16_t(0));  // file source ID
+    append_binary(h, uint16_t(0));  // global encoding
+    h.append(16, '\0');  // GUID
+    append_binary(h, uint8_t(1));  // version major
+    append_binary(h, uint8_t(2));  // version minor
+    std::string sysId = "mp2p_icp";
+    sysId.resize(32, '\0');
+    h.append(sysId);
+    std::string software = "mm2txt";
+    software.resize(32, '\0');
+    h.append(software);
+    append_binary(h, uint16_t(0));  // creation day of year
+    append_binary(h, uint16_t(0));  // creation year
+    append_binary(h, HEADER_SIZE);
+    append_binary(h, uint32_t(HEADER_SIZE));  // offset to point data
+    append_binary(h, uint32_t(0));  // number of VLRs
+    append_binary(h, uint8_t(1));  // point data format
+    append_binary(h, RECORD_LENGTH);
+    append_binary(h, static_cast<uint32_t>(nSelected));
+    append_binary(h, static_cast<uint32_t>(nSelected));  // by return #1
+    for (int k = 0; k < 4; k++) append_binary(h, uint32_t(0));
+    for (int k = 0; k < 3; k++) append_binary(h, SCALE);
+    const double offset[3] = {bbox.min.x, bbox.min.y, bbox.min.z};
+    for (int k = 0; k < 3; k++) append_binary(h, offset[k]);
+    append_binary(h, double(bbox.max.x));
+    append_binary(h, double(bbox.min.x));
+    append_binary(h, double(bbox.max.y));
+    append_binary(h, double(bbox.min.y));
+    append_binary(h, double(bbox.max.z));
+    append_binary(h, double(bbox.min.z));
+    ASSERT_EQUAL_(h.size(), HEADER_SIZE);
+
+    std::ofstream f(filName, std::ios::binary);
+    ASSERTMSG_(f.is_open(), "Cannot create file: " + filName);
+    f.write(h.data(), h.size());
+
+    write_chunks(
+        f, ch.size(),
+        [&](size_t i0, size_t i1, std::string& buf)
+        {
+            buf.reserve((i1 - i0) * RECORD_LENGTH);
+            for (size_t i = i0; i < i1; i++)
+            {
+                if (!selected.empty() && !selected[i]) continue;
+
+                const float pt[3] = {(*ch.xs)[i], (*ch.ys)[i], (*ch.zs)[i]};
+                for (int k = 0; k < 3; k++)
+                {
+                    append_binary(
+                        buf, static_cast<int32_t>(
+                                 std::lround((pt[k] - offset[k]) / SCALE)));
+                }
+
+                const float intensity =
+                    ch.Is ? std::clamp(
+                                (*ch.Is)[i] * intensityScale, 0.0f, 65535.0f)
+                          : 0.0f;
+                append_binary(buf, static_cast<uint16_t>(intensity));
+                append_binary(buf, uint8_t(0x09));  // return 1 of 1
+                append_binary(buf, uint8_t(0));  // classification
+                append_binary(buf, int8_t(0));  // scan angle rank
+                // user data: ring number
+                append_binary(
+                    buf,
+                    static_cast<uint8_t>(
+                        ch.Rs ? std::min<uint16_t>((*ch.Rs)[i], 255) : 0));
+                append_binary(buf, uint16_t(0));  // point source ID
+                append_binary(buf, ch.Ts ? double((*ch.Ts)[i]) : 0.0);
+            }
+        });
+}
+
+}  // namespace
+
 void run_mm2txt()
 {
     using namespace std::string_literals;
@@ -39,13 +345,43 @@ void run_mm2txt()
 
     ASSERT_FILE_EXISTS_(argMapFile.getValue());
 
-    std::cout << "[mm-info] Reading input map from: '" << filInput << "'..."
+    const auto format = mrpt::system::lowerCase(argFormat.getValue());
+    ASSERTMSG_(
+        format == "txt" || format == "csv" || format == "ply" ||
+            format == "las",
+        "Unknown --format: '" + format + "'");
+
+    std::optional<mrpt::math::TBoundingBoxf> bbox;
+    if (argBBox.isSet())
+    {
+        std::vector<std::string> tokens;
+        mrpt::system::tokenize(argBBox.getValue(), " ,", tokens);
+        ASSERTMSG_(
+            tokens.size() == 6,
+            "Expected format: --bbox \"XMIN YMIN ZMIN XMAX YMAX ZMAX\"");
+
+        float v[6];
+        for (int k = 0; k < 6; k++) v[k] = std::stof(tokens[k]);
+        bbox = mrpt::math::TBoundingBoxf(
+            {v[0], v[1], v[2]}, {v[3], v[4], v[5]});
+    }
+
+    std::cout << "[mm2txt] Reading input map from: '" << filInput << "'..."
               << std::endl;
 
     mp2p_icp::metric_map_t mm;
-    mm.load_from_file(filInput);
+    if (argLayers.isSet())
+    {
+        // Only decode the selected layers:
+        const auto& sel = argLayers.getValue();
+        mm.load_from_file(filInput, {sel.begin(), sel.end()});
+    }
+    else
+    {
+        mm.load_from_file(filInput);
+    }
 
-    std::cout << "[mm-info] Done read map. Contents:\n"
+    std::cout << "[mm2txt] Done read map. Contents:\n"
               << mm.contents_summary() << std::endl;
 
     std::vector<std::string> layers;
@@ -64,7 +400,7 @@ void run_mm2txt()
     // Export them:
     for (const auto& name : layers)
     {
-        const std::string filName = baseFilName + "_"s + name + ".txt"s;
+        const std::string filName = baseFilName + "_"s + name + "."s + format;
 
         std::cout << "Exporting layer: '" << name << "' to file '" << filName
                   << "'..." << std::endl;
@@ -81,19 +417,31 @@ void run_mm2txt()
                 name.c_str(), mm.layers.at(name)->GetRuntimeClass()->className);
         }
 
-        if (auto* xyzirt =
-                dynamic_cast<const mrpt::maps::CPointsMapXYZIRT*>(pts);
-            xyzirt)
-        {
-            xyzirt->saveXYZIRT_to_text_file(filName);
-        }
-        else if (auto* xyzi =
-                     dynamic_cast<const mrpt::maps::CPointsMapXYZI*>(pts);
-                 xyzi)
+        const PointChannels ch(*pts);
+
+        // Optional bounding box selection:
+        std::vector<uint8_t> selected;  // empty=all
+        size_t               nSelected = ch.size();
+        if (bbox)
         {
-            xyzi->saveXYZI_to_text_file(filName);
+            selected.resize(ch.size());
+            nSelected = 0;
+            for (size_t i = 0; i < ch.size(); i++)
+            {
+                selected[i] = bbox->containsPoint(
+                    {(*ch.xs)[i], (*ch.ys)[i], (*ch.zs)[i]});
+                nSelected += selected[i];
+            }
         }
-        else { pts->save3D_to_text_file(filName); }
+
+        if (format == "ply")
+            export_ply(filName, ch, selected, nSelected);
+        else if (format == "las")
+            export_las(filName, ch, selected, nSelected);
+        else
+            export_text(filName, ch, selected, format == "csv");
+
+        std::cout << "Exported " << nSelected << " points." << std::endl;
     }
 }
 
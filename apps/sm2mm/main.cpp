@@ -18,6 +18,7 @@
 #include <mrpt/io/lazy_load_path.h>
 #include <mrpt/system/COutputLogger.h>
 #include <mrpt/system/filesystem.h>
+#include <mrpt/system/string_utils.h>
 
 // CLI flags:
 static TCLAP::CmdLine cmd("sm2mm");
@@ -73,6 +74,38 @@ static TCLAP::ValueArg<size_t> argIndexTo(
     "only.",
     false, 0, "0", cmd);
 
+static TCLAP::ValueArg<double> argShardTileSize(
+    "", "shard-tile-size",
+    "Size of the square XY tiles [m] used to partition keyframes into shards, "
+    "for --shard and --list-shards.",
+    false, 100.0, "100.0", cmd);
+
+static TCLAP::ValueArg<std::string> argShard(
+    "", "shard",
+    "If provided, only keyframes whose robot pose falls within the given "
+    "tile (plus --shard-margin) will be processed. Shards can be built by "
+    "independent processes, then stitched with `mm-merge`.",
+    false, "\"I,J\"", "\"I,J\"", cmd);
+
+static TCLAP::ValueArg<double> argShardMargin(
+    "", "shard-margin",
+    "Keyframes within this distance [m] out of the --shard tile are also "
+    "processed, so neighboring shards overlap (Default: 0).",
+    false, 0.0, "0.0", cmd);
+
+static TCLAP::SwitchArg argParallelSensors(
+    "", "parallel-sensors",
+    "Process all the observations of each keyframe in parallel (e.g. several "
+    "LiDARs), then apply the filter pipeline once per keyframe, instead of "
+    "once per observation. All generators must be reentrant.",
+    cmd);
+
+static TCLAP::SwitchArg argListShards(
+    "", "list-shards",
+    "Just list all non-empty shard tiles for the given --shard-tile-size and "
+    "the number of keyframes in each one, then exit.",
+    cmd);
+
 void run_sm_to_mm()
 {
     const auto& filSM = argInput.getValue();
@@ -89,6 +122,20 @@ void run_sm_to_mm()
               << " keyframes." << std::endl;
     ASSERT_(!sm.empty());
 
+    if (argListShards.isSet())
+    {
+        const double tileSize = argShardTileSize.getValue();
+        const auto   tiles =
+            mp2p_icp_filters::simplemap_shard_tiles(sm, tileSize);
+
+        std::cout << "[sm2mm] " << tiles.size()
+                  << " non-empty shards for tile size=" << tileSize << ":\n";
+        for (const auto& [tile, count] : tiles)
+            std::cout << "--shard \"" << tile.first << "," << tile.second
+                      << "\"  (" << count << " keyframes)\n";
+        return;
+    }
+
     // Load pipeline from YAML file:
     mrpt::containers::yaml yamlData;  // default: empty
 
@@ -112,16 +159,43 @@ void run_sm_to_mm()
         mrpt::io::setLazyLoadPathBase(arg_lazy_load_base_dir.getValue());
 
     mp2p_icp_filters::sm2mm_options_t opts;
-    opts.showProgressBar = !argNoProgressBar.isSet();
-    opts.verbosity       = logLevel;
+    opts.showProgressBar  = !argNoProgressBar.isSet();
+    opts.verbosity        = logLevel;
+    opts.parallel_sensors = argParallelSensors.isSet();
 
     if (argIndexFrom.isSet()) opts.start_index = argIndexFrom.getValue();
     if (argIndexTo.isSet()) opts.end_index = argIndexTo.getValue();
 
+    if (argShard.isSet())
+    {
+        std::vector<std::string> ij;
+        mrpt::system::tokenize(argShard.getValue(), ",", ij);
+        ASSERTMSG_(ij.size() == 2, "Expected format: --shard \"I,J\"");
+
+        mp2p_icp_filters::sm2mm_shard_t shard;
+        shard.tile_size = argShardTileSize.getValue();
+        shard.tile_x    = std::stoi(ij[0]);
+        shard.tile_y    = std::stoi(ij[1]);
+        shard.margin    = argShardMargin.getValue();
+        opts.shard      = shard;
+
+        std::cout << "[sm2mm] Building shard (" << shard.tile_x << ","
+                  << shard.tile_y << ") with tile size=" << shard.tile_size
+                  << " and margin=" << shard.margin << std::endl;
+    }
+
     // Create the map:
-    mp2p_icp_filters::simplemap_to_metricmap(sm, mm, yamlData, opts);
+    mp2p_icp_filters::sm2mm_stats_t stats;
+
+    mp2p_icp_filters::simplemap_to_metricmap(sm, mm, yamlData, opts, stats);
 
     std::cout << "[sm2mm] Final map: " << mm.contents_summary() << std::endl;
+    std::cout << "[sm2mm] Peak map memory: "
+              << mrpt::system::unitsFormat(
+                     static_cast<double>(stats.peakMemory), 2, false)
+              << "B (at keyframe #" << stats.peakMemoryKeyframe
+              << "). Final map memory:\n"
+              << mm.memory_footprint().asString();
 
     // Save as mm file:
     const auto filOut = argOutput.getValue();
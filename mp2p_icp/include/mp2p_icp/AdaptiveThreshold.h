@@ -0,0 +1,118 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   AdaptiveThreshold.h
+ * @brief  KISS-ICP-like adaptive correspondence distance thresholds
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mrpt/containers/yaml.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace mp2p_icp
+{
+/** Parameters for AdaptiveThreshold.
+ * \ingroup mp2p_icp_grp
+ */
+struct AdaptiveThresholdParameters
+{
+    /** Threshold used until the first alignment with a significant motion
+     * error has been observed [m] */
+    double initial_threshold = 2.0;
+
+    /** Alignments whose error deviation is below this are not used to update
+     * the model, e.g. while the vehicle is stopped [m] */
+    double min_motion = 0.1;
+
+    /** Lower and upper bounds of the returned thresholds [m] */
+    double min_threshold = 0.25;
+    double max_threshold = 10.0;
+
+    /** The threshold is this number of times the standard deviation of the
+     * model error */
+    double sigma_multiplier = 3.0;
+
+    /** If >0, only the last N alignments are used to estimate the standard
+     * deviation. 0 (default) means all of them, as in KISS-ICP. */
+    uint32_t window_length = 0;
+
+    /** If true, the threshold of each ICP iteration after the first one is
+     * further reduced according to the deviation of the last ICP step
+     * increment, since the remaining error is expected to be of that order.
+     * Disabled by default, so each alignment uses a constant threshold as in
+     * KISS-ICP.
+     */
+    bool shrink_with_icp_steps = false;
+
+    void load_from_yaml(const mrpt::containers::yaml& c);
+};
+
+/** Adaptive correspondence distance threshold, as in KISS-ICP [Vizzo et al.,
+ * RA-L 2023].
+ *
+ * The model keeps the history of errors between the initial guess of each
+ * alignment (e.g. a constant velocity prediction in odometry) and its final
+ * solution. Each error is converted into a point "deviation", the worst-case
+ * displacement of a point at distance `maxRange`:
+ *
+ *  deviation = 2 maxRange sin(theta/2) + |t|
+ *
+ * with `theta` and `t` the rotation angle and translation of the error. The
+ * threshold is `sigma_multiplier` times the RMS of those deviations.
+ *
+ * \ingroup mp2p_icp_grp
+ */
+class AdaptiveThreshold
+{
+   public:
+    AdaptiveThreshold() = default;
+    explicit AdaptiveThreshold(const AdaptiveThresholdParameters& p)
+        : params(p)
+    {
+    }
+
+    AdaptiveThresholdParameters params;
+
+    /** Point deviation caused by a pose error, for points up to maxRange. */
+    static double deviation(
+        const mrpt::poses::CPose3D& poseError, double maxRange);
+
+    /** Adds the result of one alignment to the model. */
+    void update(
+        const mrpt::poses::CPose3D& initialGuess,
+        const mrpt::poses::CPose3D& solution, double maxRange);
+
+    /** Standard deviation (RMS) of the model deviations, or nullopt if no
+     * alignment has been added yet. */
+    std::optional<double> sigma() const;
+
+    /** Returns the threshold to use in an ICP iteration.
+     * \param lastIcpStepIncrement The pose increment of the last ICP
+     *        iteration, or nullopt in the first one.
+     * \param maxRange Maximum range of the local points [m].
+     */
+    double threshold(
+        const std::optional<mrpt::poses::CPose3D>& lastIcpStepIncrement,
+        double                                     maxRange) const;
+
+    /** Number of alignments in the model */
+    std::size_t samples() const { return count_; }
+
+    void reset();
+
+   private:
+    double             sumDevSqr_ = 0;
+    std::size_t        count_     = 0;
+    std::deque<double> window_;  //!< Only used if params.window_length>0
+};
+
+}  // namespace mp2p_icp
@@ -29,6 +29,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <optional>
 
 namespace mp2p_icp
 {
@@ -224,6 +225,15 @@ class ICP : public mrpt::system::COutputLogger, public mrpt::rtti::CObject
 
     void setIterationHook(const iteration_hook_t& ih) { iteration_hook_ = ih; }
 
+    /** A function returning the current time [s] */
+    using time_source_t = std::function<double()>;
+
+    /** Replaces the wall clock (mrpt::Clock::nowDouble()) used to measure the
+     * time budget in "anytime" mode (see Parameters::timeBudget), e.g. with a
+     * simulated clock in unit tests. An empty function restores the wall
+     * clock. */
+    void setTimeSource(const time_source_t& ts) { time_source_ = ts; }
+
     const mrpt::system::CTimeLogger& profiler() const { return profiler_; }
     mrpt::system::CTimeLogger&       profiler() { return profiler_; }
 
@@ -234,6 +244,7 @@ class ICP : public mrpt::system::COutputLogger, public mrpt::rtti::CObject
         {QualityEvaluator_PairedRatio::Create(), 1.0}};
 
     iteration_hook_t iteration_hook_;
+    time_source_t    time_source_;
 
     mrpt::system::CTimeLogger profiler_{false /*disabled*/, "mp2p_icp::ICP"};
 
@@ -256,5 +267,10 @@ class ICP : public mrpt::system::COutputLogger, public mrpt::rtti::CObject
 
    private:
     ParameterSource ownParamSource_;
+
+    /** Measured time [s] per local point of the first ICP iteration, kept
+     * between calls to align() to estimate the cost of the first iteration in
+     * "anytime" mode (see Parameters::timeBudget). */
+    std::optional<double> anytimeSecondsPerPoint_;
 };
 }  // namespace mp2p_icp
@@ -23,7 +23,9 @@ enum class IterTermReason : uint8_t
     MaxIterations,
     Stalled,
     QualityCheckpointFailed,
-    HookRequest
+    HookRequest,
+    /** The time budget (Parameters::timeBudget) was exhausted */
+    Timeout
 };
 
 }  // namespace mp2p_icp
@@ -36,4 +38,5 @@ MRPT_FILL_ENUM(IterTermReason::MaxIterations);
 MRPT_FILL_ENUM(IterTermReason::Stalled);
 MRPT_FILL_ENUM(IterTermReason::QualityCheckpointFailed);
 MRPT_FILL_ENUM(IterTermReason::HookRequest);
+MRPT_FILL_ENUM(IterTermReason::Timeout);
 MRPT_ENUM_TYPE_END()
@@ -13,6 +13,7 @@
 
 #include <mp2p_icp/Pairings.h>
 #include <mp2p_icp/Parameterizable.h>
+#include <mp2p_icp/Results.h>
 #include <mp2p_icp/metricmap.h>
 #include <mp2p_icp/pointcloud_bitfield.h>
 #include <mrpt/containers/yaml.h>
@@ -32,6 +33,16 @@ struct MatchContext
 
     /// The ICP iteration number we are in:
     uint32_t icpIteration = 0;
+
+    /// The pose increment of the last ICP iteration, if any (it is empty in
+    /// the first iteration). See SolverContext::lastIcpStepIncrement
+    std::optional<mrpt::poses::CPose3D> lastIcpStepIncrement;
+
+    /// If set, an upper limit to the number of local points per layer used by
+    /// matchers derived from Matcher_Points_Base, on top of their own
+    /// `maxLocalPointsPerLayer` parameter. Used by ICP::align() to reduce the
+    /// workload in "anytime" mode (see Parameters::timeBudget).
+    std::optional<uint64_t> maxLocalPointsPerLayer;
 };
 
 struct MatchState
@@ -93,6 +104,17 @@ class Matcher : public mrpt::system::COutputLogger,
         const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
         MatchState& ms, Pairings& out) const;
 
+    /** Called by ICP::align() once an alignment has finished, with its
+     * initial guess and results, so matchers can keep a model of the
+     * expected registration errors across calls (e.g. adaptive thresholds).
+     * Default implementation does nothing.
+     */
+    virtual void onAlignmentFinished(
+        [[maybe_unused]] const mrpt::poses::CPose3D& initialGuess,
+        [[maybe_unused]] const Results&              result)
+    {
+    }
+
     uint32_t runFromIteration = 0;
     uint32_t runUpToIteration = 0;  //!< 0: no limit
     bool     enabled          = true;
@@ -12,7 +12,11 @@
 #pragma once
 
 #include <mp2p_icp/Matcher_Points_Base.h>
-#include <mrpt/containers/vector_with_small_size_optimization.h>
+#include <mrpt/math/TPlane.h>
+#include <mrpt/math/TPoint3D.h>
+
+#include <cstdint>
+#include <vector>
 
 namespace mp2p_icp
 {
@@ -66,25 +70,33 @@ class Matcher_Adaptive : public Matcher_Points_Base
     double         planeEigenThreshold       = 0.01;
     double         minimumCorrDist           = 0.1;  // m
 
-    // Declared here to avoid memory reallocations:
-    mutable std::vector<uint64_t>              neighborIndices_;
-    mutable std::vector<float>                 neighborSqrDists_;
-    mutable std::vector<mrpt::math::TPoint3Df> neighborPts_;
-    mutable std::vector<float>                 kddXs, kddYs, kddZs;
-    mutable std::vector<double>                histXs_, histValues_;
-
     constexpr static size_t MAX_CORRS_PER_LOCAL = 10;
 
-    mutable std::vector<mrpt::containers::vector_with_small_size_optimization<
-        mrpt::tfest::TMatchingPair, MAX_CORRS_PER_LOCAL>>
-        matchesPerLocal_;
+    /** Bins of the histogram of squared errors, spanning the observed range
+     * of 1st and 2nd closest errors, used to find the adaptive threshold */
+    constexpr static size_t HISTOGRAM_BINS = 50;
+
+    struct LocalPlane
+    {
+        mrpt::math::TPlane   plane;
+        mrpt::math::TPoint3D centroid;
+        bool                 valid = false;
+    };
+
+    // Declared here to avoid memory reallocations:
+    // Candidate pairings of each (transformed) local point, in a flat array
+    // with a fixed stride of MAX_CORRS_PER_LOCAL, sorted by distance.
+    mutable std::vector<mrpt::tfest::TMatchingPair> candidates_;
+    mutable std::vector<uint8_t>                    candidateCount_;
+    mutable std::vector<LocalPlane>                 localPlanes_;
+    mutable std::vector<double>                     histXs_, histValues_;
 
     void implMatchOneLayer(
         const mrpt::maps::CMetricMap& pcGlobal,
         const mrpt::maps::CPointsMap& pcLocal,
-        const mrpt::poses::CPose3D& localPose, MatchState& ms,
-        const layer_name_t& globalName, const layer_name_t& localName,
-        Pairings& out) const override;
+        const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+        MatchState& ms, const layer_name_t& globalName,
+        const layer_name_t& localName, Pairings& out) const override;
 };
 
 }  // namespace mp2p_icp
@@ -71,7 +71,8 @@ class Matcher_Points_Base : public Matcher
      * - `localPointsSampleSeed`: Only if `maxLocalPointsPerLayer`!=0, and the
      * number of points in the local map is larger than that number, a seed for
      * the RNG used to pick random point indices. `0` (default) means to use a
-     * time-based seed.
+     * time-based seed, or a fixed one if mp2p_icp::reproducible_mode() is
+     * enabled.
      *
      * - `pointLayerMatches`: Optional map of layer names to relative weights.
      *  Refer to example YAML files.
@@ -110,6 +111,11 @@ class Matcher_Points_Base : public Matcher
         const uint64_t                localPointsSampleSeed = 0);
 
    protected:
+    /** The maximum number of local points per layer to use in a match for
+     * the given context: maxLocalPointsPerLayer_, further limited by
+     * MatchContext::maxLocalPointsPerLayer, if set. "0" means "all". */
+    uint64_t maxLocalPoints(const MatchContext& mc) const;
+
     bool impl_match(
         const metric_map_t& pcGlobal, const metric_map_t& pcLocal,
         const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
@@ -119,9 +125,9 @@ class Matcher_Points_Base : public Matcher
     virtual void implMatchOneLayer(
         const mrpt::maps::CMetricMap& pcGlobal,
         const mrpt::maps::CPointsMap& pcLocal,
-        const mrpt::poses::CPose3D& localPose, MatchState& ms,
-        const layer_name_t& globalName, const layer_name_t& localName,
-        Pairings& out) const = 0;
+        const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+        MatchState& ms, const layer_name_t& globalName,
+        const layer_name_t& localName, Pairings& out) const = 0;
 };
 
 }  // namespace mp2p_icp
@@ -11,8 +11,12 @@
  */
 #pragma once
 
+#include <mp2p_icp/AdaptiveThreshold.h>
 #include <mp2p_icp/Matcher_Points_Base.h>
 
+#include <map>
+#include <utility>
+
 namespace mp2p_icp
 {
 /** Pointcloud matcher: fixed distance thresholds.
@@ -25,6 +29,11 @@ namespace mp2p_icp
  * member `weight_pt2pt_layers`. Refer to example configuration YAML files for
  * example configurations.
  *
+ * Optionally, the distance threshold can be set automatically for each pair
+ * of layers with an AdaptiveThreshold model, which learns the expected
+ * deviation of the initial guesses from the results of past alignments, and
+ * persists across ICP::align() calls (e.g. in odometry).
+ *
  * \ingroup mp2p_icp_grp
  */
 class Matcher_Points_DistanceThreshold : public Matcher_Points_Base
@@ -45,6 +54,9 @@ class Matcher_Points_DistanceThreshold : public Matcher_Points_Base
      * - `pairingsPerPoint`: Number of pairings in "global" for each "local"
      * points. Default=1. If more than one, they will be picked in ascending
      * order of distance, up to `threshold`. [optional].
+     * - `adaptiveThreshold`: If present, a map with the
+     * AdaptiveThresholdParameters to use instead of a fixed `threshold`,
+     * which then becomes optional. [optional].
      *
      * Plus: the parameters of Matcher_Points_Base::initialize()
      */
@@ -54,13 +66,44 @@ class Matcher_Points_DistanceThreshold : public Matcher_Points_Base
     double   thresholdAngularDeg = 0.50;  // deg
     uint32_t pairingsPerPoint    = 1;
 
+    /** If set, thresholds are computed by an AdaptiveThreshold model for
+     * each pair of layers, and `threshold` is ignored. */
+    std::optional<AdaptiveThresholdParameters> adaptiveThreshold;
+
+    /** The adaptive threshold model of a pair of layers, or nullptr if it
+     * has not been matched yet (or adaptiveThreshold is not set). */
+    const AdaptiveThreshold* adaptiveThresholdModel(
+        const layer_name_t& globalLayer, const layer_name_t& localLayer) const;
+
+    /** Forgets the history of the adaptive thresholds, e.g. upon an odometry
+     * reset. */
+    void resetAdaptiveThresholds() { adaptiveModels_.clear(); }
+
+    /** Feeds the adaptive models with the result of a finished alignment.
+     * Alignments ending in NoPairings, SolverError, Timeout or
+     * QualityCheckpointFailed are not used to update the models. */
+    void onAlignmentFinished(
+        const mrpt::poses::CPose3D& initialGuess,
+        const Results&              result) override;
+
    private:
+    struct AdaptiveModel
+    {
+        AdaptiveThreshold model;
+        double            maxRange = 0;  //!< Of the local layer [m]
+        bool              used     = false;  //!< In the current alignment
+    };
+
+    using layers_pair_t = std::pair<layer_name_t, layer_name_t>;
+
+    mutable std::map<layers_pair_t, AdaptiveModel> adaptiveModels_;
+
     void implMatchOneLayer(
         const mrpt::maps::CMetricMap& pcGlobal,
         const mrpt::maps::CPointsMap& pcLocal,
-        const mrpt::poses::CPose3D& localPose, MatchState& ms,
-        const layer_name_t& globalName, const layer_name_t& localName,
-        Pairings& out) const override;
+        const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+        MatchState& ms, const layer_name_t& globalName,
+        const layer_name_t& localName, Pairings& out) const override;
 };
 
 }  // namespace mp2p_icp
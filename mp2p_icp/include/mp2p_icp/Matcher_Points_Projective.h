@@ -0,0 +1,93 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   Matcher_Points_Projective.h
+ * @brief  Pointcloud matcher: projective association via range images
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mp2p_icp/Matcher_Points_Base.h>
+#include <mrpt/img/TCamera.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mp2p_icp
+{
+/** Pointcloud matcher: projective data association, for organized (e.g.
+ * LiDAR) scans.
+ *
+ * Instead of a KD-tree search, the `global` point layer is projected, from
+ * the current estimate of the local map pose, into a range image using a
+ * pinhole model with the same parameters as in
+ * QualityEvaluator_RangeImageSimilarity. Each pixel keeps the closest
+ * global point. Then, each local point is projected into the same image
+ * and paired with the global point(s) stored in its pixel (or in a small
+ * window around it), if closer than `threshold`.
+ *
+ * The range image is built once per ICP iteration and layer, in parallel
+ * if TBB is available, and associations take O(1) per local point.
+ * The simulated camera is placed at the origin of the local map, looking
+ * along +X.
+ *
+ * The `global` layer must be a point cloud (see MapToPointsMap()).
+ *
+ * \ingroup mp2p_icp_grp
+ */
+class Matcher_Points_Projective : public Matcher_Points_Base
+{
+    DEFINE_MRPT_OBJECT(Matcher_Points_Projective, mp2p_icp)
+
+   public:
+    Matcher_Points_Projective();
+
+    /** Parameters:
+     * - `ncols`, `nrows`, `cx`, `cy`, `fx`, `fy`: Range image camera model
+     *   [mandatory]
+     * - `threshold`: Inliers distance threshold [meters][mandatory]
+     * - `searchWindow`: Half size of the window of pixels to look for
+     *   candidates around each projected local point. Default=0 (only its
+     *   own pixel) [optional]
+     *
+     * Plus: the parameters of Matcher_Points_Base::initialize()
+     */
+    void initialize(const mrpt::containers::yaml& params) override;
+
+    /** Parameters for the simulated camera */
+    mrpt::img::TCamera rangeCamera;
+
+    double   threshold    = 0.50;  // m
+    uint32_t searchWindow = 0;
+
+   private:
+    /** Range image: for each pixel, the range (as float bits, high 32 bits)
+     * and the index of the closest global point (low 32 bits).
+     * Declared here to avoid memory reallocations. It is scratch memory, so
+     * it is not copied when the matcher is copied or cloned. */
+    struct RangeImage
+    {
+        RangeImage() = default;
+        RangeImage(const RangeImage&) {}
+        RangeImage& operator=(const RangeImage&) { return *this; }
+
+        std::unique_ptr<std::atomic<uint64_t>[]> pixels;
+        std::size_t                               size = 0;
+    };
+    mutable RangeImage rangeImage_;
+
+    void implMatchOneLayer(
+        const mrpt::maps::CMetricMap& pcGlobal,
+        const mrpt::maps::CPointsMap& pcLocal,
+        const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+        MatchState& ms, const layer_name_t& globalName,
+        const layer_name_t& localName, Pairings& out) const override;
+};
+
+}  // namespace mp2p_icp
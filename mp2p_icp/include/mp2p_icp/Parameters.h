@@ -7,6 +7,7 @@
 #pragma once
 
 #include <mp2p_icp/WeightParameters.h>
+#include <mp2p_icp/robust_kernels.h>
 #include <mrpt/containers/yaml.h>
 #include <mrpt/core/bits_math.h>  // DEG2RAD()
 #include <mrpt/serialization/CSerializable.h>
@@ -42,6 +43,72 @@ struct Parameters : public mrpt::serialization::CSerializable
      * below this threshold (in radians), iterations are terminated
      * (Default:1e-6) */
     double minAbsStep_rot{1e-4};
+
+    /** If >0, ICP runs in "anytime" mode: the wall-clock time [s] spent in
+     * the main iteration loop will not exceed this value. Once the budget
+     * is exhausted, iterations end with IterTermReason::Timeout and the best
+     * solution found so far (the one with the smallest mean squared residual
+     * of its pairings) is returned, with its quality. If that was not the
+     * last iteration, its pairings are matched again once at its pose.
+     *
+     * The cost of each iteration is estimated from the former one, or, for
+     * the first iteration, from the first iteration of the former call to
+     * ICP::align() on this object (if none, it is not checked). When the
+     * remaining time does not allow running one more iteration, the number
+     * of local points used by matchers derived from Matcher_Points_Base is
+     * reduced proportionally (down to timeBudgetMinLocalPoints) for the
+     * remaining iterations, via MatchContext::maxLocalPointsPerLayer. Matcher
+     * objects are not modified.
+     *
+     * Note that the final quality and covariance evaluation, and that final
+     * matching, are run after the loop and are not accounted for in this
+     * budget. See ICP::setTimeSource() to use a clock other than the wall
+     * clock.
+     *
+     * Default=0 (disabled, no time limit).
+     */
+    double timeBudget = 0;
+
+    /** Minimum number of local points per layer to keep when reducing the
+     * matchers workload to meet timeBudget. If even this amount would not
+     * fit in the remaining time, iterations end with IterTermReason::Timeout.
+     */
+    uint32_t timeBudgetMinLocalPoints = 200;
+    /** @} */
+
+    /** @name Iteratively reweighted least squares (IRLS)
+        @{ */
+
+    /** Number of solve-and-reweight cycles to run on the pairings of each
+     * ICP iteration, before running the matchers again. With the default (1),
+     * each solver call is followed by a new matching pass (classic ICP).
+     *
+     * For N>1, after the first solver call, the point-to-point pairings are
+     * given individual weights (Pairings::point_weights) w(e^2) from the
+     * residuals e at the current solution, using the robust kernel
+     * irlsKernel, and solvers are invoked again, up to N-1 times or until
+     * the step is below minAbsStep_trans and minAbsStep_rot.
+     * Since matching usually dominates the cost of ICP, this amortizes it
+     * over more solver work. Other pairing types keep their weights.
+     * Pairings without weights from the matchers start from the
+     * Solver_GaussNewton `pair_weights.pt2pt` weight. All enabled solvers
+     * must support point weights (see Solver::supportsPointWeights()), e.g.
+     * Solver_Horn and Solver_OLAE do not.
+     *
+     * In those reweighted solver calls, solvers do not apply their own robust
+     * kernel (e.g. Solver_GaussNewton `robustKernel`) to point-to-point
+     * pairings, so residuals are not robustified twice (see
+     * SolverContext::pointWeightsAreRobust). Other pairing types still use
+     * the solver kernel.
+     */
+    uint32_t solverIterationsPerMatching = 1;
+
+    /** Robust kernel used to compute IRLS weights. Must not be None if
+     * solverIterationsPerMatching>1. */
+    RobustKernel irlsKernel = RobustKernel::Cauchy;
+
+    /** Parameter of irlsKernel [m] */
+    double irlsKernelParam = 0.5;
     /** @} */
 
     /** @name Debugging and logging
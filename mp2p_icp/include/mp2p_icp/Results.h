@@ -40,6 +40,10 @@ struct Results
     /** A copy of the pairings found in the last ICP iteration. */
     Pairings finalPairings;
 
+    /** Approximate RAM usage of the input local and global maps [bytes].
+     * \sa metric_map_t::memory_footprint() */
+    size_t localMapMemory = 0, globalMapMemory = 0;
+
     void serializeTo(mrpt::serialization::CArchive& out) const;
     void serializeFrom(mrpt::serialization::CArchive& in);
 
@@ -0,0 +1,170 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ScanContext.h
+ * @brief  Scan Context-like global descriptors for place recognition
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/maps/CPointsMap.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace mp2p_icp
+{
+/** Parameters for ScanContextDescriptor and ScanContextDatabase.
+ * \ingroup mp2p_icp_grp
+ */
+struct ScanContextParameters
+{
+    /** Number of radial bins ("rings") */
+    uint32_t num_rings = 20;
+
+    /** Number of azimuthal bins ("sectors") */
+    uint32_t num_sectors = 60;
+
+    /** Points farther than this (in the XY plane) are ignored [m] */
+    double max_radius = 80.0;
+
+    /** Added to the point "z" coordinates, so most points (including the
+     * ground) have positive heights, as empty bins are stored as 0 [m] */
+    double z_offset = 2.0;
+
+    /** Number of candidates preselected by their (rotation invariant) ring
+     * keys, before evaluating the full descriptor distance to them. */
+    uint32_t num_candidates = 10;
+
+    void load_from_yaml(const mrpt::containers::yaml& c);
+};
+
+/** A Scan Context-like global descriptor of a point cloud [Kim & Kim,
+ * IROS 2018]: a polar (ring x sector) grid holding the maximum height of the
+ * points in each bin, plus a rotation invariant "ring key" (mean of each
+ * ring) used for fast candidate preselection.
+ *
+ * \ingroup mp2p_icp_grp
+ */
+struct ScanContextDescriptor
+{
+    uint32_t num_rings = 0, num_sectors = 0;
+
+    /** Max heights, in row-major order (ring by ring). Empty bins are 0. */
+    std::vector<float> bins;
+
+    /** Mean of each ring (length=num_rings). */
+    std::vector<float> ringKey;
+
+    /** Copied from metric_map_t::id / label, if built from a metric map. */
+    std::optional<uint64_t>    id;
+    std::optional<std::string> label;
+
+    float at(uint32_t ring, uint32_t sector) const
+    {
+        return bins[ring * num_sectors + sector];
+    }
+
+    bool empty() const { return bins.empty(); }
+};
+
+/** Builds the descriptor of a point cloud, given in the sensor/vehicle
+ * frame of reference.
+ * \ingroup mp2p_icp_grp
+ */
+ScanContextDescriptor scan_context_descriptor(
+    const mrpt::maps::CPointsMap& pc, const ScanContextParameters& p);
+
+/** Builds the descriptor of a point cloud layer of a metric map, copying
+ * its `id` and `label` into the descriptor.
+ * \ingroup mp2p_icp_grp
+ */
+ScanContextDescriptor scan_context_descriptor(
+    const metric_map_t& m, const layer_name_t& pointLayer,
+    const ScanContextParameters& p);
+
+/** Output of scan_context_distance() */
+struct ScanContextDistance
+{
+    /** Distance in the range [0,1]. 0=identical descriptors. */
+    double distance = 1.0;
+
+    /** Estimated relative yaw of the first descriptor ("query") with respect
+     * to the second one ("candidate") [rad], in the range [-pi,pi]. It can
+     * be used as initial guess for ICP. */
+    double yaw = 0;
+};
+
+/** Column-shift invariant distance between two descriptors: the mean cosine
+ * distance of their sectors, for the best circular shift of sectors.
+ * Both descriptors must have the same dimensions.
+ * \ingroup mp2p_icp_grp
+ */
+ScanContextDistance scan_context_distance(
+    const ScanContextDescriptor& query, const ScanContextDescriptor& candidate);
+
+/** A database of ScanContextDescriptor for, e.g., keyframes of a map, with
+ * a parallel search of the most similar descriptors to a given one.
+ *
+ * The search first preselects `num_candidates` entries by the distance of
+ * their ring keys, then evaluates scan_context_distance() to those
+ * candidates only. Results carry the `id` and `label` of the original
+ * metric_map_t objects, so they can be mapped back to keyframes.
+ *
+ * \ingroup mp2p_icp_grp
+ */
+class ScanContextDatabase
+{
+   public:
+    ScanContextDatabase() = default;
+    explicit ScanContextDatabase(const ScanContextParameters& p) : params(p) {}
+
+    ScanContextParameters params;
+
+    /** Adds a new entry, from an existing descriptor.
+     *  \return The index of the new entry in the database.
+     */
+    std::size_t add(ScanContextDescriptor&& d);
+
+    /** Builds the descriptor of the given metric map layer and adds it.
+     *  \return The index of the new entry in the database.
+     */
+    std::size_t add(const metric_map_t& m, const layer_name_t& pointLayer);
+
+    struct Match
+    {
+        std::size_t                index = 0;  //!< Index in the database
+        std::optional<uint64_t>    id;  //!< metric_map_t::id of the entry
+        std::optional<std::string> label;  //!< metric_map_t::label
+        ScanContextDistance        distance;
+    };
+
+    /** Returns the (up to) `topK` most similar entries to a given
+     * descriptor, sorted by ascending distance.
+     *
+     * \param ignoreLastN Entries with indices >= size()-ignoreLastN are not
+     *        considered, e.g. to exclude the most recent keyframes while
+     *        looking for loop closures.
+     */
+    std::vector<Match> query(
+        const ScanContextDescriptor& d, std::size_t topK = 1,
+        std::size_t ignoreLastN = 0) const;
+
+    const ScanContextDescriptor& at(std::size_t i) const { return db_.at(i); }
+    std::size_t                  size() const { return db_.size(); }
+    bool                         empty() const { return db_.empty(); }
+    void                         clear() { db_.clear(); }
+
+   private:
+    std::vector<ScanContextDescriptor> db_;
+};
+
+}  // namespace mp2p_icp
@@ -53,6 +53,12 @@ struct SolverContext
         perSolverPersistentData;
 
     std::optional<uint32_t> icpIteration;
+
+    /** Set by ICP in IRLS mode (Parameters::solverIterationsPerMatching>1)
+     * when Pairings::point_weights already include the weights of a robust
+     * kernel. Solvers must not apply their own robust kernel again to
+     * point-to-point pairings then. */
+    bool pointWeightsAreRobust = false;
 };
 
 /** Virtual base class for optimal alignment solvers (one step in ICP).
@@ -95,6 +101,12 @@ class Solver : public mrpt::system::COutputLogger,
     /** Can be used to disable one of a set of solvers in a pipeline */
     bool enabled = true;
 
+    /** Whether this solver honors individual point weights
+     * (Pairings::point_weights) and SolverContext::pointWeightsAreRobust, as
+     * required by the ICP IRLS mode (Parameters::solverIterationsPerMatching).
+     */
+    virtual bool supportsPointWeights() const { return true; }
+
    protected:
     virtual bool impl_optimal_pose(
         const Pairings& pairings, OptimalTF_Result& out,
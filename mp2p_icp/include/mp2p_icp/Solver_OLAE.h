@@ -30,6 +30,11 @@ class Solver_OLAE : public Solver
 
     void initialize(const mrpt::containers::yaml& params) override;
 
+    /** Point weights only scale the attitude terms, and the robust kernel of
+     * pairingsWeightParameters is always applied, so IRLS is not supported.
+     */
+    bool supportsPointWeights() const override { return false; }
+
    protected:
     // See base class docs
     bool impl_optimal_pose(
@@ -49,6 +49,10 @@ struct OptimalTF_GN_Parameters
     RobustKernel kernel      = RobustKernel::None;
     double       kernelParam = 1.0;
 
+    /** If false, `kernel` is not applied to point-to-point pairings, e.g.
+     * because Pairings::point_weights already include a robust kernel. */
+    bool kernelOnPointPairings = true;
+
     bool verbose = false;
 };
 
@@ -0,0 +1,101 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   AdaptiveThreshold.cpp
+ * @brief  KISS-ICP-like adaptive correspondence distance thresholds
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/AdaptiveThreshold.h>
+#include <mrpt/core/bits_math.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace mp2p_icp;
+
+void AdaptiveThresholdParameters::load_from_yaml(
+    const mrpt::containers::yaml& c)
+{
+    MCP_LOAD_OPT(c, initial_threshold);
+    MCP_LOAD_OPT(c, min_motion);
+    MCP_LOAD_OPT(c, min_threshold);
+    MCP_LOAD_OPT(c, max_threshold);
+    MCP_LOAD_OPT(c, sigma_multiplier);
+    MCP_LOAD_OPT(c, window_length);
+    MCP_LOAD_OPT(c, shrink_with_icp_steps);
+
+    ASSERT_GT_(min_threshold, 0.0);
+    ASSERT_GE_(max_threshold, min_threshold);
+    ASSERT_GT_(sigma_multiplier, 0.0);
+}
+
+double AdaptiveThreshold::deviation(
+    const mrpt::poses::CPose3D& poseError, double maxRange)
+{
+    // Rotation angle, from the trace of the rotation matrix:
+    const auto&  R        = poseError.getRotationMatrix();
+    const double cosTheta = 0.5 * (R(0, 0) + R(1, 1) + R(2, 2) - 1.0);
+    const double theta    = std::acos(std::clamp(cosTheta, -1.0, 1.0));
+
+    return 2 * maxRange * std::sin(0.5 * theta) +
+           poseError.translation().norm();
+}
+
+void AdaptiveThreshold::update(
+    const mrpt::poses::CPose3D& initialGuess,
+    const mrpt::poses::CPose3D& solution, double maxRange)
+{
+    const double dev = deviation(solution - initialGuess, maxRange);
+    if (dev <= params.min_motion) return;
+
+    const double devSqr = mrpt::square(dev);
+    sumDevSqr_ += devSqr;
+    count_++;
+
+    if (params.window_length == 0) return;
+
+    window_.push_back(devSqr);
+    while (window_.size() > params.window_length)
+    {
+        sumDevSqr_ -= window_.front();
+        window_.pop_front();
+        count_--;
+    }
+}
+
+std::optional<double> AdaptiveThreshold::sigma() const
+{
+    if (count_ == 0) return {};
+    return std::sqrt(std::max(.0, sumDevSqr_) / static_cast<double>(count_));
+}
+
+double AdaptiveThreshold::threshold(
+    const std::optional<mrpt::poses::CPose3D>& lastIcpStepIncrement,
+    double                                     maxRange) const
+{
+    const auto s = sigma();
+
+    double thres =
+        s.has_value() ? params.sigma_multiplier * *s : params.initial_threshold;
+
+    if (params.shrink_with_icp_steps && lastIcpStepIncrement.has_value())
+    {
+        mrpt::keep_min(
+            thres, params.sigma_multiplier *
+                       deviation(*lastIcpStepIncrement, maxRange));
+    }
+
+    return std::clamp(thres, params.min_threshold, params.max_threshold);
+}
+
+void AdaptiveThreshold::reset()
+{
+    sumDevSqr_ = 0;
+    count_     = 0;
+    window_.clear();
+}
@@ -11,19 +11,189 @@
  */
 
 #include <mp2p_icp/ICP.h>
+#include <mp2p_icp/Matcher_Points_Base.h>
+#include <mp2p_icp/ProfilerEntry.h>
+#include <mp2p_icp/Solver_GaussNewton.h>
 #include <mp2p_icp/covariance.h>
+#include <mp2p_icp/errorTerms.h>
+#include <mrpt/core/Clock.h>
 #include <mrpt/core/exceptions.h>
 #include <mrpt/core/lock_helper.h>
 #include <mrpt/poses/Lie/SE.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/tfest/se3.h>
 
+#include <limits>
 #include <regex>
 
 IMPLEMENTS_MRPT_OBJECT(ICP, mrpt::rtti::CObject, mp2p_icp)
 
 using namespace mp2p_icp;
 
+namespace
+{
+// Used in "anytime" mode (Parameters::timeBudget) to estimate the cost of the
+// next ICP iteration and, if needed, to reduce the number of local points used
+// by point matchers. The reduced amount is passed to matchers via
+// MatchContext::maxLocalPointsPerLayer, so matcher objects are never modified.
+class LocalPointsBudget
+{
+   public:
+    LocalPointsBudget(
+        const mp2p_icp::matcher_list_t& matchers,
+        const mp2p_icp::metric_map_t&   pcLocal,
+        const std::optional<double>&    secondsPerPoint)
+        : secondsPerPoint_(secondsPerPoint)
+    {
+        // Largest local point layer, used when "0" (all points) is set:
+        std::size_t largestLocalLayer = 0;
+        for (const auto& [name, layer] : pcLocal.layers)
+        {
+            if (!layer) continue;
+            if (const auto pts = mp2p_icp::MapToPointsMap(*layer); pts)
+                mrpt::keep_max(largestLocalLayer, pts->size());
+        }
+
+        // Current (largest) amount of local points used by any matcher:
+        for (const auto& m : matchers)
+        {
+            auto mpb = std::dynamic_pointer_cast<Matcher_Points_Base>(m);
+            if (!mpb) continue;
+
+            std::size_t n = mpb->maxLocalPointsPerLayer_;
+            if (n == 0 || n > largestLocalLayer) n = largestLocalLayer;
+            mrpt::keep_max(current_, n);
+        }
+    }
+
+    /// The limit to pass in MatchContext::maxLocalPointsPerLayer: empty
+    /// unless the workload has been reduced.
+    std::optional<uint64_t> limit() const
+    {
+        if (!reduced_) return {};
+        return current_;
+    }
+
+    /// Estimated duration [s] of one ICP iteration with the current limit,
+    /// if there is a measured iteration to estimate it from.
+    std::optional<double> estimatedIterationTime() const
+    {
+        if (!secondsPerPoint_ || current_ == 0) return {};
+        return *secondsPerPoint_ * static_cast<double>(current_);
+    }
+
+    /// Updates the time model with an iteration run with the current limit.
+    void addIterationTime(double seconds)
+    {
+        if (current_ == 0) return;
+        secondsPerPoint_ = seconds / static_cast<double>(current_);
+        if (!firstSecondsPerPoint_) firstSecondsPerPoint_ = secondsPerPoint_;
+    }
+
+    /// The time model of the first iteration, the one with the largest
+    /// workload, to be used in the first iteration of the next alignment.
+    const std::optional<double>& firstSecondsPerPoint() const
+    {
+        return firstSecondsPerPoint_;
+    }
+
+    /** Scales down the number of local points by the given ratio in (0,1).
+     *  Returns false if it cannot be reduced above minPoints. */
+    bool reduce(double ratio, std::size_t minPoints)
+    {
+        const auto newCount = static_cast<std::size_t>(
+            static_cast<double>(current_) * ratio);
+        if (newCount < minPoints || newCount == 0) return false;
+
+        current_ = newCount;
+        reduced_ = true;
+        return true;
+    }
+
+   private:
+    std::size_t           current_ = 0;
+    bool                  reduced_ = false;
+    std::optional<double> secondsPerPoint_, firstSecondsPerPoint_;
+};
+
+// Mean squared residual of all point-to-{point,line,plane} pairings, for the
+// given relative pose. Used to pick the best solution in "anytime" mode.
+double mean_squared_error(
+    const Pairings& pairings, const mrpt::poses::CPose3D& pose)
+{
+    const std::size_t n = pairings.paired_pt2pt.size() +
+                          pairings.paired_pt2ln.size() +
+                          pairings.paired_pt2pl.size();
+    if (n == 0) return std::numeric_limits<double>::max();
+
+    double     sumSqr = 0;
+    const auto addSqr = [&](const auto& err)
+    { sumSqr += err.asEigen().squaredNorm(); };
+
+    for (const auto& pair : pairings.paired_pt2pt)
+        addSqr(mp2p_icp::error_point2point(pair, pose));
+    for (const auto& pair : pairings.paired_pt2ln)
+        addSqr(mp2p_icp::error_point2line(pair, pose));
+    for (const auto& pair : pairings.paired_pt2pl)
+        addSqr(mp2p_icp::error_point2plane(pair, pose));
+
+    return sumSqr / static_cast<double>(n);
+}
+
+using point_weights_t = decltype(Pairings::point_weights);
+
+// Weight of pt2pt pairings without individual weights in the solvers, i.e.
+// Solver_GaussNewton `pair_weights.pt2pt`:
+double default_pt2pt_weight(const ICP::solver_list_t& solvers)
+{
+    for (const auto& s : solvers)
+    {
+        if (auto gn = std::dynamic_pointer_cast<Solver_GaussNewton>(s); gn)
+            return gn->pairWeights.pt2pt;
+    }
+    return 1.0;
+}
+
+// Sets individual weights for all pt2pt pairings: the original weights
+// (`baseWeights`, in the run-length format of Pairings::point_weights, or
+// `defaultWeight` for pairings without them) times the robust kernel weight
+// of their residuals for the given pose.
+void irls_reweight(
+    Pairings& pairings, const point_weights_t& baseWeights,
+    double defaultWeight, const mrpt::poses::CPose3D& pose,
+    const robust_sqrt_weight_func_t& kernel)
+{
+    const auto& pt2pt   = pairings.paired_pt2pt;
+    auto&       weights = pairings.point_weights;
+
+    weights.clear();
+    weights.reserve(pt2pt.size());
+
+    std::size_t i              = 0;
+    const auto  lambdaReweight = [&](std::size_t count, double baseWeight)
+    {
+        for (; count > 0 && i < pt2pt.size(); count--, i++)
+        {
+            const auto& pair = pt2pt[i];
+
+            double gx, gy, gz;
+            pose.composePoint(
+                pair.local.x, pair.local.y, pair.local.z, gx, gy, gz);
+
+            const double errSqr = mrpt::square(gx - pair.global.x) +
+                                  mrpt::square(gy - pair.global.y) +
+                                  mrpt::square(gz - pair.global.z);
+
+            weights.emplace_back(1, baseWeight * kernel(errSqr));
+        }
+    };
+
+    for (const auto& [count, w] : baseWeights) lambdaReweight(count, w);
+    // The rest, if no base weights:
+    lambdaReweight(pt2pt.size() - i, defaultWeight);
+}
+}  // namespace
+
 void ICP::align(
     const metric_map_t& pcLocal, const metric_map_t& pcGlobal,
     const mrpt::math::TPose3D& initialGuessLocalWrtGlobal, const Parameters& p,
@@ -35,7 +205,12 @@ void ICP::align(
 
     MRPT_START
 
-    mrpt::system::CTimeLoggerEntry tle(profiler_, "align");
+    ProfilerEntry tle(profiler_, "align");
+
+    const auto lambdaNow = [this]()
+    { return time_source_ ? time_source_() : mrpt::Clock::nowDouble(); };
+
+    const double tStart = lambdaNow();
 
     // ----------------------------
     // Initial sanity checks
@@ -50,7 +225,7 @@ void ICP::align(
     // ----------------------------
     // Preparation
     // ----------------------------
-    mrpt::system::CTimeLoggerEntry tle1(profiler_, "align.1_prepare");
+    ProfilerEntry tle1(profiler_, "align.1_prepare");
     // Reset output:
     result = Results();
 
@@ -96,7 +271,7 @@ void ICP::align(
     // ------------------------------------------------------
     // Main ICP loop
     // ------------------------------------------------------
-    mrpt::system::CTimeLoggerEntry tle2(profiler_, "align.2_create_state");
+    ProfilerEntry tle2(profiler_, "align.2_create_state");
 
     ICP_State state(pcGlobal, pcLocal);
     if (currentLog) state.log = &currentLog.value();
@@ -113,10 +288,92 @@ void ICP::align(
     SolverContext                       sc;
     sc.prior = prior;
 
+    // IRLS mode:
+    const auto irlsKernel =
+        create_robust_kernel(p.irlsKernel, p.irlsKernelParam);
+    ASSERTMSG_(
+        p.solverIterationsPerMatching <= 1 || irlsKernel,
+        "solverIterationsPerMatching>1 requires irlsKernel!=None");
+
+    double irlsDefaultWeight = 1.0;
+    if (p.solverIterationsPerMatching > 1)
+    {
+        for (const auto& s : solvers_)
+        {
+            ASSERTMSG_(
+                !s->enabled || s->supportsPointWeights(),
+                mrpt::format(
+                    "solverIterationsPerMatching>1 requires solvers using "
+                    "Pairings::point_weights, but '%s' does not",
+                    s->GetRuntimeClass()->className));
+        }
+        irlsDefaultWeight = default_pt2pt_weight(solvers_);
+    }
+
+    // "Anytime" mode:
+    const bool                       hasTimeBudget = p.timeBudget > 0;
+    std::optional<LocalPointsBudget> pointsBudget;
+    if (hasTimeBudget)
+        pointsBudget.emplace(matchers_, pcLocal, anytimeSecondsPerPoint_);
+
+    // Best iterate so far, returned upon timeout. Its pairings are not
+    // copied, but matched again if it was not the last iteration:
+    struct BestIterate
+    {
+        double           meanSqrError = 0;
+        OptimalTF_Result solution;
+        uint32_t         iteration = 0;
+    };
+    std::optional<BestIterate> best;
+
     for (result.nIterations = 0; result.nIterations < p.maxIterations;
          result.nIterations++)
     {
-        mrpt::system::CTimeLoggerEntry tle3(profiler_, "align.3_iter");
+        const double tIterStart = lambdaNow();
+
+        // Time budget: do we have time enough for one more iteration?
+        if (hasTimeBudget)
+        {
+            const double remaining = p.timeBudget - (tIterStart - tStart);
+
+            // Reduce the matchers workload, if it seems we could not finish
+            // this iteration otherwise. For the first iteration, the estimate
+            // comes from the former call to align(), if any:
+            bool timeout = remaining <= 0;
+            if (const auto estimated = pointsBudget->estimatedIterationTime();
+                !timeout && estimated && *estimated > remaining)
+            {
+                timeout = !pointsBudget->reduce(
+                    remaining / *estimated, p.timeBudgetMinLocalPoints);
+            }
+
+            if (timeout)
+            {
+                result.terminationReason = IterTermReason::Timeout;
+                if (best && best->iteration + 1 != result.nIterations)
+                {
+                    state.currentSolution = best->solution;
+
+                    MatchContext mc;
+                    mc.icpIteration           = result.nIterations;
+                    mc.maxLocalPointsPerLayer = pointsBudget->limit();
+
+                    state.currentPairings = run_matchers(
+                        matchers_, state.pcGlobal, state.pcLocal,
+                        state.currentSolution.optimalPose, mc);
+                }
+                if (p.debugPrintIterationProgress)
+                {
+                    printf(
+                        "[ICP] Iter=%3u Time budget exhausted (%.03f ms).\n",
+                        static_cast<unsigned int>(result.nIterations),
+                        1e3 * p.timeBudget);
+                }
+                break;
+            }
+        }
+
+        ProfilerEntry tle3(profiler_, "align.3_iter");
 
         // Update iteration count, both in direct C++ structure...
         state.currentIteration = result.nIterations;
@@ -130,9 +387,11 @@ void ICP::align(
         // Matchings
         // ---------------------------------------
         MatchContext mc;
-        mc.icpIteration = state.currentIteration;
+        mc.icpIteration         = state.currentIteration;
+        mc.lastIcpStepIncrement = lastCorrection;
+        if (pointsBudget) mc.maxLocalPointsPerLayer = pointsBudget->limit();
 
-        mrpt::system::CTimeLoggerEntry tle4(profiler_, "align.3.1_matchers");
+        ProfilerEntry tle4(profiler_, "align.3.1_matchers");
 
         state.currentPairings = run_matchers(
             matchers_, state.pcGlobal, state.pcLocal,
@@ -154,7 +413,7 @@ void ICP::align(
 
         // Optimal relative pose:
         // ---------------------------------------
-        mrpt::system::CTimeLoggerEntry tle5(profiler_, "align.3.2_solvers");
+        ProfilerEntry tle5(profiler_, "align.3.2_solvers");
 
         sc.icpIteration = state.currentIteration;
         sc.guessRelativePose.emplace(state.currentSolution.optimalPose);
@@ -180,9 +439,61 @@ void ICP::align(
             break;
         }
 
+        // IRLS: more solve-and-reweight cycles on the same pairings?
+        if (p.solverIterationsPerMatching > 1 &&
+            !state.currentPairings.paired_pt2pt.empty())
+        {
+            ProfilerEntry tle5b(profiler_, "align.3.2_solvers_irls");
+
+            const auto baseWeights = state.currentPairings.point_weights;
+
+            // IRLS weights already include the robust kernel:
+            sc.pointWeightsAreRobust = true;
+
+            for (uint32_t k = 1; k < p.solverIterationsPerMatching; k++)
+            {
+                const auto lastPose = state.currentSolution.optimalPose;
+
+                irls_reweight(
+                    state.currentPairings, baseWeights, irlsDefaultWeight,
+                    lastPose, irlsKernel);
+
+                sc.guessRelativePose.emplace(lastPose);
+                sc.currentCorrectionFromInitialGuess = lastPose - initGuess;
+
+                if (!run_solvers(
+                        solvers_, state.currentPairings, state.currentSolution,
+                        sc))
+                {
+                    // Keep the last good solution:
+                    state.currentSolution.optimalPose = lastPose;
+                    break;
+                }
+
+                const auto d = mrpt::poses::Lie::SE<3>::log(
+                    state.currentSolution.optimalPose - lastPose);
+                if (d.blockCopy<3, 1>(0, 0).norm() < p.minAbsStep_trans &&
+                    d.blockCopy<3, 1>(3, 0).norm() < p.minAbsStep_rot)
+                    break;
+            }
+
+            // Pairings are kept as returned by the matchers:
+            state.currentPairings.point_weights = baseWeights;
+            sc.pointWeightsAreRobust            = false;
+        }
+
+        // Keep the best solution so far, in case we run out of time:
+        if (hasTimeBudget)
+        {
+            const double err = mean_squared_error(
+                state.currentPairings, state.currentSolution.optimalPose);
+            if (!best || err <= best->meanSqrError)
+                best = BestIterate{
+                    err, state.currentSolution, state.currentIteration};
+        }
+
         // Updated solution is already in "state.currentSolution".
-        mrpt::system::CTimeLoggerEntry tle6(
-            profiler_, "align.3.3_end_criterions");
+        ProfilerEntry tle6(profiler_, "align.3.3_end_criterions");
 
         // Termination criterion: small delta:
         auto lambdaCalcIncrs = [](const mrpt::poses::CPose3D& deltaSol)
@@ -309,8 +620,15 @@ void ICP::align(
         // roll values back:
         prev2_solution = prev_solution;
         prev_solution  = state.currentSolution.optimalPose;
+
+        if (pointsBudget)
+            pointsBudget->addIterationTime(lambdaNow() - tIterStart);
     }
 
+    // Keep the time model for the first iteration of the next call:
+    if (pointsBudget && pointsBudget->firstSecondsPerPoint())
+        anytimeSecondsPerPoint_ = pointsBudget->firstSecondsPerPoint();
+
     // ----------------------------
     // Fill in "result"
     // ----------------------------
@@ -318,7 +636,7 @@ void ICP::align(
         result.terminationReason = IterTermReason::MaxIterations;
 
     // Quality:
-    mrpt::system::CTimeLoggerEntry tle7(profiler_, "align.4_quality");
+    ProfilerEntry tle7(profiler_, "align.4_quality");
 
     for (auto& e : quality_evaluators_) lambdaAddOwnParams(*e.obj);
     lambdaRealizeParamSources();
@@ -333,6 +651,8 @@ void ICP::align(
     result.optimal_tf.mean = state.currentSolution.optimalPose;
     result.optimalScale    = state.currentSolution.optimalScale;
     result.finalPairings   = std::move(state.currentPairings);
+    result.localMapMemory  = pcLocal.memory_footprint().total();
+    result.globalMapMemory = pcGlobal.memory_footprint().total();
 
     // Covariance:
     mp2p_icp::CovarianceParameters covParams;
@@ -340,10 +660,13 @@ void ICP::align(
     result.optimal_tf.cov = mp2p_icp::covariance(
         result.finalPairings, result.optimal_tf.mean, covParams);
 
+    // Let matchers update their models of the expected alignment errors:
+    for (auto& m : matchers_) m->onAlignmentFinished(initGuess, result);
+
     // ----------------------------
     // Log records
     // ----------------------------
-    mrpt::system::CTimeLoggerEntry tle8(profiler_, "align.5_save_log");
+    ProfilerEntry tle8(profiler_, "align.5_save_log");
 
     if (currentLog)
     {
@@ -18,6 +18,15 @@
 #include <mrpt/math/distributions.h>  // confidenceIntervalsFromHistogram()
 #include <mrpt/version.h>
 
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+#if defined(MP2P_HAS_TBB)
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+#endif
+
 IMPLEMENTS_MRPT_OBJECT(Matcher_Adaptive, Matcher, mp2p_icp)
 
 using namespace mp2p_icp;
@@ -52,9 +61,9 @@ void Matcher_Adaptive::initialize(const mrpt::containers::yaml& params)
 void Matcher_Adaptive::implMatchOneLayer(
     const mrpt::maps::CMetricMap& pcGlobalMap,
     const mrpt::maps::CPointsMap& pcLocal,
-    const mrpt::poses::CPose3D& localPose, MatchState& ms,
-    const layer_name_t& globalName, const layer_name_t& localName,
-    Pairings& out) const
+    const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+    MatchState& ms, const layer_name_t& globalName,
+    const layer_name_t& localName, Pairings& out) const
 {
     MRPT_START
 
@@ -67,7 +76,7 @@ void Matcher_Adaptive::implMatchOneLayer(
     if (pcGlobalMap.isEmpty() || pcLocal.empty()) return;
 
     const TransformedLocalPointCloud tl = transform_local_to_global(
-        pcLocal, localPose, maxLocalPointsPerLayer_, localPointsSampleSeed_);
+        pcLocal, localPose, maxLocalPoints(mc), localPointsSampleSeed_);
 
     // Try to do matching only if the bounding boxes have some overlap:
     if (!pcGlobalMap.boundingBox().intersection(
@@ -78,47 +87,59 @@ void Matcher_Adaptive::implMatchOneLayer(
     // Prepare output: no correspondences initially:
     out.paired_pt2pt.reserve(out.paired_pt2pt.size() + pcLocal.size());
 
-    // Loop for each point in local map:
-    // --------------------------------------------------
     const float absoluteMaxDistSqr = mrpt::square(absoluteMaxSearchDistance);
 
     const auto& lxs = pcLocal.getPointsBufferRef_x();
     const auto& lys = pcLocal.getPointsBufferRef_y();
     const auto& lzs = pcLocal.getPointsBufferRef_z();
 
-    // In order to find the closest association for each global point, we must
-    // first build this temporary list of *potential* associations, indexed by
-    // global point indices, and sorted by errSqr:
+    const size_t nLocals = tl.x_locals.size();
 
-    // List of all 1st and 2nd closest pairings to each
-    matchesPerLocal_.clear();
-    matchesPerLocal_.resize(tl.x_locals.size());
+    // Candidate pairings of each transformed local point "i" (not to be
+    // confused with its index in pcLocal, if subsampled):
+    candidates_.resize(nLocals * MAX_CORRS_PER_LOCAL);
+    candidateCount_.assign(nLocals, 0);
+    if (enableDetectPlanes) localPlanes_.assign(nLocals, {});
 
-    // Calculate limits for the histogram:
-    std::optional<float> minSqrErrorForHistogram;
-    std::optional<float> maxSqrErrorForHistogram;
+    const uint32_t nn_search_max_points =
+        enableDetectPlanes ? planeSearchPoints : maxPt2PtCorrespondences;
+
+    // Make sure the 3D kd-trees (if used internally) are up to date, from this
+    // single-thread call before entering into parallelization:
+    nnGlobal.nn_prepare_for_3d_queries();
 
-    const auto lambdaAddPair =
-        [&](const size_t localIdx, const mrpt::math::TPoint3Df& globalPt,
-            const uint64_t globalIdxOrID, const float errSqr)
+    // Per-thread temporary buffers:
+    struct Buffers
     {
-        auto& ps = matchesPerLocal_.at(localIdx);
-        if (ps.size() >= MAX_CORRS_PER_LOCAL) return;
+        std::vector<uint64_t>              neighborIndices;
+        std::vector<float>                 neighborSqrDists;
+        std::vector<mrpt::math::TPoint3Df> neighborPts;
+        std::vector<float>                 xs, ys, zs;
+    };
 
-        mrpt::tfest::TMatchingPair p;
-        p.globalIdx = globalIdxOrID;
-        p.localIdx  = localIdx;
-        p.global    = globalPt;
-        p.local     = {lxs[localIdx], lys[localIdx], lzs[localIdx]};
-        p.errorSquareAfterTransformation = errSqr;
+    // 1st pass: search for candidate pairings and fit local planes, while
+    // finding the range of the 1st and 2nd closest squared distances:
+    struct ErrorRange
+    {
+        std::optional<float> minSqr, maxSqr;
 
-        ps.push_back(p);
+        void add(float errSqr)
+        {
+            if (maxSqr)
+            {
+                mrpt::keep_max(*maxSqr, errSqr);
+                mrpt::keep_min(*minSqr, errSqr);
+            }
+            else
+            {
+                maxSqr = errSqr;
+                minSqr = errSqr;
+            }
+        }
     };
 
-    const uint32_t nn_search_max_points =
-        enableDetectPlanes ? planeSearchPoints : maxPt2PtCorrespondences;
-
-    for (size_t i = 0; i < tl.x_locals.size(); i++)
+    const auto lambdaProcessLocal =
+        [&](const size_t i, Buffers& b, ErrorRange& range)
     {
         const size_t localIdx = tl.idxs.has_value() ? (*tl.idxs)[i] : i;
 
@@ -127,7 +148,7 @@ void Matcher_Adaptive::implMatchOneLayer(
         {
             // skip, already paired, e.g. by another Matcher in the pipeline
             // before me:
-            continue;
+            return;
         }
 
         const float lx = tl.x_locals[i], ly = tl.y_locals[i],
@@ -137,64 +158,124 @@ void Matcher_Adaptive::implMatchOneLayer(
         // (x_local, y_local, z_local) in the global map:
         if (nn_search_max_points == 1)
         {
-            neighborSqrDists_.resize(1);
-            neighborIndices_.resize(1);
-            neighborPts_.resize(1);
+            b.neighborSqrDists.resize(1);
+            b.neighborIndices.resize(1);
+            b.neighborPts.resize(1);
 
             if (!nnGlobal.nn_single_search(
                     {lx, ly, lz},  // Look closest to this guy
-                    neighborPts_[0], neighborSqrDists_[0], neighborIndices_[0]))
+                    b.neighborPts[0], b.neighborSqrDists[0],
+                    b.neighborIndices[0]))
             {
-                neighborPts_.clear();
-                neighborSqrDists_.clear();
-                neighborIndices_.clear();
+                b.neighborPts.clear();
+                b.neighborSqrDists.clear();
+                b.neighborIndices.clear();
             }
         }
         else
         {
             nnGlobal.nn_radius_search(
                 {lx, ly, lz},  // Look closest to this guy
-                absoluteMaxDistSqr, neighborPts_, neighborSqrDists_,
-                neighborIndices_, nn_search_max_points);
+                absoluteMaxDistSqr, b.neighborPts, b.neighborSqrDists,
+                b.neighborIndices, nn_search_max_points);
         }
 
-        for (size_t k = 0; k < neighborIndices_.size(); k++)
+        mrpt::tfest::TMatchingPair* cands =
+            &candidates_[i * MAX_CORRS_PER_LOCAL];
+        size_t nCands = 0;
+
+        for (size_t k = 0;
+             k < b.neighborIndices.size() && nCands < MAX_CORRS_PER_LOCAL; k++)
         {
-            const auto tentativeErrSqr = neighborSqrDists_.at(k);
+            const float errSqr = b.neighborSqrDists[k];
+            if (errSqr > absoluteMaxDistSqr) continue;
+
+            auto& p     = cands[nCands];
+            p.globalIdx = b.neighborIndices[k];
+            p.localIdx  = localIdx;
+            p.global    = b.neighborPts[k];
+            p.local     = {lxs[localIdx], lys[localIdx], lzs[localIdx]};
+            p.errorSquareAfterTransformation = errSqr;
+
+            // keep max of 1st and 2nd closest point errors for the
+            // histogram:
+            if (nCands < 2) range.add(errSqr);
+            nCands++;
+        }
+        candidateCount_[i] = static_cast<uint8_t>(nCands);
+
+        // Check for a potential plane?
+        // minimum: 3 points to be able to fit a plane
+        if (!enableDetectPlanes || nCands < planeMinimumFoundPoints) return;
 
-            if (tentativeErrSqr > absoluteMaxDistSqr) continue;
+        b.xs.clear();
+        b.ys.clear();
+        b.zs.clear();
+        for (size_t k = 0; k < nCands; k++)
+        {
+            b.xs.push_back(cands[k].global.x);
+            b.ys.push_back(cands[k].global.y);
+            b.zs.push_back(cands[k].global.z);
+        }
 
-            if (k <= 1)
-            {
-                // keep max of 1st and 2nd closest point errors for the
-                // histogram:
-                if (maxSqrErrorForHistogram)
-                {
-                    mrpt::keep_max(*maxSqrErrorForHistogram, tentativeErrSqr);
-                    mrpt::keep_min(*minSqrErrorForHistogram, tentativeErrSqr);
-                }
-                else
-                {
-                    maxSqrErrorForHistogram = tentativeErrSqr;
-                    minSqrErrorForHistogram = tentativeErrSqr;
-                }
-            }
+        const PointCloudEigen& eig = mp2p_icp::estimate_points_eigen(
+            b.xs.data(), b.ys.data(), b.zs.data(), std::nullopt, b.xs.size());
 
-            lambdaAddPair(
-                localIdx, neighborPts_.at(k), neighborIndices_.at(k),
-                tentativeErrSqr);
+        // e0/e2 must be < planeEigenThreshold:
+        if (eig.eigVals[0] < planeEigenThreshold * eig.eigVals[2] &&
+            eig.eigVals[0] < planeEigenThreshold * eig.eigVals[1])
+        {
+            auto& lp    = localPlanes_[i];
+            lp.centroid = {
+                eig.meanCov.mean.x(), eig.meanCov.mean.y(),
+                eig.meanCov.mean.z()};
+            lp.plane = mrpt::math::TPlane(lp.centroid, eig.eigVectors[0]);
+            lp.valid =
+                std::abs(lp.plane.distance(cands[0].local)) <
+                planeMinimumDistance;
         }
+    };
+
+#if defined(MP2P_HAS_TBB)
+    const ErrorRange range = tbb::parallel_reduce(
+        tbb::blocked_range<size_t>{0, nLocals}, ErrorRange(),
+        [&](const tbb::blocked_range<size_t>& r, ErrorRange er) -> ErrorRange
+        {
+            Buffers b;
+            for (size_t i = r.begin(); i < r.end(); i++)
+                lambdaProcessLocal(i, b, er);
+            return er;
+        },
+        [](ErrorRange a, const ErrorRange& b) -> ErrorRange
+        {
+            if (b.maxSqr)
+            {
+                a.add(*b.minSqr);
+                a.add(*b.maxSqr);
+            }
+            return a;
+        });
+#else
+    ErrorRange range;
+    {
+        Buffers b;
+        for (size_t i = 0; i < nLocals; i++) lambdaProcessLocal(i, b, range);
+    }
+#endif
 
-    }  // For each local point
+    // No candidate at all?
+    if (!range.maxSqr) return;
 
     // Now, estimate the probability distribution (histogram) of the
     // 1st/2nd points:
-    mrpt::math::CHistogram hist(
-        *minSqrErrorForHistogram, *maxSqrErrorForHistogram, 50);
+    mrpt::math::CHistogram hist(*range.minSqr, *range.maxSqr, HISTOGRAM_BINS);
 
-    for (const auto& mspl : matchesPerLocal_)
-        for (size_t i = 0; i < std::min<size_t>(mspl.size(), 2UL); i++)
-            hist.add(mspl[i].errorSquareAfterTransformation);
+    for (size_t i = 0; i < nLocals; i++)
+    {
+        const auto* cands = &candidates_[i * MAX_CORRS_PER_LOCAL];
+        for (size_t k = 0; k < std::min<size_t>(candidateCount_[i], 2UL); k++)
+            hist.add(cands[k].errorSquareAfterTransformation);
+    }
 
     hist.getHistogramNormalized(histXs_, histValues_);
 
@@ -203,14 +284,9 @@ void Matcher_Adaptive::implMatchOneLayer(
         histXs_, histValues_, ci_low, ci_high, 1.0 - confidenceInterval);
 
 #if 0
-    printf("Histograms:\n");
-    for (auto v : histXs_) printf("%.02f ", v);
-    printf("\n");
-    for (auto v : histValues_) printf("%.02f ", v);
-    printf("\n");
     printf(
         "[MatcherAdaptive] CI_HIGH: %.03f => threshold=%.03f m nCorrs=%zu\n",
-        ci_high, std::sqrt(ci_high), matchesPerLocal_.size());
+        ci_high, std::sqrt(ci_high), nLocals);
 #endif
 
     // Take the confidence interval limit as the definitive maximum squared
@@ -220,65 +296,39 @@ void Matcher_Adaptive::implMatchOneLayer(
 
     const float maxSqr1to2 = mrpt::square(firstToSecondDistanceMax);
 
-    // Now, process candidates pairing and store them in `out.paired_pt2pt`:
-    for (const auto& mspl : matchesPerLocal_)
+    // 2nd pass: process candidates pairing and store them in
+    // `out.paired_pt2pt` and `out.paired_pt2pl`:
+    for (size_t i = 0; i < nLocals; i++)
     {
-        // Check for a potential plane?
-        // minimum: 3 points to be able to fit a plane
-        if (enableDetectPlanes && mspl.size() >= planeMinimumFoundPoints)
-        {
-            kddXs.clear();
-            kddYs.clear();
-            kddZs.clear();
-            for (const auto& p : mspl)
-            {
-                kddXs.push_back(p.global.x);
-                kddYs.push_back(p.global.y);
-                kddZs.push_back(p.global.z);
-            }
+        const size_t nCands = candidateCount_[i];
+        if (nCands == 0) continue;
 
-            const PointCloudEigen& eig = mp2p_icp::estimate_points_eigen(
-                kddXs.data(), kddYs.data(), kddZs.data(), std::nullopt,
-                kddXs.size());
-
-            // e0/e2 must be < planeEigenThreshold:
-            if (eig.eigVals[0] < planeEigenThreshold * eig.eigVals[2] &&
-                eig.eigVals[0] < planeEigenThreshold * eig.eigVals[1])
-            {
-                const auto&                normal        = eig.eigVectors[0];
-                const mrpt::math::TPoint3D planeCentroid = {
-                    eig.meanCov.mean.x(), eig.meanCov.mean.y(),
-                    eig.meanCov.mean.z()};
+        const mrpt::tfest::TMatchingPair* cands =
+            &candidates_[i * MAX_CORRS_PER_LOCAL];
 
-                const auto thePlane = mrpt::math::TPlane(planeCentroid, normal);
-                const double ptPlaneDist =
-                    std::abs(thePlane.distance(mspl.at(0).local));
-
-                if (ptPlaneDist < planeMinimumDistance)
-                {
-                    const auto localIdx = mspl.at(0).localIdx;
-
-                    // OK, all conditions pass: add the new pairing:
-                    auto& p    = out.paired_pt2pl.emplace_back();
-                    p.pt_local = {lxs[localIdx], lys[localIdx], lzs[localIdx]};
-                    p.pl_global.centroid = planeCentroid;
+        if (enableDetectPlanes && localPlanes_[i].valid)
+        {
+            const auto& lp       = localPlanes_[i];
+            const auto  localIdx = cands[0].localIdx;
 
-                    p.pl_global.plane = thePlane;
+            // OK, all conditions pass: add the new pairing:
+            auto& p              = out.paired_pt2pl.emplace_back();
+            p.pt_local           = cands[0].local;
+            p.pl_global.centroid = lp.centroid;
+            p.pl_global.plane    = lp.plane;
 
-                    // Mark local point as already paired:
-                    ms.localPairedBitField.point_layers[localName].mark_as_set(
-                        localIdx);
+            // Mark local point as already paired:
+            ms.localPairedBitField.point_layers[localName].mark_as_set(
+                localIdx);
 
-                    // all good with this local point:
-                    continue;
-                }
-            }
+            // all good with this local point:
+            continue;
         }
 
-        for (size_t i = 0;
-             i < std::min<size_t>(mspl.size(), maxPt2PtCorrespondences); i++)
+        for (size_t k = 0;
+             k < std::min<size_t>(nCands, maxPt2PtCorrespondences); k++)
         {
-            const auto& p         = mspl.at(i);
+            const auto& p         = cands[k];
             const auto  globalIdx = p.globalIdx;
 
             if (!allowMatchAlreadyMatchedGlobalPoints_ &&
@@ -288,9 +338,9 @@ void Matcher_Adaptive::implMatchOneLayer(
             // too large error for the adaptive threshold?
             if (p.errorSquareAfterTransformation >= maxCorrDistSqr) continue;
 
-            if (i != 0 &&
-                mspl[i].errorSquareAfterTransformation >
-                    mspl[0].errorSquareAfterTransformation * maxSqr1to2)
+            if (k != 0 &&
+                p.errorSquareAfterTransformation >
+                    cands[0].errorSquareAfterTransformation * maxSqr1to2)
             {
                 break;
             }
@@ -300,23 +350,11 @@ void Matcher_Adaptive::implMatchOneLayer(
             // Mark local & global points as already paired:
             if (!allowMatchAlreadyMatchedGlobalPoints_)
             {
-                const auto localIdx = p.localIdx;
                 ms.localPairedBitField.point_layers[localName].mark_as_set(
-                    localIdx);
+                    p.localIdx);
             }
         }
     }
 
-    // Update adaptive maximum range:
-    // absoluteMaxSearchDistance = std::sqrt(ci_high) + minimumCorrDist;
-
-// Now, mark global idxs as used. It's done after the loop above
-// to allow multiple local -> global pairs with the same global.
-#if 0
-                // Mark local & global points as already paired:
-            ms.globalPairedBitField.point_layers[globalName].mark_as_set(
-                globalIdx);
-#endif
-
     MRPT_END
 }
@@ -34,8 +34,8 @@ void Matcher_Point2Plane::initialize(const mrpt::containers::yaml& params)
 void Matcher_Point2Plane::implMatchOneLayer(
     const mrpt::maps::CMetricMap& pcGlobalMap,
     const mrpt::maps::CPointsMap& pcLocal,
-    const mrpt::poses::CPose3D& localPose, MatchState& ms,
-    [[maybe_unused]] const layer_name_t& globalName,
+    const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+    MatchState& ms, [[maybe_unused]] const layer_name_t& globalName,
     const layer_name_t& localName, Pairings& out) const
 {
     MRPT_START
@@ -51,7 +51,7 @@ void Matcher_Point2Plane::implMatchOneLayer(
     if (pcGlobalMap.isEmpty() || pcLocal.empty()) return;
 
     const TransformedLocalPointCloud tl = transform_local_to_global(
-        pcLocal, localPose, maxLocalPointsPerLayer_, localPointsSampleSeed_);
+        pcLocal, localPose, maxLocalPoints(mc), localPointsSampleSeed_);
 
     // Try to do matching only if the bounding boxes have some overlap:
     if (!pcGlobalMap.boundingBox().intersection(
@@ -11,19 +11,17 @@
  */
 
 #include <mp2p_icp/Matcher_Points_Base.h>
-#include <mrpt/random/random_shuffle.h>
+#include <mp2p_icp/reproducibility.h>
 
-#include <chrono>
-#include <numeric>  // iota
-#include <random>
+#include <algorithm>  // min
+#include <numeric>    // iota
 
 using namespace mp2p_icp;
 
 bool Matcher_Points_Base::impl_match(
     const metric_map_t& pcGlobal, const metric_map_t& pcLocal,
-    const mrpt::poses::CPose3D&          localPose,
-    [[maybe_unused]] const MatchContext& mc, MatchState& ms,
-    Pairings& out) const
+    const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+    MatchState& ms, Pairings& out) const
 {
     MRPT_START
 
@@ -101,8 +99,8 @@ bool Matcher_Points_Base::impl_match(
 
             // matcher implementation:
             implMatchOneLayer(
-                *glLayer, *lcLayer, localPose, ms, glLayerName, localLayerName,
-                out);
+                *glLayer, *lcLayer, localPose, mc, ms, glLayerName,
+                localLayerName, out);
 
             const size_t nAfter = out.paired_pt2pt.size();
 
@@ -170,6 +168,13 @@ void Matcher_Points_Base::initialize(const mrpt::containers::yaml& params)
         bounding_box_intersection_check_epsilon_);
 }
 
+uint64_t Matcher_Points_Base::maxLocalPoints(const MatchContext& mc) const
+{
+    if (!mc.maxLocalPointsPerLayer.has_value()) return maxLocalPointsPerLayer_;
+    if (maxLocalPointsPerLayer_ == 0) return *mc.maxLocalPointsPerLayer;
+    return std::min(maxLocalPointsPerLayer_, *mc.maxLocalPointsPerLayer);
+}
+
 Matcher_Points_Base::TransformedLocalPointCloud
     Matcher_Points_Base::transform_local_to_global(
         const mrpt::maps::CPointsMap& pcLocal,
@@ -213,18 +218,19 @@ Matcher_Points_Base::TransformedLocalPointCloud
     }
     else
     {
-        // random subset:
-        r.idxs.emplace(maxLocalPoints);
+        // random subset: partial Fisher-Yates shuffle of all indices, with
+        // one counter-based RNG stream per output slot:
+        r.idxs.emplace(nLocalPoints);
         std::iota(r.idxs->begin(), r.idxs->end(), 0);
 
-        const unsigned int seed =
-            localPointsSampleSeed != 0
-                ? localPointsSampleSeed
-                : std::chrono::system_clock::now().time_since_epoch().count();
+        const CounterRNG rng(resolve_random_seed(localPointsSampleSeed));
 
-        mrpt::random::partial_shuffle(
-            r.idxs->begin(), r.idxs->end(), std::default_random_engine(seed),
-            maxLocalPoints);
+        for (size_t ri = 0; ri < maxLocalPoints; ri++)
+        {
+            const size_t j = ri + rng.index(nLocalPoints - ri, ri);
+            std::swap((*r.idxs)[ri], (*r.idxs)[j]);
+        }
+        r.idxs->resize(maxLocalPoints);
 
         r.x_locals.resize(maxLocalPoints);
         r.y_locals.resize(maxLocalPoints);
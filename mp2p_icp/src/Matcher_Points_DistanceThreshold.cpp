@@ -35,26 +35,102 @@ void Matcher_Points_DistanceThreshold::initialize(
 {
     Matcher_Points_Base::initialize(params);
 
-    DECLARE_PARAMETER_REQ(params, threshold);
+    adaptiveThreshold.reset();
+    adaptiveModels_.clear();
+
+    if (params.has("adaptiveThreshold"))
+    {
+        adaptiveThreshold.emplace();
+        adaptiveThreshold->load_from_yaml(params["adaptiveThreshold"]);
+
+        DECLARE_PARAMETER_OPT(params, threshold);
+    }
+    else
+    {
+        DECLARE_PARAMETER_REQ(params, threshold);
+    }
     DECLARE_PARAMETER_REQ(params, thresholdAngularDeg);
     DECLARE_PARAMETER_OPT(params, pairingsPerPoint);
 }
 
+void Matcher_Points_DistanceThreshold::onAlignmentFinished(
+    const mrpt::poses::CPose3D& initialGuess, const Results& result)
+{
+    // Failed or unfinished alignments tell nothing reliable about the motion
+    // model error:
+    const bool failed =
+        result.terminationReason == IterTermReason::NoPairings ||
+        result.terminationReason == IterTermReason::SolverError ||
+        result.terminationReason == IterTermReason::Timeout ||
+        result.terminationReason == IterTermReason::QualityCheckpointFailed;
+
+    for (auto& [layers, am] : adaptiveModels_)
+    {
+        if (am.used && !failed)
+            am.model.update(initialGuess, result.optimal_tf.mean, am.maxRange);
+        am.used = false;
+    }
+}
+
+const AdaptiveThreshold*
+    Matcher_Points_DistanceThreshold::adaptiveThresholdModel(
+        const layer_name_t& globalLayer, const layer_name_t& localLayer) const
+{
+    const auto it = adaptiveModels_.find({globalLayer, localLayer});
+    return it != adaptiveModels_.end() ? &it->second.model : nullptr;
+}
+
 void Matcher_Points_DistanceThreshold::implMatchOneLayer(
     const mrpt::maps::CMetricMap& pcGlobalMap,
     const mrpt::maps::CPointsMap& pcLocal,
-    const mrpt::poses::CPose3D& localPose, MatchState& ms,
-    const layer_name_t& globalName, const layer_name_t& localName,
-    Pairings& out) const
+    const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+    MatchState& ms, const layer_name_t& globalName,
+    const layer_name_t& localName, Pairings& out) const
 {
     MRPT_START
 
     checkAllParametersAreRealized();
 
     ASSERT_(pairingsPerPoint >= 1);
-    ASSERT_GT_(threshold, .0);
     ASSERT_GE_(thresholdAngularDeg, .0);
 
+    double thresholdToUse = threshold;
+
+    if (adaptiveThreshold)
+    {
+        auto& am = adaptiveModels_[{globalName, localName}];
+
+        if (!am.used || mc.icpIteration == 0)
+        {
+            // First time in this alignment: update the maximum range of the
+            // local points, used to convert pose errors into deviations:
+            am.model.params = *adaptiveThreshold;
+            am.used         = true;
+
+            const auto& xs = pcLocal.getPointsBufferRef_x();
+            const auto& ys = pcLocal.getPointsBufferRef_y();
+            const auto& zs = pcLocal.getPointsBufferRef_z();
+
+            float maxNormSqr = 0;
+            for (size_t i = 0; i < xs.size(); i++)
+            {
+                mrpt::keep_max(
+                    maxNormSqr, mrpt::square(xs[i]) + mrpt::square(ys[i]) +
+                                    mrpt::square(zs[i]));
+            }
+            am.maxRange = std::sqrt(maxNormSqr);
+        }
+
+        thresholdToUse =
+            am.model.threshold(mc.lastIcpStepIncrement, am.maxRange);
+
+        MRPT_LOG_DEBUG_FMT(
+            "Adaptive threshold for '%s'<->'%s' at iteration %u: %.03f m",
+            globalName.c_str(), localName.c_str(), mc.icpIteration,
+            thresholdToUse);
+    }
+    ASSERT_GT_(thresholdToUse, .0);
+
     const mrpt::maps::NearestNeighborsCapable& nnGlobal =
         *mp2p_icp::MapToNN(pcGlobalMap, true /*throw if cannot convert*/);
 
@@ -64,12 +140,12 @@ void Matcher_Points_DistanceThreshold::implMatchOneLayer(
     if (pcGlobalMap.isEmpty() || pcLocal.empty()) return;
 
     const TransformedLocalPointCloud tl = transform_local_to_global(
-        pcLocal, localPose, maxLocalPointsPerLayer_, localPointsSampleSeed_);
+        pcLocal, localPose, maxLocalPoints(mc), localPointsSampleSeed_);
 
     // Try to do matching only if the bounding boxes have some overlap:
     if (!pcGlobalMap.boundingBox().intersection(
             {tl.localMin, tl.localMax},
-            threshold + bounding_box_intersection_check_epsilon_))
+            thresholdToUse + bounding_box_intersection_check_epsilon_))
         return;
 
     // Prepare output: no correspondences initially:
@@ -77,7 +153,7 @@ void Matcher_Points_DistanceThreshold::implMatchOneLayer(
 
     // Loop for each point in local map:
     // --------------------------------------------------
-    const float maxDistForCorrespondenceSquared = mrpt::square(threshold);
+    const float maxDistForCorrespondenceSquared = mrpt::square(thresholdToUse);
     const float angularThresholdFactorSquared =
         mrpt::square(mrpt::DEG2RAD(thresholdAngularDeg));
 
@@ -90,18 +166,15 @@ void Matcher_Points_DistanceThreshold::implMatchOneLayer(
     // single-thread call before entering into parallelization:
     nnGlobal.nn_prepare_for_3d_queries();
 
+    // Candidate pairings are collected first (in parallel, if possible), and
+    // the already-paired bit fields are checked and updated afterwards, in
+    // the order of local points, so results do not depend on threads.
     const auto lambdaAddPair =
-        [this, &ms, &globalName, &localName, &lxs, &lys, &lzs](
+        [&lxs, &lys, &lzs](
             mrpt::tfest::TMatchingPairList& outPairs, const size_t localIdx,
             const mrpt::math::TPoint3Df& globalPt, const uint64_t globalIdxOrID,
             const float errSqr)
     {
-        // Filter out if global alread assigned, in another matcher up the
-        // pipeline, for example.
-        if (!allowMatchAlreadyMatchedGlobalPoints_ &&
-            ms.globalPairedBitField.point_layers.at(globalName)[globalIdxOrID])
-            return;  // skip, global point already paired.
-
         // Save new correspondence:
         auto& p = outPairs.emplace_back();
 
@@ -111,15 +184,6 @@ void Matcher_Points_DistanceThreshold::implMatchOneLayer(
         p.local     = {lxs[localIdx], lys[localIdx], lzs[localIdx]};
 
         p.errorSquareAfterTransformation = errSqr;
-
-        // Mark local & global points as already paired:
-        if (!allowMatchAlreadyMatchedGlobalPoints_)
-        {
-            ms.localPairedBitField.point_layers[localName].mark_as_set(
-                localIdx);
-            ms.globalPairedBitField.point_layers[globalName].mark_as_set(
-                globalIdxOrID);
-        }
     };
 
 #if defined(MP2P_HAS_TBB)
@@ -209,13 +273,10 @@ void Matcher_Points_DistanceThreshold::implMatchOneLayer(
                 std::make_move_iterator(b.end()));
             return a;
         });
-
-    out.paired_pt2pt.insert(
-        out.paired_pt2pt.end(), std::make_move_iterator(newPairs.begin()),
-        std::make_move_iterator(newPairs.end()));
 #else
 
-    out.paired_pt2pt.reserve(nLocalPts);
+    mrpt::tfest::TMatchingPairList newPairs;
+    newPairs.reserve(nLocalPts);
 
     std::vector<uint64_t>              neighborIndices;
     std::vector<float>                 neighborSqrDists;
@@ -274,11 +335,32 @@ void Matcher_Points_DistanceThreshold::implMatchOneLayer(
                 break;  // skip this and the rest.
 
             lambdaAddPair(
-                out.paired_pt2pt, localIdx, neighborPts.at(k),
-                neighborIndices.at(k), tentativeErrSqr);
+                newPairs, localIdx, neighborPts.at(k), neighborIndices.at(k),
+                tentativeErrSqr);
         }
     }
 #endif
 
+    // Store pairings:
+    for (const auto& p : newPairs)
+    {
+        // Filter out if global alread assigned, in another matcher up the
+        // pipeline, for example.
+        if (!allowMatchAlreadyMatchedGlobalPoints_ &&
+            ms.globalPairedBitField.point_layers.at(globalName)[p.globalIdx])
+            continue;  // skip, global point already paired.
+
+        out.paired_pt2pt.push_back(p);
+
+        // Mark local & global points as already paired:
+        if (!allowMatchAlreadyMatchedGlobalPoints_)
+        {
+            ms.localPairedBitField.point_layers[localName].mark_as_set(
+                p.localIdx);
+            ms.globalPairedBitField.point_layers[globalName].mark_as_set(
+                p.globalIdx);
+        }
+    }
+
     MRPT_END
 }
@@ -0,0 +1,262 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   Matcher_Points_Projective.cpp
+ * @brief  Pointcloud matcher: projective association via range images
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/Matcher_Points_Projective.h>
+#include <mrpt/core/exceptions.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "range_image_projection.h"
+
+#if defined(MP2P_HAS_TBB)
+#include <tbb/parallel_for.h>
+#endif
+
+IMPLEMENTS_MRPT_OBJECT(Matcher_Points_Projective, Matcher, mp2p_icp)
+
+using namespace mp2p_icp;
+
+namespace
+{
+constexpr uint64_t EMPTY_PIXEL = std::numeric_limits<uint64_t>::max();
+
+// Ranges are positive, so comparing their IEEE754 bits as integers keeps
+// their order, and a pixel can be updated with a single atomic "min":
+uint64_t pixel_key(float range, uint32_t globalIdx)
+{
+    uint32_t rangeBits;
+    std::memcpy(&rangeBits, &range, sizeof(rangeBits));
+    return (static_cast<uint64_t>(rangeBits) << 32) | globalIdx;
+}
+
+void atomic_keep_min(std::atomic<uint64_t>& a, uint64_t v)
+{
+    uint64_t cur = a.load(std::memory_order_relaxed);
+    while (v < cur &&
+           !a.compare_exchange_weak(cur, v, std::memory_order_relaxed))
+    {
+    }
+}
+}  // namespace
+
+Matcher_Points_Projective::Matcher_Points_Projective()
+{
+    mrpt::system::COutputLogger::setLoggerName("Matcher_Points_Projective");
+}
+
+void Matcher_Points_Projective::initialize(const mrpt::containers::yaml& params)
+{
+    Matcher_Points_Base::initialize(params);
+
+    load_range_camera(params, rangeCamera);
+
+    DECLARE_PARAMETER_REQ(params, threshold);
+    MCP_LOAD_OPT(params, searchWindow);
+}
+
+void Matcher_Points_Projective::implMatchOneLayer(
+    const mrpt::maps::CMetricMap& pcGlobalMap,
+    const mrpt::maps::CPointsMap& pcLocal,
+    const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+    MatchState& ms, const layer_name_t& globalName,
+    const layer_name_t& localName, Pairings& out) const
+{
+    MRPT_START
+
+    checkAllParametersAreRealized();
+
+    ASSERT_GT_(threshold, .0);
+    ASSERT_GT_(rangeCamera.ncols, 0U);
+    ASSERT_GT_(rangeCamera.nrows, 0U);
+
+    const auto* pcGlobal = mp2p_icp::MapToPointsMap(pcGlobalMap);
+    ASSERTMSG_(
+        pcGlobal,
+        mrpt::format(
+            "The global layer '%s' must be a point cloud, but it is '%s'",
+            globalName.c_str(), pcGlobalMap.GetRuntimeClass()->className));
+
+    out.potential_pairings += pcLocal.size();
+
+    // Empty maps?  Nothing to do
+    if (pcGlobal->empty() || pcLocal.empty()) return;
+
+    ASSERT_LT_(pcGlobal->size(), std::numeric_limits<uint32_t>::max());
+
+    const TransformedLocalPointCloud tl = transform_local_to_global(
+        pcLocal, localPose, maxLocalPoints(mc), localPointsSampleSeed_);
+
+    // Try to do matching only if the bounding boxes have some overlap:
+    if (!pcGlobalMap.boundingBox().intersection(
+            {tl.localMin, tl.localMax},
+            threshold + bounding_box_intersection_check_epsilon_))
+        return;
+
+    const auto& rc    = rangeCamera;
+    const int   ncols = static_cast<int>(rc.ncols);
+    const int   nrows = static_cast<int>(rc.nrows);
+
+    // Returns false if out of the image:
+    const auto lambdaProject =
+        [&](const mrpt::math::TPoint3D& p, int& px, int& py) -> bool
+    {
+        if (p.x <= 0) return false;  // Behind the camera
+        double fpx, fpy;
+        projectPoint(p, rc, fpx, fpy);
+        // Check on doubles before casting: points with a tiny x project far
+        // out of the int range (this also rejects NaNs):
+        if (!(fpx >= 0 && fpy >= 0 && fpx < ncols && fpy < nrows))
+            return false;
+        px = static_cast<int>(fpx);
+        py = static_cast<int>(fpy);
+        return true;
+    };
+
+    // 1) Range image of the global map, as seen from the local map origin:
+    // --------------------------------------------------------------------
+    const std::size_t nPixels = rc.ncols * rc.nrows;
+    if (rangeImage_.size != nPixels)
+    {
+        rangeImage_.pixels.reset(new std::atomic<uint64_t>[nPixels]);
+        rangeImage_.size = nPixels;
+    }
+    for (std::size_t i = 0; i < nPixels; i++)
+        rangeImage_.pixels[i].store(EMPTY_PIXEL, std::memory_order_relaxed);
+
+    const auto        globalToLocal = -localPose;
+    const auto&       gxs           = pcGlobal->getPointsBufferRef_x();
+    const auto&       gys           = pcGlobal->getPointsBufferRef_y();
+    const auto&       gzs           = pcGlobal->getPointsBufferRef_z();
+    const std::size_t nGlobal       = gxs.size();
+
+    const auto lambdaRenderGlobal = [&](std::size_t i)
+    {
+        const auto p = globalToLocal.composePoint(
+            mrpt::math::TPoint3D(gxs[i], gys[i], gzs[i]));
+
+        int px, py;
+        if (!lambdaProject(p, px, py)) return;
+
+        atomic_keep_min(
+            rangeImage_.pixels[py * ncols + px],
+            pixel_key(static_cast<float>(p.norm()), static_cast<uint32_t>(i)));
+    };
+
+#if defined(MP2P_HAS_TBB)
+    tbb::parallel_for(
+        static_cast<std::size_t>(0), nGlobal,
+        [&](std::size_t i) { lambdaRenderGlobal(i); });
+#else
+    for (std::size_t i = 0; i < nGlobal; i++) lambdaRenderGlobal(i);
+#endif
+
+    // 2) Look up local points in the range image:
+    // --------------------------------------------------------------------
+    const auto& lxs = pcLocal.getPointsBufferRef_x();
+    const auto& lys = pcLocal.getPointsBufferRef_y();
+    const auto& lzs = pcLocal.getPointsBufferRef_z();
+
+    const std::size_t nLocals    = tl.x_locals.size();
+    const float       maxDistSqr = mrpt::square(threshold);
+    const int         win        = static_cast<int>(searchWindow);
+
+    // Best global index for each local point, or EMPTY_PIXEL:
+    std::vector<uint64_t> bestGlobal(nLocals, EMPTY_PIXEL);
+    std::vector<float>    bestErrSqr(nLocals);
+
+    const auto lambdaLookupLocal = [&](std::size_t i)
+    {
+        const size_t localIdx = tl.idxs.has_value() ? (*tl.idxs)[i] : i;
+
+        if (!allowMatchAlreadyMatchedPoints_ &&
+            ms.localPairedBitField.point_layers.at(localName)[localIdx])
+            return;  // skip, already paired.
+
+        int px, py;
+        if (!lambdaProject(
+                {lxs[localIdx], lys[localIdx], lzs[localIdx]}, px, py))
+            return;
+
+        const float lx = tl.x_locals[i], ly = tl.y_locals[i],
+                    lz = tl.z_locals[i];
+
+        float best = maxDistSqr;
+        for (int y = std::max(0, py - win); y <= std::min(nrows - 1, py + win);
+             y++)
+        {
+            for (int x = std::max(0, px - win);
+                 x <= std::min(ncols - 1, px + win); x++)
+            {
+                const uint64_t key = rangeImage_.pixels[y * ncols + x].load(
+                    std::memory_order_relaxed);
+                if (key == EMPTY_PIXEL) continue;
+
+                const auto g = static_cast<uint32_t>(key);
+
+                const float errSqr = mrpt::square(gxs[g] - lx) +
+                                     mrpt::square(gys[g] - ly) +
+                                     mrpt::square(gzs[g] - lz);
+                if (errSqr >= best) continue;
+
+                best          = errSqr;
+                bestGlobal[i] = g;
+                bestErrSqr[i] = errSqr;
+            }
+        }
+    };
+
+#if defined(MP2P_HAS_TBB)
+    tbb::parallel_for(
+        static_cast<std::size_t>(0), nLocals,
+        [&](std::size_t i) { lambdaLookupLocal(i); });
+#else
+    for (std::size_t i = 0; i < nLocals; i++) lambdaLookupLocal(i);
+#endif
+
+    // 3) Store pairings:
+    // --------------------------------------------------------------------
+    out.paired_pt2pt.reserve(out.paired_pt2pt.size() + nLocals);
+
+    for (std::size_t i = 0; i < nLocals; i++)
+    {
+        if (bestGlobal[i] == EMPTY_PIXEL) continue;
+
+        const size_t   localIdx  = tl.idxs.has_value() ? (*tl.idxs)[i] : i;
+        const uint64_t globalIdx = bestGlobal[i];
+
+        // Filter out if global alread assigned, in another matcher up the
+        // pipeline, for example.
+        if (!allowMatchAlreadyMatchedGlobalPoints_ &&
+            ms.globalPairedBitField.point_layers.at(globalName)[globalIdx])
+            continue;  // skip, global point already paired.
+
+        auto& p     = out.paired_pt2pt.emplace_back();
+        p.globalIdx = globalIdx;
+        p.localIdx  = localIdx;
+        p.global    = {gxs[globalIdx], gys[globalIdx], gzs[globalIdx]};
+        p.local     = {lxs[localIdx], lys[localIdx], lzs[localIdx]};
+        p.errorSquareAfterTransformation = bestErrSqr[i];
+
+        // Mark local & global points as already paired:
+        if (!allowMatchAlreadyMatchedGlobalPoints_)
+        {
+            ms.localPairedBitField.point_layers[localName].mark_as_set(
+                localIdx);
+            ms.globalPairedBitField.point_layers[globalName].mark_as_set(
+                globalIdx);
+        }
+    }
+
+    MRPT_END
+}
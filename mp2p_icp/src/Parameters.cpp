@@ -20,7 +20,7 @@ const bool MP2P_ICP_GENERATE_DEBUG_FILES =
     mrpt::get_env<bool>("MP2P_ICP_GENERATE_DEBUG_FILES", false);
 
 // Implementation of the CSerializable virtual interface:
-uint8_t Parameters::serializeGetVersion() const { return 2; }
+uint8_t Parameters::serializeGetVersion() const { return 4; }
 void    Parameters::serializeTo(mrpt::serialization::CArchive& out) const
 {
     out << maxIterations << minAbsStep_trans << minAbsStep_rot;
@@ -28,6 +28,10 @@ void    Parameters::serializeTo(mrpt::serialization::CArchive& out) const
     out << debugPrintIterationProgress;
     out << decimationDebugFiles;
     out << saveIterationDetails << decimationIterationDetails;  // v2
+    out << timeBudget << timeBudgetMinLocalPoints;  // v3
+    out << solverIterationsPerMatching;  // v4
+    out.WriteAs<uint8_t>(irlsKernel);
+    out << irlsKernelParam;
 }
 void Parameters::serializeFrom(
     mrpt::serialization::CArchive& in, uint8_t version)
@@ -39,6 +43,8 @@ void Parameters::serializeFrom(
         case 0:
         case 1:
         case 2:
+        case 3:
+        case 4:
         {
             in >> maxIterations >> minAbsStep_trans >> minAbsStep_rot;
             in >> generateDebugFiles >> debugFileNameFormat;
@@ -46,6 +52,13 @@ void Parameters::serializeFrom(
             if (version >= 1) in >> decimationDebugFiles;
             if (version >= 2)
                 in >> saveIterationDetails >> decimationIterationDetails;
+            if (version >= 3) in >> timeBudget >> timeBudgetMinLocalPoints;
+            if (version >= 4)
+            {
+                in >> solverIterationsPerMatching;
+                irlsKernel = static_cast<RobustKernel>(in.ReadAs<uint8_t>());
+                in >> irlsKernelParam;
+            }
         }
         break;
         default:
@@ -60,6 +73,11 @@ void Parameters::load_from(const mrpt::containers::yaml& p)
     MCP_LOAD_REQ(p, maxIterations);
     MCP_LOAD_OPT(p, minAbsStep_trans);
     MCP_LOAD_OPT(p, minAbsStep_rot);
+    MCP_LOAD_OPT(p, timeBudget);
+    MCP_LOAD_OPT(p, timeBudgetMinLocalPoints);
+    MCP_LOAD_OPT(p, solverIterationsPerMatching);
+    MCP_LOAD_OPT(p, irlsKernel);
+    MCP_LOAD_OPT(p, irlsKernelParam);
     MCP_LOAD_OPT(p, generateDebugFiles);
     MCP_LOAD_OPT(p, debugFileNameFormat);
     MCP_LOAD_OPT(p, debugPrintIterationProgress);
@@ -105,6 +123,12 @@ void Parameters::save_to(mrpt::containers::yaml& p) const
     MCP_SAVE(p, maxIterations);
     MCP_SAVE(p, minAbsStep_trans);
     MCP_SAVE(p, minAbsStep_rot);
+    MCP_SAVE(p, timeBudget);
+    MCP_SAVE(p, timeBudgetMinLocalPoints);
+    MCP_SAVE(p, solverIterationsPerMatching);
+    p["irlsKernel"] =
+        mrpt::typemeta::TEnumType<RobustKernel>::value2name(irlsKernel);
+    MCP_SAVE(p, irlsKernelParam);
     MCP_SAVE(p, generateDebugFiles);
     MCP_SAVE(p, debugFileNameFormat);
     MCP_SAVE(p, debugPrintIterationProgress);
@@ -15,6 +15,8 @@
 #include <mrpt/img/TPixelCoord.h>
 #include <mrpt/io/vector_loadsave.h>
 
+#include "range_image_projection.h"
+
 IMPLEMENTS_MRPT_OBJECT(
     QualityEvaluator_RangeImageSimilarity, QualityEvaluator, mp2p_icp)
 
@@ -23,13 +25,7 @@ using namespace mp2p_icp;
 void QualityEvaluator_RangeImageSimilarity::initialize(
     const mrpt::containers::yaml& params)
 {
-    rangeCamera.ncols = params["ncols"].as<uint32_t>();
-    rangeCamera.nrows = params["nrows"].as<uint32_t>();
-
-    rangeCamera.cx(params["cx"].as<double>());
-    rangeCamera.cy(params["cy"].as<double>());
-    rangeCamera.fx(params["fx"].as<double>());
-    rangeCamera.fy(params["fy"].as<double>());
+    load_range_camera(params, rangeCamera);
 
     MCP_LOAD_OPT(params, sigma);
     MCP_LOAD_OPT(params, penalty_not_visible);
@@ -106,33 +102,6 @@ QualityEvaluator::Result QualityEvaluator_RangeImageSimilarity::evaluate(
     return r;
 }
 
-// Adapted from mrpt::vision::pinhole::projectPoint_with_distortion()
-// 3-claused BSD
-static void projectPoint(
-    const mrpt::math::TPoint3D& P, const mrpt::img::TCamera& params,
-    double& pixel_x, double& pixel_y)
-{
-    /* Pinhole model.
-     *
-     * Point reference            Pixel/camera reference
-     *
-     *     +Z ^                           / +Z
-     *        |  /                       /
-     *        | /  +X                   /
-     *  +Y    |/                       /
-     *  <-----+                       +-----------> +X
-     *                                |
-     *                                |
-     *                                V +Y
-     *
-     */
-    const double x = -P.y / P.x;
-    const double y = -P.z / P.x;
-
-    pixel_x = params.cx() + params.fx() * x;
-    pixel_y = params.cy() + params.fy() * y;
-}
-
 mrpt::math::CMatrixDouble QualityEvaluator_RangeImageSimilarity::projectPoints(
     const mrpt::maps::CPointsMap&              pts,
     const std::optional<mrpt::poses::CPose3D>& relativePose) const
@@ -6,12 +6,13 @@
 
 #include <mp2p_icp/Results.h>
 #include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/string_utils.h>  // unitsFormat()
 
 #include <ostream>
 
 using namespace mp2p_icp;
 
-static const uint8_t SERIALIZATION_VERSION = 0;
+static const uint8_t SERIALIZATION_VERSION = 1;
 
 void Results::serializeTo(mrpt::serialization::CArchive& out) const
 {
@@ -20,17 +21,28 @@ void Results::serializeTo(mrpt::serialization::CArchive& out) const
     out << static_cast<uint8_t>(terminationReason);
     out << quality;
     finalPairings.serializeTo(out);
+    out.WriteAs<uint64_t>(localMapMemory);
+    out.WriteAs<uint64_t>(globalMapMemory);
 }
 void Results::serializeFrom(mrpt::serialization::CArchive& in)
 {
     const auto readVersion = in.ReadAs<uint8_t>();
 
-    ASSERT_EQUAL_(readVersion, SERIALIZATION_VERSION);
+    ASSERT_LE_(readVersion, SERIALIZATION_VERSION);
 
     in >> optimal_tf >> optimalScale >> nIterations;
     terminationReason = static_cast<IterTermReason>(in.ReadAs<uint8_t>());
     in >> quality;
     finalPairings.serializeFrom(in);
+    if (readVersion >= 1)
+    {
+        localMapMemory  = in.ReadAs<uint64_t>();
+        globalMapMemory = in.ReadAs<uint64_t>();
+    }
+    else
+    {
+        localMapMemory = globalMapMemory = 0;
+    }
 }
 
 mrpt::serialization::CArchive& mp2p_icp::operator<<(
@@ -61,5 +73,8 @@ void Results::print(std::ostream& o) const
       << mrpt::typemeta::TEnumType<mp2p_icp::IterTermReason>::value2name(
              terminationReason)
       << "\n"
-      << "- finalPairings: " << finalPairings.contents_summary() << "\n";
+      << "- finalPairings: " << finalPairings.contents_summary() << "\n"
+      << "- mapsMemory: local="
+      << mrpt::system::unitsFormat(localMapMemory) << "B global="
+      << mrpt::system::unitsFormat(globalMapMemory) << "B\n";
 }
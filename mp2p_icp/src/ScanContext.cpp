@@ -0,0 +1,268 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ScanContext.cpp
+ * @brief  Scan Context-like global descriptors for place recognition
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/ScanContext.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/math/wrap2pi.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#if defined(MP2P_HAS_TBB)
+#include <tbb/parallel_for.h>
+#endif
+
+using namespace mp2p_icp;
+
+void ScanContextParameters::load_from_yaml(const mrpt::containers::yaml& c)
+{
+    MCP_LOAD_OPT(c, num_rings);
+    MCP_LOAD_OPT(c, num_sectors);
+    MCP_LOAD_OPT(c, max_radius);
+    MCP_LOAD_OPT(c, z_offset);
+    MCP_LOAD_OPT(c, num_candidates);
+}
+
+ScanContextDescriptor mp2p_icp::scan_context_descriptor(
+    const mrpt::maps::CPointsMap& pc, const ScanContextParameters& p)
+{
+    MRPT_START
+
+    ASSERT_GT_(p.num_rings, 0U);
+    ASSERT_GT_(p.num_sectors, 0U);
+    ASSERT_GT_(p.max_radius, 0.0);
+
+    ScanContextDescriptor d;
+    d.num_rings   = p.num_rings;
+    d.num_sectors = p.num_sectors;
+    d.bins.assign(p.num_rings * p.num_sectors, 0.0f);
+    d.ringKey.assign(p.num_rings, 0.0f);
+
+    const auto& xs = pc.getPointsBufferRef_x();
+    const auto& ys = pc.getPointsBufferRef_y();
+    const auto& zs = pc.getPointsBufferRef_z();
+
+    const float maxR       = static_cast<float>(p.max_radius);
+    const float ringRes    = maxR / static_cast<float>(p.num_rings);
+    const float sectorRes  = static_cast<float>(2 * M_PI / p.num_sectors);
+    const float zOffset    = static_cast<float>(p.z_offset);
+    const auto  lastRing   = static_cast<int>(p.num_rings - 1);
+    const auto  lastSector = static_cast<int>(p.num_sectors - 1);
+
+    for (size_t i = 0; i < xs.size(); i++)
+    {
+        const float r = std::sqrt(xs[i] * xs[i] + ys[i] * ys[i]);
+        if (r >= maxR || r == 0) continue;
+
+        const float h = zs[i] + zOffset;
+        if (h <= 0) continue;
+
+        const float phi = std::atan2(ys[i], xs[i]) + static_cast<float>(M_PI);
+
+        const int ring = std::min(static_cast<int>(r / ringRes), lastRing);
+        const int sector =
+            std::min(static_cast<int>(phi / sectorRes), lastSector);
+
+        float& bin = d.bins[ring * p.num_sectors + sector];
+        if (h > bin) bin = h;
+    }
+
+    for (uint32_t ring = 0; ring < d.num_rings; ring++)
+    {
+        const auto itRow = d.bins.begin() + ring * d.num_sectors;
+        d.ringKey[ring] =
+            std::accumulate(itRow, itRow + d.num_sectors, 0.0f) /
+            static_cast<float>(d.num_sectors);
+    }
+
+    return d;
+    MRPT_END
+}
+
+ScanContextDescriptor mp2p_icp::scan_context_descriptor(
+    const metric_map_t& m, const layer_name_t& pointLayer,
+    const ScanContextParameters& p)
+{
+    MRPT_START
+
+    const auto it = m.layers.find(pointLayer);
+    ASSERTMSG_(
+        it != m.layers.end() && it->second,
+        mrpt::format("Layer '%s' not found.", pointLayer.c_str()));
+
+    const auto* pc = MapToPointsMap(*it->second);
+    ASSERTMSG_(
+        pc, mrpt::format(
+                "Layer '%s' could not be converted into a point cloud "
+                "(class='%s')",
+                pointLayer.c_str(), it->second->GetRuntimeClass()->className));
+
+    auto d  = scan_context_descriptor(*pc, p);
+    d.id    = m.id;
+    d.label = m.label;
+    return d;
+
+    MRPT_END
+}
+
+ScanContextDistance mp2p_icp::scan_context_distance(
+    const ScanContextDescriptor& query, const ScanContextDescriptor& candidate)
+{
+    ASSERT_EQUAL_(query.num_rings, candidate.num_rings);
+    ASSERT_EQUAL_(query.num_sectors, candidate.num_sectors);
+
+    const uint32_t nR = query.num_rings, nS = query.num_sectors;
+
+    // Norm of each sector (column) of both descriptors, to avoid
+    // recomputing them for each shift:
+    const auto lambdaColNorms = [&](const ScanContextDescriptor& d)
+    {
+        std::vector<float> norms(nS, 0.0f);
+        for (uint32_t r = 0; r < nR; r++)
+            for (uint32_t s = 0; s < nS; s++)
+                norms[s] += d.at(r, s) * d.at(r, s);
+        for (auto& n : norms) n = std::sqrt(n);
+        return norms;
+    };
+    const auto qNorms = lambdaColNorms(query);
+    const auto cNorms = lambdaColNorms(candidate);
+
+    ScanContextDistance best;
+
+    for (uint32_t shift = 0; shift < nS; shift++)
+    {
+        double   sumSim     = 0;
+        uint32_t nValidCols = 0;
+
+        for (uint32_t s = 0; s < nS; s++)
+        {
+            const uint32_t sc = (s + shift) % nS;
+            if (qNorms[s] == 0 || cNorms[sc] == 0) continue;
+
+            float dot = 0;
+            for (uint32_t r = 0; r < nR; r++)
+                dot += query.at(r, s) * candidate.at(r, sc);
+
+            sumSim += dot / (qNorms[s] * cNorms[sc]);
+            nValidCols++;
+        }
+        if (nValidCols == 0) continue;
+
+        const double dist = 1.0 - sumSim / nValidCols;
+        if (dist < best.distance)
+        {
+            best.distance = dist;
+            // A point at azimuth "phi" in the query appears at
+            // "phi+shift*res" in the candidate:
+            best.yaw = mrpt::math::wrapToPi(2 * M_PI * shift / nS);
+        }
+    }
+
+    return best;
+}
+
+std::size_t ScanContextDatabase::add(ScanContextDescriptor&& d)
+{
+    ASSERT_EQUAL_(d.num_rings, params.num_rings);
+    ASSERT_EQUAL_(d.num_sectors, params.num_sectors);
+
+    db_.emplace_back(std::move(d));
+    return db_.size() - 1;
+}
+
+std::size_t ScanContextDatabase::add(
+    const metric_map_t& m, const layer_name_t& pointLayer)
+{
+    return add(scan_context_descriptor(m, pointLayer, params));
+}
+
+std::vector<ScanContextDatabase::Match> ScanContextDatabase::query(
+    const ScanContextDescriptor& d, std::size_t topK,
+    std::size_t ignoreLastN) const
+{
+    MRPT_START
+
+    ASSERT_EQUAL_(d.ringKey.size(), params.num_rings);
+
+    std::vector<Match> matches;
+    if (topK == 0 || ignoreLastN >= db_.size()) return matches;
+
+    const std::size_t N = db_.size() - ignoreLastN;
+
+    // 1) Ring keys (rotation invariant) distances, to preselect candidates:
+    std::vector<float> ringKeyDist(N);
+
+#if defined(MP2P_HAS_TBB)
+    tbb::parallel_for(
+        static_cast<std::size_t>(0), N,
+        [&](std::size_t i)
+#else
+    for (std::size_t i = 0; i < N; i++)
+#endif
+        {
+            const auto& rk = db_[i].ringKey;
+            float       d2 = 0;
+            for (std::size_t r = 0; r < rk.size(); r++)
+                d2 += mrpt::square(rk[r] - d.ringKey[r]);
+            ringKeyDist[i] = d2;
+        }
+#if defined(MP2P_HAS_TBB)
+    );
+#endif
+
+    std::vector<std::size_t> candidates(N);
+    std::iota(candidates.begin(), candidates.end(), 0);
+
+    const std::size_t nCandidates = std::min<std::size_t>(
+        N, std::max<std::size_t>(params.num_candidates, topK));
+
+    std::partial_sort(
+        candidates.begin(), candidates.begin() + nCandidates, candidates.end(),
+        [&](std::size_t a, std::size_t b)
+        { return ringKeyDist[a] < ringKeyDist[b]; });
+    candidates.resize(nCandidates);
+
+    // 2) Full descriptor distance to the candidates:
+    matches.resize(nCandidates);
+
+#if defined(MP2P_HAS_TBB)
+    tbb::parallel_for(
+        static_cast<std::size_t>(0), nCandidates,
+        [&](std::size_t i)
+#else
+    for (std::size_t i = 0; i < nCandidates; i++)
+#endif
+        {
+            const auto& e = db_[candidates[i]];
+
+            auto& m    = matches[i];
+            m.index    = candidates[i];
+            m.id       = e.id;
+            m.label    = e.label;
+            m.distance = scan_context_distance(d, e);
+        }
+#if defined(MP2P_HAS_TBB)
+    );
+#endif
+
+    std::sort(
+        matches.begin(), matches.end(),
+        [](const Match& a, const Match& b)
+        { return a.distance.distance < b.distance.distance; });
+
+    if (matches.size() > topK) matches.resize(topK);
+
+    return matches;
+    MRPT_END
+}
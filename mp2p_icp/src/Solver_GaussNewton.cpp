@@ -34,7 +34,7 @@ void Solver_GaussNewton::initialize(const mrpt::containers::yaml& params)
 
 bool Solver_GaussNewton::impl_optimal_pose(
     const Pairings& pairings, OptimalTF_Result& out,
-    [[maybe_unused]] const SolverContext& sc) const
+    const SolverContext& sc) const
 {
     MRPT_START
 
@@ -47,6 +47,7 @@ bool Solver_GaussNewton::impl_optimal_pose(
     gnParams.pairWeights            = pairWeights;
     gnParams.kernel                 = robustKernel;
     gnParams.kernelParam            = robustKernelParam;
+    gnParams.kernelOnPointPairings  = !sc.pointWeightsAreRobust;
     gnParams.prior                  = sc.prior;
 
     ASSERT_(sc.guessRelativePose.has_value());
@@ -16,6 +16,7 @@
 #include <mrpt/poses/Lie/SE.h>
 
 #include <Eigen/Dense>
+#include <algorithm>
 #include <iostream>
 
 #if defined(MP2P_HAS_TBB)
@@ -44,6 +45,10 @@ bool mp2p_icp::optimal_tf_gauss_newton(
     const robust_sqrt_weight_func_t robustSqrtWeightFunc =
         mp2p_icp::create_robust_kernel(gnParams.kernel, gnParams.kernelParam);
 
+    // Point-to-point weights may already include a robust kernel (IRLS):
+    const robust_sqrt_weight_func_t robustSqrtWeightFuncPt2Pt =
+        gnParams.kernelOnPointPairings ? robustSqrtWeightFunc : nullptr;
+
     const auto nPt2Pt = in.paired_pt2pt.size();
     const auto nPt2Ln = in.paired_pt2ln.size();
     const auto nPt2Pl = in.paired_pt2pl.size();
@@ -55,11 +60,38 @@ bool mp2p_icp::optimal_tf_gauss_newton(
     Eigen::Matrix<double, 6, 1> g = Eigen::Matrix<double, 6, 1>::Zero();
     Eigen::Matrix<double, 6, 6> H = Eigen::Matrix<double, 6, 6>::Zero();
 
-    auto w = gnParams.pairWeights;
+    const auto& w = gnParams.pairWeights;
+
+    // Per-point weights are given for blocks of consecutive pairings.
+    // The block of the first point of each range is found by binary search
+    // on the block end indices, then blocks are advanced sequentially, so the
+    // cost is linear even with one block per pairing (IRLS weights):
+    std::vector<std::size_t> point_block_ends;
+    point_block_ends.reserve(in.point_weights.size());
+    for (const auto& [blockLength, blockWeight] : in.point_weights)
+        point_block_ends.push_back(
+            (point_block_ends.empty() ? 0 : point_block_ends.back()) +
+            blockLength);
+
+    const auto lambdaFirstBlock = [&](std::size_t idx_pt) -> std::size_t
+    {
+        return std::upper_bound(
+                   point_block_ends.begin(), point_block_ends.end(), idx_pt) -
+               point_block_ends.begin();
+    };
+
+    // "block" must be the block of idx_pt-1, or lambdaFirstBlock(idx_pt):
+    const auto lambdaPointWeight = [&](std::size_t  idx_pt,
+                                       std::size_t& block) -> double
+    {
+        if (point_block_ends.empty()) return w.pt2pt;
 
-    const bool  has_per_pt_weight       = !in.point_weights.empty();
-    auto        cur_point_block_weights = in.point_weights.begin();
-    std::size_t cur_point_block_start   = 0;
+        while (block < point_block_ends.size() &&
+               idx_pt >= point_block_ends[block])
+            block++;
+        ASSERT_LT_(block, point_block_ends.size());
+        return in.point_weights[block].second;
+    };
 
     for (size_t iter = 0; iter < gnParams.maxInnerLoopIterations; iter++)
     {
@@ -84,22 +116,29 @@ bool mp2p_icp::optimal_tf_gauss_newton(
             {
                 H += other.H;
                 g += other.g;
+                errNormSqr += other.errNormSqr;
                 return *this;
             }
 
             Eigen::Matrix<double, 6, 6> H;
             Eigen::Matrix<double, 6, 1> g;
+            double                      errNormSqr = 0;
         };
 
-        const auto& [H_tbb_pt2pt, g_tbb_pt2pt] = tbb::parallel_reduce(
+        // Deterministic reductions: ranges are split into fixed-size chunks,
+        // reduced in the same order regardless of the number of threads.
+        constexpr size_t REDUCE_GRAIN_SIZE = 512;
+
+        const Result pt2pt = tbb::parallel_deterministic_reduce(
             // Range
-            tbb::blocked_range<size_t>{0, nPt2Pt},
+            tbb::blocked_range<size_t>{0, nPt2Pt, REDUCE_GRAIN_SIZE},
             // Identity
             Result(),
             // 1st lambda: Parallel computation
             [&](const tbb::blocked_range<size_t>& r, Result res) -> Result
             {
-                auto& [H_local, g_local] = res;
+                auto& [H_local, g_local, errLocal] = res;
+                size_t block = lambdaFirstBlock(r.begin());
                 for (size_t idx_pt = r.begin(); idx_pt < r.end(); idx_pt++)
                 {
                     // Error:
@@ -108,30 +147,15 @@ bool mp2p_icp::optimal_tf_gauss_newton(
                     mrpt::math::CVectorFixedDouble<3>       ret =
                         mp2p_icp::error_point2point(p, result.optimalPose, J1);
 
-                    // Get point weight:
-                    if (has_per_pt_weight)
-                    {
-                        if (idx_pt >= cur_point_block_start +
-                                          cur_point_block_weights->first)
-                        {
-                            ASSERT_(
-                                cur_point_block_weights !=
-                                in.point_weights.end());
-                            ++cur_point_block_weights;  // move to next block
-                            cur_point_block_start = idx_pt;
-                        }
-                        w.pt2pt = cur_point_block_weights->second;
-                    }
-
                     // Apply robust kernel?
-                    double weight     = w.pt2pt,
+                    double weight     = lambdaPointWeight(idx_pt, block),
                            retSqrNorm = ret.asEigen().squaredNorm();
-                    if (robustSqrtWeightFunc)
-                        weight *= robustSqrtWeightFunc(retSqrNorm);
+                    if (robustSqrtWeightFuncPt2Pt)
+                        weight *= robustSqrtWeightFuncPt2Pt(retSqrNorm);
 
                     // Error and Jacobian:
                     const Eigen::Vector3d err_i = ret.asEigen();
-                    errNormSqr += weight * retSqrNorm;
+                    errLocal += weight * retSqrNorm;
 
                     const Eigen::Matrix<double, 3, 6> Ji =
                         J1.asEigen() * dDexpe_de.asEigen();
@@ -143,10 +167,12 @@ bool mp2p_icp::optimal_tf_gauss_newton(
             // 2nd lambda: Parallel reduction
             [](Result a, const Result& b) -> Result { return a + b; });
 
-        H = std::move(H_tbb_pt2pt);
-        g = std::move(g_tbb_pt2pt);
+        H = pt2pt.H;
+        g = pt2pt.g;
+        errNormSqr += pt2pt.errNormSqr;
 #else
         // Point-to-point:
+        size_t block = 0;
         for (size_t idx_pt = 0; idx_pt < nPt2Pt; idx_pt++)
         {
             // Error:
@@ -155,23 +181,11 @@ bool mp2p_icp::optimal_tf_gauss_newton(
             mrpt::math::CVectorFixedDouble<3>       ret =
                 mp2p_icp::error_point2point(p, result.optimalPose, J1);
 
-            // Get point weight:
-            if (has_per_pt_weight)
-            {
-                if (idx_pt >=
-                    cur_point_block_start + cur_point_block_weights->first)
-                {
-                    ASSERT_(cur_point_block_weights != in.point_weights.end());
-                    ++cur_point_block_weights;  // move to next block
-                    cur_point_block_start = idx_pt;
-                }
-                w.pt2pt = cur_point_block_weights->second;
-            }
-
             // Apply robust kernel?
-            double weight = w.pt2pt, retSqrNorm = ret.asEigen().squaredNorm();
-            if (robustSqrtWeightFunc)
-                weight *= robustSqrtWeightFunc(retSqrNorm);
+            double weight     = lambdaPointWeight(idx_pt, block),
+                   retSqrNorm = ret.asEigen().squaredNorm();
+            if (robustSqrtWeightFuncPt2Pt)
+                weight *= robustSqrtWeightFuncPt2Pt(retSqrNorm);
 
             // Error and Jacobian:
             const Eigen::Vector3d err_i = ret.asEigen();
@@ -234,15 +248,15 @@ bool mp2p_icp::optimal_tf_gauss_newton(
 
 #if defined(MP2P_HAS_TBB)
         // Point-to-plane:
-        const auto& [H_tbb_pt2pl, g_tbb_pt2pl] = tbb::parallel_reduce(
+        const Result pt2pl = tbb::parallel_deterministic_reduce(
             // Range
-            tbb::blocked_range<size_t>{0, nPt2Pl},
+            tbb::blocked_range<size_t>{0, nPt2Pl, REDUCE_GRAIN_SIZE},
             // Identity
             Result(),
             // 1st lambda: Parallel computation
             [&](const tbb::blocked_range<size_t>& r, Result res) -> Result
             {
-                auto& [H_local, g_local] = res;
+                auto& [H_local, g_local, errLocal] = res;
                 for (size_t idx_pl = r.begin(); idx_pl < r.end(); idx_pl++)
                 {
                     // Error:
@@ -259,7 +273,7 @@ bool mp2p_icp::optimal_tf_gauss_newton(
 
                     // Error and Jacobian:
                     const Eigen::Vector3d err_i = ret.asEigen();
-                    errNormSqr += weight * retSqrNorm;
+                    errLocal += weight * retSqrNorm;
 
                     const Eigen::Matrix<double, 3, 6> Ji =
                         J1.asEigen() * dDexpe_de.asEigen();
@@ -271,8 +285,9 @@ bool mp2p_icp::optimal_tf_gauss_newton(
             // 2nd lambda: Parallel reduction
             [](Result a, const Result& b) -> Result { return a + b; });
 
-        H += H_tbb_pt2pl;
-        g += g_tbb_pt2pl;
+        H += pt2pl.H;
+        g += pt2pl.g;
+        errNormSqr += pt2pl.errNormSqr;
 #else
         // Point-to-plane:
         for (size_t idx_pl = 0; idx_pl < nPt2Pl; idx_pl++)
@@ -0,0 +1,63 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   range_image_projection.h
+ * @brief  Projection of points into range images with a pinhole model
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mrpt/containers/yaml.h>
+#include <mrpt/img/TCamera.h>
+#include <mrpt/math/TPoint3D.h>
+
+#include <cstdint>
+
+namespace mp2p_icp
+{
+/** Loads the `ncols`, `nrows`, `cx`, `cy`, `fx`, `fy` parameters of a
+ * simulated range camera from a YAML block. */
+inline void load_range_camera(
+    const mrpt::containers::yaml& params, mrpt::img::TCamera& rc)
+{
+    rc.ncols = params["ncols"].as<uint32_t>();
+    rc.nrows = params["nrows"].as<uint32_t>();
+
+    rc.cx(params["cx"].as<double>());
+    rc.cy(params["cy"].as<double>());
+    rc.fx(params["fx"].as<double>());
+    rc.fy(params["fy"].as<double>());
+}
+
+// Adapted from mrpt::vision::pinhole::projectPoint_with_distortion()
+// 3-claused BSD
+inline void projectPoint(
+    const mrpt::math::TPoint3D& P, const mrpt::img::TCamera& params,
+    double& pixel_x, double& pixel_y)
+{
+    /* Pinhole model.
+     *
+     * Point reference            Pixel/camera reference
+     *
+     *     +Z ^                           / +Z
+     *        |  /                       /
+     *        | /  +X                   /
+     *  +Y    |/                       /
+     *  <-----+                       +-----------> +X
+     *                                |
+     *                                |
+     *                                V +Y
+     *
+     */
+    const double x = -P.y / P.x;
+    const double y = -P.z / P.x;
+
+    pixel_x = params.cx() + params.fx() * x;
+    pixel_y = params.cy() + params.fy() * y;
+}
+
+}  // namespace mp2p_icp
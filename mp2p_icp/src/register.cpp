@@ -18,6 +18,7 @@
 #include <mp2p_icp/Matcher_Point2Plane.h>
 #include <mp2p_icp/Matcher_Points_DistanceThreshold.h>
 #include <mp2p_icp/Matcher_Points_InlierRatio.h>
+#include <mp2p_icp/Matcher_Points_Projective.h>
 #include <mp2p_icp/Parameters.h>
 #include <mp2p_icp/QualityEvaluator_PairedRatio.h>
 #include <mp2p_icp/QualityEvaluator_RangeImageSimilarity.h>
@@ -47,6 +48,7 @@ MRPT_INITIALIZER(register_mp2p_icp)
     registerClass(CLASS_ID(mp2p_icp::Matcher));
     registerClass(CLASS_ID(mp2p_icp::Matcher_Points_DistanceThreshold));
     registerClass(CLASS_ID(mp2p_icp::Matcher_Points_InlierRatio));
+    registerClass(CLASS_ID(mp2p_icp::Matcher_Points_Projective));
     registerClass(CLASS_ID(mp2p_icp::Matcher_Point2Line));
     registerClass(CLASS_ID(mp2p_icp::Matcher_Point2Plane));
     registerClass(CLASS_ID(mp2p_icp::Matcher_Adaptive));
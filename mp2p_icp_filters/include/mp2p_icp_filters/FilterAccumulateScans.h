@@ -0,0 +1,108 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   FilterAccumulateScans.h
+ * @brief  Accumulates the last N scans into a voxel-decimated local cloud
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#pragma once
+
+#include <mp2p_icp/metricmap.h>
+#include <mp2p_icp_filters/FilterBase.h>
+#include <mrpt/core/pimpl.h>
+#include <mrpt/math/TPose3D.h>
+
+namespace mp2p_icp_filters
+{
+/** Keeps a sliding window with the last `window_length` scans and writes
+ * their voxel-decimated union into an output layer, expressed in the current
+ * vehicle frame.
+ *
+ * Each call to filter() takes the input layer (in the vehicle frame, e.g.
+ * after FilterDeskew) and the current vehicle pose `robot_pose` in an
+ * odometry or map frame. The scan is decimated into voxels of that frame,
+ * and each voxel keeps the sum and count of the points of all scans in the
+ * window. When a scan leaves the window, its per-voxel sums are subtracted,
+ * so inserting and evicting scans cost O(scan voxels), no matter how many
+ * scans have been processed before.
+ *
+ * The output layer holds one point per occupied voxel (the mean of its
+ * points), transformed into the current vehicle frame. Its former contents
+ * are replaced.
+ *
+ * This filter has an internal state. Use independent instances for each
+ * sensor or thread, and reset() to clear the window.
+ *
+ * \ingroup mp2p_icp_filters_grp
+ */
+class FilterAccumulateScans : public mp2p_icp_filters::FilterBase
+{
+    DEFINE_MRPT_OBJECT(FilterAccumulateScans, mp2p_icp_filters)
+   public:
+    FilterAccumulateScans();
+
+    // clang-format off
+    /** Parameters:
+     *
+     * \code
+     * params:
+     *   input_pointcloud_layer: 'deskewed'
+     *   output_pointcloud_layer: 'accumulated'
+     *   window_length: 10
+     *   voxel_filter_resolution: 0.20
+     *   # These are variable names that must be defined via the
+     *   # mp2p_icp::Parameterizable API to update them dynamically:
+     *   robot_pose: [robot_x, robot_y, robot_z, robot_yaw, robot_pitch, robot_roll]
+     * \endcode
+     */
+    // clang-format on
+    void initialize(const mrpt::containers::yaml& c) override;
+
+    // See docs in FilterBase
+    void filter(mp2p_icp::metric_map_t& inOut) const override;
+
+    /** Removes all scans from the window */
+    void reset();
+
+    /** Number of scans currently in the window */
+    std::size_t scanCount() const;
+
+    struct Parameters
+    {
+        void load_from_yaml(
+            const mrpt::containers::yaml& c, FilterAccumulateScans& parent);
+
+        /** Input points, in the vehicle frame */
+        std::string input_pointcloud_layer =
+            mp2p_icp::metric_map_t::PT_LAYER_RAW;
+
+        std::string output_pointcloud_layer;
+
+        /** The class name for the output layer, if it does not exist */
+        std::string output_layer_class = "mrpt::maps::CSimplePointsMap";
+
+        /** Maximum number of scans in the window */
+        uint32_t window_length = 10;
+
+        double voxel_filter_resolution = .20;  // [m]
+
+        /** Current vehicle pose in the odometry or map frame. */
+        mrpt::math::TPose3D robot_pose;
+    };
+
+    /** Algorithm parameters */
+    Parameters params_;
+
+   private:
+    struct Impl;
+    mutable mrpt::pimpl<Impl> impl_;
+};
+
+/** @} */
+
+}  // namespace mp2p_icp_filters
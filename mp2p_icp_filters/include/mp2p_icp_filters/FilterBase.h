@@ -74,7 +74,10 @@ class FilterBase : public mrpt::rtti::CObject,  // RTTI support
 /** A sequence of filters */
 using FilterPipeline = std::vector<FilterBase::Ptr>;
 
-/** Applies a pipeline of filters to a given metric_map_t  */
+/** Applies a pipeline of filters to a given metric_map_t.
+ * If a profiler is given, each filter is timed, and its heap allocations
+ * counted (see mp2p_icp::ProfilerEntry).
+ */
 void apply_filter_pipeline(
     const FilterPipeline& filters, mp2p_icp::metric_map_t& inOut,
     const mrpt::optional_ref<mrpt::system::CTimeLogger>& profiler =
@@ -100,6 +103,57 @@ void apply_filter_pipeline(
     const std::string&                  filename,
     const mrpt::system::VerbosityLevel& vLevel = mrpt::system::LVL_INFO);
 
+/// Options for apply_filter_pipeline_tiled()
+struct tiled_pipeline_options_t
+{
+    /** Length of the side of the square XY tiles [m] */
+    double tile_size = 100.0;
+
+    /** Points within this distance [m] of a tile borders are also passed to
+     * the filters of that tile, so neighborhood-based filters see the same
+     * neighbors than in non-tiled mode. It must be at least the largest
+     * neighborhood radius of the filters, and smaller than tile_size. */
+    double halo = 5.0;
+
+    /** Number of tiles processed (in parallel) at once. Only the point
+     * clouds of one batch of tiles are held in memory at a time, besides the
+     * input and output maps themselves and the tile index of each point. */
+    size_t tiles_per_batch = 32;
+
+    mrpt::system::VerbosityLevel verbosity = mrpt::system::LVL_INFO;
+};
+
+/** Applies a pipeline of filters to a potentially huge metric_map_t, by
+ *  splitting all its point cloud layers into square XY tiles, filtering each
+ *  tile (plus a halo margin) independently, in parallel if built with TBB,
+ *  and stitching back the output points that fall within each tile core.
+ *
+ *  Only valid for spatially local filters, i.e. those whose output at a
+ *  given point only depends on the input points around it (voxel
+ *  decimation, bounding boxes, ranges, edges and planes, poles, etc.).
+ *  For voxel decimation filters, use a `tile_size` multiple of the voxel
+ *  size, so voxels do not cross tile borders.
+ *
+ *  Since filters may hold internal state, a new pipeline is created from
+ *  `pipelineFilters` (the `filters` YAML sequence) for each tile.
+ *  Point indices are assigned to tiles in one pass over the input map, then
+ *  tiles are processed in batches of `tiles_per_batch`, so the extra memory
+ *  for tile point clouds is proportional to the batch size, not to the
+ *  whole map. The whole input map must still fit in memory.
+ *
+ *  Non point cloud layers are shared by all tiles as read-only inputs, and
+ *  kept as they are in the output map. Pipelines writing into such layers
+ *  (e.g. FilterMerge into a voxel map) must not be run in tiled mode;
+ *  replacing them throws. All other output layers of the pipeline must be
+ *  point clouds. Each point cloud layer may have up to 2^32-1 points. If the
+ *  input map has no points at all, the pipeline is just applied once to the
+ *  whole map.
+ */
+void apply_filter_pipeline_tiled(
+    const mrpt::containers::yaml& pipelineFilters,
+    mp2p_icp::metric_map_t&         inOut,
+    const tiled_pipeline_options_t& options = {});
+
 /** @} */
 
 }  // namespace mp2p_icp_filters
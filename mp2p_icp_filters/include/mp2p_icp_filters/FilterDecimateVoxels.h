@@ -107,6 +107,12 @@ class FilterDecimateVoxels : public mp2p_icp_filters::FilterBase
         /** The method to pick what point will be used as representative of each
          * voxel */
         DecimateMethod decimate_method = DecimateMethod::FirstPoint;
+
+        /** Seed for DecimateMethod::RandomPoint. The point picked in each
+         * voxel only depends on the seed and the voxel coordinates. `0`
+         * (default) means to use a time-based seed, or a fixed one if
+         * mp2p_icp::reproducible_mode() is enabled. */
+        uint64_t random_seed = 0;
     };
 
     /** Algorithm parameters */
@@ -79,6 +79,12 @@ class FilterDecimateVoxelsQuadratic : public mp2p_icp_filters::FilterBase
         /** If false (default), the first point in each voxel will be returned
          * as voxel representative. Otherwise, one picked at random. */
         bool use_random_point_within_voxel = false;
+
+        /** Seed for `use_random_point_within_voxel`. The point picked in
+         * each voxel only depends on the seed and the voxel coordinates. `0`
+         * (default) means to use a time-based seed, or a fixed one if
+         * mp2p_icp::reproducible_mode() is enabled. */
+        uint64_t random_seed = 0;
     };
 
     /** Algorithm parameters */
@@ -86,25 +92,15 @@ class FilterDecimateVoxelsQuadratic : public mp2p_icp_filters::FilterBase
 
     inline float real2grid(float x) const
     {
-        if (std::abs(x) > params_.quadratic_reference_radius)
-            return x;
-        else
-            return mrpt::sign(x) * mrpt::square(x) *
-                   quadratic_reference_radius_inv_;
+        return filter_grid_.keyPolicy().mapping.real2grid(x);
     }
     inline float grid2real(float y) const
     {
-        if (std::abs(y) > params_.quadratic_reference_radius)
-            return y;
-        else
-            return std::sqrt(y * params_.quadratic_reference_radius) *
-                   mrpt::sign(y);
+        return filter_grid_.keyPolicy().mapping.grid2real(y);
     }
 
    private:
-    mutable PointCloudToVoxelGrid filter_grid_;
-
-    float quadratic_reference_radius_inv_ = 1.0f;
+    mutable PointCloudToVoxelGridQuadratic filter_grid_;
 };
 
 /** @} */
@@ -22,9 +22,12 @@ namespace mp2p_icp_filters
 /** Takes an input point cloud or mrpt::maps::CVoxelMap layer and inserts it
  * into another one of arbitrary metric map type.
  *
- * Insertion is done by converting the input layer into an
+ * If the target layer is a point cloud, input points are directly appended to
+ * it, keeping all point attributes (intensity, ring, timestamp,...).
+ * Otherwise, insertion is done by converting the input layer into an
  * mrpt::obs::CObservationPointCloud, then invoking the target layer's
- * mrpt::maps::CMetricMap::insertObservation()
+ * mrpt::maps::CMetricMap::insertObservation(), so maps that need the sensor
+ * origin (e.g. for ray tracing) get it.
  *
  * If the input was a mrpt::maps::CVoxelMap, it is first converted into
  * a point cloud by generating points for each occupied voxel using
@@ -39,6 +42,26 @@ namespace mp2p_icp_filters
  *   frame, output is in another global frame, in which the vehicle is at pose
  *   `robot_pose`.
  *
+ * If the target layer is an mrpt::maps::CVoxelMap and
+ * `parallel_voxel_insertion` is `true`, rays from `robot_pose` to each point
+ * are traced in parallel into thread-local sparse buffers of per-voxel
+ * free/occupied counts, which are then merged and applied to the map sorted by
+ * voxel blocks, instead of using the single-threaded
+ * mrpt::maps::CMetricMap::insertObservation(). All the free and occupied
+ * observations of a voxel are applied in one single update, with the same
+ * log-odds arithmetic and clamping than mrpt::maps::CVoxelMap::updateVoxel().
+ * Optionally, with `reduce_duplicate_rays`, each voxel gets at most one
+ * observation per insertion (occupied if any point falls into it, free
+ * otherwise).
+ *
+ * The parallel path honors the target map `insertionOptions` `max_range`,
+ * `ray_trace_free_space`, `decimation` and the log-odds parameters. With
+ * other options (`remove_voxels_farther_than`), the serial path is used.
+ * Note that, since all free observations of a voxel are applied before its
+ * occupied ones, voxels observed as both free and occupied in one insertion
+ * may end with a different value than with the serial (interleaved) updates
+ * if they reach a clamping limit in between.
+ *
  * \ingroup mp2p_icp_filters_grp
  */
 class FilterMerge : public mp2p_icp_filters::FilterBase
@@ -72,6 +95,14 @@ class FilterMerge : public mp2p_icp_filters::FilterBase
          */
         // clang-format on
         mrpt::math::TPose3D robot_pose;
+
+        /** For mrpt::maps::CVoxelMap target layers: trace rays in parallel.
+         * See discussion above for FilterMerge */
+        bool parallel_voxel_insertion = false;
+
+        /** For parallel_voxel_insertion: update each voxel only once per
+         * insertion, no matter how many rays cross or end in it. */
+        bool reduce_duplicate_rays = false;
     };
 
     /** Algorithm parameters */
@@ -0,0 +1,116 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   FilterRemoveDynamicPoints.h
+ * @brief  Online removal of dynamic objects while building a point map
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#pragma once
+
+#include <mp2p_icp/metricmap.h>
+#include <mp2p_icp_filters/FilterBase.h>
+#include <mrpt/core/pimpl.h>
+#include <mrpt/math/TPose3D.h>
+
+namespace mp2p_icp_filters
+{
+/** Appends an input point cloud to a target point cloud layer (the map being
+ * built), removing points of dynamic objects as scans arrive.
+ *
+ * This filter keeps, for each voxel of size `voxel_size`, how many scans
+ * had a point in it ("hits") and how many scans had a ray from the sensor
+ * (at `robot_pose`) crossing it ("misses"). Rays are traced in parallel (if
+ * TBB is available), and each voxel is updated at most once per scan.
+ *
+ * A voxel with at least `minimum_observations` (hits+misses) and a ratio
+ * misses/(hits+misses) larger than `dynamic_threshold` is considered
+ * dynamic:
+ * - New points in dynamic voxels are not inserted into the target layer.
+ * - When a voxel becomes dynamic, its former points are removed from the
+ *   target layer. The indices of the target layer points in each voxel are
+ *   kept, so this costs time proportional to the removed points, not to the
+ *   map size. Removed points are replaced by the last ones of the layer, so
+ *   the order of points in the target layer is not preserved.
+ *
+ * Removed points are moved into `output_layer_dynamic_objects`, if defined.
+ *
+ * This is a streaming alternative to building a mrpt::maps::CVoxelMap of the
+ * whole map, then running FilterRemoveByVoxelOccupancy as a final filter.
+ * See `demos/sm2mm_pointcloud_remove_dynamic.yaml`.
+ *
+ * This filter has an internal state, so the same instance must be used for
+ * all scans of one map, from one thread. Use reset() to start a new map.
+ * Other filters must not modify the target layer; if its number of points
+ * changes out of this filter, all its points are indexed again.
+ *
+ * \ingroup mp2p_icp_filters_grp
+ */
+class FilterRemoveDynamicPoints : public mp2p_icp_filters::FilterBase
+{
+    DEFINE_MRPT_OBJECT(FilterRemoveDynamicPoints, mp2p_icp_filters)
+   public:
+    FilterRemoveDynamicPoints();
+
+    // See docs in base class.
+    void initialize(const mrpt::containers::yaml& c) override;
+
+    // See docs in FilterBase
+    void filter(mp2p_icp::metric_map_t& inOut) const override;
+
+    /** Clears all voxel hit/miss statistics */
+    void reset();
+
+    struct Parameters
+    {
+        void load_from_yaml(
+            const mrpt::containers::yaml& c,
+            FilterRemoveDynamicPoints&    parent);
+
+        std::string input_pointcloud_layer;
+
+        /** The point cloud layer with the map being built. It is created, of
+         * the same class than the input layer, if it does not exist. */
+        std::string target_layer;
+
+        /** If defined, removed points are appended to this layer. */
+        std::string output_layer_dynamic_objects;
+
+        /** See FilterMerge::Parameters::input_layer_in_local_coordinates */
+        bool input_layer_in_local_coordinates = false;
+
+        // clang-format off
+        /** Sensor pose in the map frame. In the context of a sm2mm pipeline,
+         * this should be set to the expression:
+         * \code
+         * robot_pose: [robot_x, robot_y, robot_z, robot_yaw, robot_pitch, robot_roll]
+         * \endcode
+         */
+        // clang-format on
+        mrpt::math::TPose3D robot_pose;
+
+        double voxel_size = 0.25;  // [m]
+
+        /** Rays longer than this are not traced (0=no limit) */
+        double max_range = 0;  // [m]
+
+        uint32_t minimum_observations = 3;
+
+        double dynamic_threshold = 0.5;
+    };
+
+    /** Algorithm parameters */
+    Parameters params_;
+
+   private:
+    struct Impl;
+    mutable mrpt::pimpl<Impl> impl_;
+};
+
+/** @} */
+
+}  // namespace mp2p_icp_filters
@@ -0,0 +1,84 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   FilterVoxelPyramid.h
+ * @brief  Builds a multi-resolution pyramid of decimated point layers
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#pragma once
+
+#include <mp2p_icp/metricmap.h>
+#include <mp2p_icp_filters/FilterBase.h>
+#include <mp2p_icp_filters/FilterDecimateVoxels.h>  // DecimateMethod
+
+namespace mp2p_icp_filters
+{
+/** Builds a multi-resolution pyramid of voxel-decimated versions of one input
+ * point cloud layer in one single pass, for coarse-to-fine ICP pipelines.
+ *
+ * The voxel indices of all points are computed only once, for the finest
+ * level (`voxel_filter_resolution`). Each coarser level has voxels
+ * `2^level_shift` times larger than the previous one, and it is derived from
+ * the voxels of the previous level by shifting their integer indices and
+ * merging them, instead of processing the input points again.
+ *
+ * Output layers are named `<output_layer_prefix><resolution>`, e.g. with the
+ * default prefix, `voxel_filter_resolution: 0.1`, `num_levels: 3` and
+ * `level_shift: 2`: `decim_0.1`, `decim_0.4` and `decim_1.6`.
+ * If an output layer already exists, new points will be appended.
+ *
+ * Supported `decimate_method`s are `DecimateMethod::FirstPoint` (the first
+ * input point of each voxel, keeping all its fields) and
+ * `DecimateMethod::VoxelAverage`.
+ *
+ * \ingroup mp2p_icp_filters_grp
+ */
+class FilterVoxelPyramid : public mp2p_icp_filters::FilterBase
+{
+    DEFINE_MRPT_OBJECT(FilterVoxelPyramid, mp2p_icp_filters)
+   public:
+    FilterVoxelPyramid();
+
+    // See docs in base class.
+    void initialize(const mrpt::containers::yaml& c) override;
+
+    // See docs in FilterBase
+    void filter(mp2p_icp::metric_map_t& inOut) const override;
+
+    struct Parameters
+    {
+        void load_from_yaml(
+            const mrpt::containers::yaml& c, FilterVoxelPyramid& parent);
+
+        std::string input_pointcloud_layer =
+            mp2p_icp::metric_map_t::PT_LAYER_RAW;
+
+        std::string output_layer_prefix = "decim_";
+
+        /** Size of each voxel edge in the finest level [meters] */
+        double voxel_filter_resolution = 0.1;  // [m]
+
+        /** Number of levels of the pyramid */
+        uint32_t num_levels = 3;
+
+        /** Each level has voxels 2^level_shift larger than the previous one */
+        uint32_t level_shift = 2;
+
+        DecimateMethod decimate_method = DecimateMethod::FirstPoint;
+    };
+
+    /** Algorithm parameters */
+    Parameters params_;
+
+    /** Returns the output layer name for the given level (0=finest). */
+    std::string output_layer_name(uint32_t level) const;
+};
+
+/** @} */
+
+}  // namespace mp2p_icp_filters
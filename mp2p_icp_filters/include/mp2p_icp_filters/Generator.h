@@ -21,7 +21,10 @@
 #include <mrpt/system/COutputLogger.h>
 
 #include <regex>
+#include <shared_mutex>
 #include <stdexcept>
+#include <string>
+#include <unordered_map>
 
 namespace mp2p_icp_filters
 {
@@ -62,7 +65,10 @@ struct NotImplementedError : public std::runtime_error
  * exception NotImplementedError will be thrown if an non-implemented method is
  * called.
  *
- * \note process() is not required to be thread (multientry) safe.
+ * \note process() is not required to be thread (multientry) safe in general.
+ * apply_generators_per_sensor(), which calls process() of each generator
+ * from several threads, requires isReentrant() to return true. The
+ * implementation in this base class is reentrant.
  *
  * A set of generators can be loaded from a YAML file and applied together using
  * mp2p_icp_filters::apply_generators().
@@ -96,6 +102,23 @@ class Generator : public mrpt::rtti::CObject,  // RTTI support
         const std::optional<mrpt::poses::CPose3D>& robotPose =
             std::nullopt) const;
 
+    /** Returns true if the observation class name and sensor label match
+     * `process_class_names_regex` and `process_sensor_labels_regex`.
+     * Decisions are cached per (class, sensor label) pair, so the regular
+     * expressions are only evaluated the first time each pair is seen.
+     * The cache is guarded by a mutex, and only read once a pair is known.
+     */
+    bool observationPassesFilters(const mrpt::obs::CObservation& o) const;
+
+    /** Returns true if process() can be safely called concurrently from
+     *  several threads for different observations, as long as each thread
+     *  uses a different output metric_map_t. This holds for all generators in
+     *  this library, since they keep no mutable state other than the
+     *  (guarded) observationPassesFilters() cache. Derived classes keeping
+     *  mutable state in process() must override it to return false.
+     */
+    virtual bool isReentrant() const { return true; }
+
     struct Parameters
     {
         void load_from_yaml(const mrpt::containers::yaml& c, Generator& parent);
@@ -181,6 +204,27 @@ class Generator : public mrpt::rtti::CObject,  // RTTI support
     std::regex process_sensor_labels_regex_;
 
    private:
+    /** Cache for observationPassesFilters(), reset in initialize().
+     *  Copies of a Generator start with an empty cache. */
+    struct FilterDecisionCache
+    {
+        FilterDecisionCache() = default;
+        FilterDecisionCache(const FilterDecisionCache&) {}
+        FilterDecisionCache& operator=(const FilterDecisionCache&)
+        {
+            std::unique_lock lck(mtx);
+            decisions.clear();
+            return *this;
+        }
+
+        std::unordered_map<
+            const mrpt::rtti::TRuntimeClassId*,
+            std::unordered_map<std::string, bool>>
+                          decisions;
+        std::shared_mutex mtx;
+    };
+    mutable FilterDecisionCache filterDecisionCache_;
+
     bool implProcessDefault(
         const mrpt::obs::CObservation& o, mp2p_icp::metric_map_t& out,
         const std::optional<mrpt::poses::CPose3D>& robotPose =
@@ -229,6 +273,26 @@ bool apply_generators(
     const GeneratorSet& generators, const mrpt::obs::CSensoryFrame& sf,
     const std::optional<mrpt::poses::CPose3D>& robotPose = std::nullopt);
 
+/** Per-sensor parallel version of apply_generators() for a CSensoryFrame with
+ *  several sensors (e.g. multiple LiDARs): each observation is processed by
+ *  all generators into its own thread-local metric_map_t, in parallel, then
+ *  all point cloud layers are merged into `output` in the order of the
+ *  observations in the SF, with one single memory reservation per layer.
+ *
+ *  Requirements: all generators must be reentrant (Generator::isReentrant())
+ *  and create point cloud layers only. Both are checked, falling back to
+ *  the serial apply_generators() for non-reentrant generators, generators
+ *  with a custom `metric_map_definition`, single-observation SFs, or builds
+ *  without TBB. Lazy-load observations are loaded before going multithread.
+ *
+ * \return true if any of the generators actually processed any of the
+ *          observations in the SF.
+ */
+bool apply_generators_per_sensor(
+    const GeneratorSet& generators, const mrpt::obs::CSensoryFrame& sf,
+    mp2p_icp::metric_map_t&                    output,
+    const std::optional<mrpt::poses::CPose3D>& robotPose = std::nullopt);
+
 /** Creates a set of generators from a YAML configuration block (a sequence).
  *  Returns an empty generators set for an empty or null yaml node.
  *  Refer to YAML file examples.
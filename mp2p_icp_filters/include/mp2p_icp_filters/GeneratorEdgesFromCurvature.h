@@ -21,6 +21,9 @@ namespace mp2p_icp_filters
 
 /** Generator of edge points from organized point clouds
  *
+ * process() is reentrant (see Generator::isReentrant()): it only reads the
+ * observation and the parameters, so it may be used from
+ * apply_generators_per_sensor().
  */
 class GeneratorEdgesFromCurvature : public mp2p_icp_filters::Generator
 {
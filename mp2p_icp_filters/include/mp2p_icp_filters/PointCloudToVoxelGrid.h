@@ -12,9 +12,11 @@
 
 #pragma once
 
+#include <mp2p_icp_filters/voxel_keys.h>
 #include <mrpt/core/pimpl.h>
 #include <mrpt/maps/CPointsMap.h>
 
+#include <functional>
 #include <vector>
 
 /** \ingroup mp2p_icp_filters_grp */
@@ -22,17 +24,32 @@ namespace mp2p_icp_filters
 {
 /** Auxiliary data structure: an index of points in a point cloud, organized by
  *  their 3D position according to a predefined regular-sized voxel grid.
+ *
+ * The mapping from coordinates to voxels is defined at compile time by the
+ * `KeyPolicy` (see voxel_keys.h): voxels are stored by their packed 64-bit
+ * keys. Explicitly instantiated for LinearVoxelKeys (PointCloudToVoxelGrid)
+ * and QuadraticVoxelKeys (PointCloudToVoxelGridQuadratic).
+ *
  * \ingroup mp2p_icp_filters_grp
  */
-class PointCloudToVoxelGrid
+template <class KeyPolicy>
+class PointCloudToVoxelGridT
 {
    public:
-    PointCloudToVoxelGrid();
-    ~PointCloudToVoxelGrid() {}
+    using key_policy_t = KeyPolicy;
+
+    PointCloudToVoxelGridT();
+    ~PointCloudToVoxelGridT() {}
 
     /** Changes the voxel resolution, clearing past contents */
     void setResolution(const float voxel_size);
 
+    /** Changes the key policy (e.g. non-linear mapping parameters), clearing
+     * past contents */
+    void setKeyPolicy(const KeyPolicy& kp);
+
+    const KeyPolicy& keyPolicy() const { return key_policy_; }
+
     void processPointCloud(const mrpt::maps::CPointsMap& p);
 
     /** Remove all points and internal data.
@@ -59,56 +76,12 @@ class PointCloudToVoxelGrid
         std::vector<std::size_t> indices;
     };
 
-    struct indices_t
-    {
-        indices_t(int32_t cx, int32_t cy, int32_t cz)
-            : cx_(cx), cy_(cy), cz_(cz)
-        {
-        }
-
-        int32_t cx_ = 0, cy_ = 0, cz_ = 0;
-
-        bool operator==(const indices_t& o) const
-        {
-            return cx_ == o.cx_ && cy_ == o.cy_ && cz_ == o.cz_;
-        }
-    };
-
-    /** This implements the optimized hash from this paper:
-     *
-     *  Teschner, M., Heidelberger, B., Müller, M., Pomerantes, D., & Gross, M.
-     * H. (2003, November). Optimized spatial hashing for collision detection of
-     * deformable objects. In Vmv (Vol. 3, pp. 47-54).
-     *
-     */
-    struct IndicesHash
-    {
-        /// Hash operator for unordered maps:
-        std::size_t operator()(const indices_t& k) const noexcept
-        {
-            // These are the implicit assumptions of the reinterpret cast below:
-            static_assert(sizeof(indices_t::cx_) == sizeof(uint32_t));
-            static_assert(offsetof(indices_t, cx_) == 0 * sizeof(uint32_t));
-            static_assert(offsetof(indices_t, cy_) == 1 * sizeof(uint32_t));
-            static_assert(offsetof(indices_t, cz_) == 2 * sizeof(uint32_t));
-
-            const uint32_t* vec = reinterpret_cast<const uint32_t*>(&k);
-            return ((1 << 20) - 1) &
-                   (vec[0] * 73856093 ^ vec[1] * 19349663 ^ vec[2] * 83492791);
-        }
-
-        // k1 < k2?
-        bool operator()(const indices_t& k1, const indices_t& k2) const noexcept
-        {
-            if (k1.cx_ != k2.cx_) return k1.cx_ < k2.cx_;
-            if (k1.cy_ != k2.cy_) return k1.cy_ < k2.cy_;
-            return k1.cz_ < k2.cz_;
-        }
-    };
+    using indices_t   = VoxelIndices;
+    using IndicesHash = voxel_keys::IndicesHash;
 
     inline int32_t coord2idx(float xyz) const
     {
-        return static_cast<int32_t>(xyz / resolution_);
+        return key_policy_.coord2idx(xyz);
     }
 
     void visit_voxels(
@@ -119,8 +92,7 @@ class PointCloudToVoxelGrid
     size_t size() const;
 
    private:
-    /** Voxel size (meters) or resolution. */
-    float resolution_ = 0.20f;
+    KeyPolicy key_policy_;
 
     /** The actual hash map. Hidden inside a PIMP to prevent problems with
      * duplicated TSL library copies in the user space */
@@ -128,4 +100,14 @@ class PointCloudToVoxelGrid
     mrpt::pimpl<Impl> impl_;
 };
 
+/** Voxel grid index with regular voxels. */
+using PointCloudToVoxelGrid = PointCloudToVoxelGridT<LinearVoxelKeys>;
+
+/** Voxel grid index with voxels wider near the origin. */
+using PointCloudToVoxelGridQuadratic =
+    PointCloudToVoxelGridT<QuadraticVoxelKeys>;
+
+extern template class PointCloudToVoxelGridT<LinearVoxelKeys>;
+extern template class PointCloudToVoxelGridT<QuadraticVoxelKeys>;
+
 }  // namespace mp2p_icp_filters
@@ -12,16 +12,27 @@
 
 #pragma once
 
+#include <mp2p_icp_filters/voxel_keys.h>
 #include <mrpt/core/pimpl.h>
 #include <mrpt/maps/CPointsMap.h>
 
+#include <functional>
 #include <optional>
 
 /** \ingroup mp2p_icp_filters_grp */
 namespace mp2p_icp_filters
 {
 /** Like PointCloudToVoxelGrid, but hardcoded to only store one single point per
- * voxel.
+ * voxel: the first one, in the order of processPointCloud() calls and point
+ * indices.
+ *
+ * Voxels are stored in a flat open-addressing hash table with 16 bytes per
+ * voxel (packed key, point index and count), filled in parallel if TBB is
+ * available. The table grows with the number of voxels, and keeps its memory
+ * across clear() calls to be reused by the next cloud. At most 2^32-1 points
+ * can be processed between clear() calls.
+ * visit_voxels() visits voxels in the order of their first points, so the
+ * results do not depend on thread scheduling.
  *
  * \ingroup mp2p_icp_filters_grp
  */
@@ -40,7 +51,7 @@ class PointCloudToVoxelGridSingle
      */
     void clear();
 
-    /** The list of point indices in each voxel */
+    /** Contents of each voxel, as passed to visit_voxels() */
     struct voxel_t
     {
         std::optional<mrpt::math::TPoint3Df> point;
@@ -51,56 +62,12 @@ class PointCloudToVoxelGridSingle
         uint32_t pointCount = 0;
     };
 
-    struct indices_t
-    {
-        indices_t(int32_t cx, int32_t cy, int32_t cz)
-            : cx_(cx), cy_(cy), cz_(cz)
-        {
-        }
-
-        int32_t cx_ = 0, cy_ = 0, cz_ = 0;
-
-        bool operator==(const indices_t& o) const
-        {
-            return cx_ == o.cx_ && cy_ == o.cy_ && cz_ == o.cz_;
-        }
-    };
-
-    /** This implements the optimized hash from this paper:
-     *
-     *  Teschner, M., Heidelberger, B., Müller, M., Pomerantes, D., & Gross, M.
-     * H. (2003, November). Optimized spatial hashing for collision detection of
-     * deformable objects. In Vmv (Vol. 3, pp. 47-54).
-     *
-     */
-    struct IndicesHash
-    {
-        /// Hash operator for unordered maps:
-        std::size_t operator()(const indices_t& k) const noexcept
-        {
-            // These are the implicit assumptions of the reinterpret cast below:
-            static_assert(sizeof(indices_t::cx_) == sizeof(uint32_t));
-            static_assert(offsetof(indices_t, cx_) == 0 * sizeof(uint32_t));
-            static_assert(offsetof(indices_t, cy_) == 1 * sizeof(uint32_t));
-            static_assert(offsetof(indices_t, cz_) == 2 * sizeof(uint32_t));
-
-            const uint32_t* vec = reinterpret_cast<const uint32_t*>(&k);
-            return ((1 << 20) - 1) &
-                   (vec[0] * 73856093 ^ vec[1] * 19349663 ^ vec[2] * 83492791);
-        }
-
-        // k1 < k2?
-        bool operator()(const indices_t& k1, const indices_t& k2) const noexcept
-        {
-            if (k1.cx_ != k2.cx_) return k1.cx_ < k2.cx_;
-            if (k1.cy_ != k2.cy_) return k1.cy_ < k2.cy_;
-            return k1.cz_ < k2.cz_;
-        }
-    };
+    using indices_t   = VoxelIndices;
+    using IndicesHash = voxel_keys::IndicesHash;
 
     inline int32_t coord2idx(float xyz) const
     {
-        return static_cast<int32_t>(xyz / resolution_);
+        return key_policy_.coord2idx(xyz);
     }
 
     void visit_voxels(
@@ -111,11 +78,9 @@ class PointCloudToVoxelGridSingle
     size_t size() const;
 
    private:
-    /** Voxel size (meters) or resolution. */
-    float resolution_ = 0.20f;
+    LinearVoxelKeys key_policy_;
 
-    /** The actual hash map. Hidden inside a PIMP to prevent problems with
-     * duplicated TSL library copies in the user space */
+    /** The actual hash table */
     struct Impl;
     mrpt::pimpl<Impl> impl_;
 };
@@ -0,0 +1,114 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   estimate_voxel_overlap.h
+ * @brief  Fast overlap estimation between two metric maps using voxels
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#pragma once
+
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mp2p_icp_filters
+{
+/** \addtogroup mp2p_icp_filters_grp
+ *  @{ */
+
+struct VoxelOverlapParameters
+{
+    /** Voxel size [m]. Coarse voxels (e.g. 0.5-2.0 m) are recommended. */
+    float voxel_size = 1.0f;
+
+    /** Point layers to use from both maps. If empty, all layers that can be
+     * converted into a point cloud (see mp2p_icp::MapToPointsMap()) will be
+     * used. */
+    std::vector<std::string> layers;
+
+    /** If >1, only one out of N points of each layer will be used. */
+    uint32_t decimation = 1;
+};
+
+struct VoxelOverlapResult
+{
+    std::size_t globalVoxels = 0;  //!< Occupied voxels in the global map
+    std::size_t localVoxels  = 0;  //!< Occupied voxels in the local map
+    std::size_t commonVoxels = 0;  //!< Voxels occupied in both maps
+
+    /** Ratio of local map voxels also occupied in the global map [0,1] */
+    double overlap = 0;
+
+    /** Jaccard similarity (intersection over union) of occupied voxels [0,1]
+     */
+    double jaccard = 0;
+};
+
+/** The set of voxels occupied by a (global) metric map, built once so the
+ * overlap of many local maps or candidate poses against it can be estimated
+ * with estimate_voxel_overlap() without voxelizing the global map again.
+ *
+ * Occupied voxels are stored as a sorted list of unique packed keys
+ * (LinearVoxelKeys), so each query costs O(L log G) for L local and G global
+ * occupied voxels.
+ */
+class VoxelOverlapIndex
+{
+   public:
+    VoxelOverlapIndex() = default;
+
+    /** Builds the index from the points of `global`. The same parameters
+     * (voxel size, layers, decimation) are used later for local maps. */
+    VoxelOverlapIndex(
+        const mp2p_icp::metric_map_t& global,
+        const VoxelOverlapParameters& params = {});
+
+    const VoxelOverlapParameters& parameters() const { return params_; }
+
+    /** Number of occupied voxels */
+    std::size_t size() const { return keys_.size(); }
+
+    /** Whether the voxel with the given packed key is occupied */
+    bool contains(uint64_t key) const;
+
+   private:
+    VoxelOverlapParameters params_;
+    std::vector<uint64_t>  keys_;  //!< Sorted, unique
+};
+
+/** Estimates the overlap between two metric maps, with the local map placed
+ * at `localPose` with respect to the global one, by comparing the sets of
+ * voxels occupied by their points. Voxel keys are computed as in
+ * PointCloudToVoxelGrid (see LinearVoxelKeys), in parallel if TBB is
+ * available.
+ *
+ * This is orders of magnitude cheaper than running ICP matchers or quality
+ * evaluators, so it can be used to prune candidate pairs in batch
+ * registration or loop closure before calling ICP::align().
+ *
+ * This version voxelizes the global map on each call: to evaluate several
+ * candidates against the same global map, build a VoxelOverlapIndex once and
+ * use the overload below.
+ */
+VoxelOverlapResult estimate_voxel_overlap(
+    const mp2p_icp::metric_map_t& global, const mp2p_icp::metric_map_t& local,
+    const mrpt::poses::CPose3D&   localPose,
+    const VoxelOverlapParameters& params = {});
+
+/** Like the overload above, but using a prebuilt index of the global map,
+ * whose parameters are used for the local map too. */
+VoxelOverlapResult estimate_voxel_overlap(
+    const VoxelOverlapIndex& global, const mp2p_icp::metric_map_t& local,
+    const mrpt::poses::CPose3D& localPose);
+
+/** @} */
+
+}  // namespace mp2p_icp_filters
@@ -17,6 +17,9 @@
 #include <mrpt/maps/CSimpleMap.h>
 #include <mrpt/system/COutputLogger.h>
 
+#include <cstdint>
+#include <map>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,6 +29,38 @@ namespace mp2p_icp_filters
 /** \addtogroup mp2p_icp_filters_grp
  *  @{ */
 
+/** Spatial partition ("shard") of a simplemap for simplemap_to_metricmap():
+ *  keyframes are assigned to square tiles of the XY plane by their robot
+ *  pose, so each tile can be built into its own metric map by an independent
+ *  process, then all of them stitched together with `mm-merge`.
+ */
+struct sm2mm_shard_t
+{
+    /** Length of the side of each square tile [m] */
+    double tile_size = 100.0;
+
+    /** Integer tile coordinates: tile (i,j) covers
+     * `x ∈ [i*tile_size, (i+1)*tile_size)`, and likewise for `y` and `j`. */
+    int32_t tile_x = 0, tile_y = 0;
+
+    /** Keyframes within this distance [m] of the tile borders are also
+     * included, so shards overlap and maps have no gaps at their borders. */
+    double margin = 0;
+
+    /** Returns true if a keyframe at (x,y) belongs to this shard */
+    bool contains(double x, double y) const;
+
+    /** Returns the tile (i,j) for a given point */
+    static std::pair<int32_t, int32_t> tile_of(
+        double x, double y, double tileSize);
+};
+
+/** Returns all the non-empty shard tiles of a simplemap, with the number of
+ *  keyframes in each one, for a given tile size [m].
+ */
+std::map<std::pair<int32_t, int32_t>, size_t> simplemap_shard_tiles(
+    const mrpt::maps::CSimpleMap& sm, double tileSize);
+
 /// Options for simplemap_to_metricmap()
 struct sm2mm_options_t
 {
@@ -37,6 +72,24 @@ struct sm2mm_options_t
     std::vector<std::pair<std::string, double>> customVariables = {};
     std::optional<size_t>                       start_index;
     std::optional<size_t>                       end_index;
+
+    /** If set, only keyframes belonging to this shard are processed. */
+    std::optional<sm2mm_shard_t> shard;
+
+    /** If true, the observations of each keyframe are processed by the
+     * generators in parallel with apply_generators_per_sensor(), then the
+     * filter pipeline runs once for all of them, instead of once per
+     * observation. Useful for keyframes with several LiDARs. */
+    bool parallel_sensors = false;
+};
+
+/** Optional output statistics of simplemap_to_metricmap() */
+struct sm2mm_stats_t
+{
+    /** Peak of metric_map_t::memory_footprint() of the output map while
+     * building it [bytes], and the keyframe index at which it happened. */
+    size_t peakMemory         = 0;
+    size_t peakMemoryKeyframe = 0;
 };
 
 /** Utility function to build metric maps ("*.mm") from raw observations
@@ -47,11 +100,14 @@ struct sm2mm_options_t
  *
  * The former constents of outMap are cleared.
  *
+ * \param outStats If provided, the peak memory usage of the map being built
+ *        will be tracked and stored here.
  */
 void simplemap_to_metricmap(
-    const mrpt::maps::CSimpleMap& sm, mp2p_icp::metric_map_t& outMap,
-    const mrpt::containers::yaml& pipeline,
-    const sm2mm_options_t&        options = {});
+    const mrpt::maps::CSimpleMap&            sm, mp2p_icp::metric_map_t& outMap,
+    const mrpt::containers::yaml&            pipeline,
+    const sm2mm_options_t&                   options  = {},
+    const mrpt::optional_ref<sm2mm_stats_t>& outStats = std::nullopt);
 
 /** @} */
 
@@ -0,0 +1,305 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   voxel_keys.h
+ * @brief  Compile-time policies to compute voxel indices and packed keys
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace mp2p_icp_filters
+{
+/** \addtogroup mp2p_icp_filters_grp
+ *  @{ */
+
+/** Integer (x,y,z) indices of a voxel. */
+struct VoxelIndices
+{
+    VoxelIndices() = default;
+    VoxelIndices(int32_t cx, int32_t cy, int32_t cz) : cx_(cx), cy_(cy), cz_(cz)
+    {
+    }
+
+    int32_t cx_ = 0, cy_ = 0, cz_ = 0;
+
+    bool operator==(const VoxelIndices& o) const
+    {
+        return cx_ == o.cx_ && cy_ == o.cy_ && cz_ == o.cz_;
+    }
+    bool operator!=(const VoxelIndices& o) const { return !(*this == o); }
+};
+
+namespace voxel_keys
+{
+/** Number of bits per axis in packed 64-bit keys. Indices in the range
+ *  [INDEX_MIN, INDEX_MAX] (e.g. +/-52 km for 5 cm voxels) are packed
+ *  exactly, without collisions. See FAR_KEY_BIT for the rest. */
+constexpr int32_t INDEX_BITS = 21;
+constexpr int32_t INDEX_MIN  = -(1 << (INDEX_BITS - 1));
+constexpr int32_t INDEX_MAX  = (1 << (INDEX_BITS - 1)) - 1;
+
+/** Voxels with any index out of [INDEX_MIN, INDEX_MAX], e.g. in georeferenced
+ *  maps, get keys with this bit set and a 62-bit hash of their full indices
+ *  in the lower bits. These keys cannot be unpacked, and two such voxels may
+ *  share a key with a negligible probability (2^-62 per pair). */
+constexpr uint64_t FAR_KEY_BIT = uint64_t(1) << 63;
+
+/** Whether a packed key is a hash of indices out of the exact range, i.e.
+ * it cannot be unpacked. */
+inline bool is_far_key(uint64_t key) { return (key & FAR_KEY_BIT) != 0; }
+
+/** The bit mixer of splitmix64 (Stafford's "Mix13"), so packed keys of
+ * neighboring voxels spread over all the bits of the hash value. */
+inline uint64_t mix_bits(uint64_t k)
+{
+    k = (k ^ (k >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    k = (k ^ (k >> 27)) * 0x94d049bb133111ebULL;
+    return k ^ (k >> 31);
+}
+
+namespace detail
+{
+constexpr uint64_t INDEX_MASK = (uint64_t(1) << INDEX_BITS) - 1;
+
+inline bool in_range(const VoxelIndices& idx)
+{
+    return idx.cx_ >= INDEX_MIN && idx.cx_ <= INDEX_MAX &&
+           idx.cy_ >= INDEX_MIN && idx.cy_ <= INDEX_MAX &&
+           idx.cz_ >= INDEX_MIN && idx.cz_ <= INDEX_MAX;
+}
+
+// Bit 62 is always zero, so far keys never equal ~0 (used as "empty" slot
+// marker by PointCloudToVoxelGridSingle):
+inline uint64_t far_key(const VoxelIndices& idx)
+{
+    const uint64_t xy = static_cast<uint64_t>(static_cast<uint32_t>(idx.cx_)) |
+                        (static_cast<uint64_t>(static_cast<uint32_t>(idx.cy_))
+                         << 32);
+    const uint64_t h =
+        mix_bits(mix_bits(xy) ^ static_cast<uint32_t>(idx.cz_));
+    return FAR_KEY_BIT | (h >> 2);
+}
+
+inline uint64_t to_unsigned(int32_t i)
+{
+    return static_cast<uint64_t>(static_cast<int64_t>(i) - INDEX_MIN) &
+           INDEX_MASK;
+}
+inline int32_t to_signed(uint64_t u)
+{
+    return static_cast<int32_t>(static_cast<int64_t>(u & INDEX_MASK) +
+                                INDEX_MIN);
+}
+
+// Spreads the lower 21 bits of "v" so there are two zero bits between each
+// of them:
+inline uint64_t spread3(uint64_t v)
+{
+    v &= INDEX_MASK;
+    v = (v | (v << 32)) & 0x001f00000000ffffULL;
+    v = (v | (v << 16)) & 0x001f0000ff0000ffULL;
+    v = (v | (v << 8)) & 0x100f00f00f00f00fULL;
+    v = (v | (v << 4)) & 0x10c30c30c30c30c3ULL;
+    v = (v | (v << 2)) & 0x1249249249249249ULL;
+    return v;
+}
+// Inverse of spread3():
+inline uint64_t compact3(uint64_t v)
+{
+    v &= 0x1249249249249249ULL;
+    v = (v ^ (v >> 2)) & 0x10c30c30c30c30c3ULL;
+    v = (v ^ (v >> 4)) & 0x100f00f00f00f00fULL;
+    v = (v ^ (v >> 8)) & 0x001f0000ff0000ffULL;
+    v = (v ^ (v >> 16)) & 0x001f00000000ffffULL;
+    v = (v ^ (v >> 32)) & INDEX_MASK;
+    return v;
+}
+}  // namespace detail
+
+/** Packing: x, y, z in consecutive 21-bit fields of a 64-bit key.
+ * unpack() is only valid for keys without FAR_KEY_BIT. */
+struct PlainPacking
+{
+    static uint64_t pack(const VoxelIndices& idx)
+    {
+        if (!detail::in_range(idx)) return detail::far_key(idx);
+        return detail::to_unsigned(idx.cx_) |
+               (detail::to_unsigned(idx.cy_) << INDEX_BITS) |
+               (detail::to_unsigned(idx.cz_) << (2 * INDEX_BITS));
+    }
+    static VoxelIndices unpack(uint64_t key)
+    {
+        return {
+            detail::to_signed(key), detail::to_signed(key >> INDEX_BITS),
+            detail::to_signed(key >> (2 * INDEX_BITS))};
+    }
+};
+
+/** Packing: interleaved bits of x, y, z (Morton or Z-order), so sorting keys
+ * keeps nearby voxels close in memory. unpack() is only valid for keys
+ * without FAR_KEY_BIT. */
+struct MortonPacking
+{
+    static uint64_t pack(const VoxelIndices& idx)
+    {
+        if (!detail::in_range(idx)) return detail::far_key(idx);
+        return detail::spread3(detail::to_unsigned(idx.cx_)) |
+               (detail::spread3(detail::to_unsigned(idx.cy_)) << 1) |
+               (detail::spread3(detail::to_unsigned(idx.cz_)) << 2);
+    }
+    static VoxelIndices unpack(uint64_t key)
+    {
+        return {
+            detail::to_signed(detail::compact3(key)),
+            detail::to_signed(detail::compact3(key >> 1)),
+            detail::to_signed(detail::compact3(key >> 2))};
+    }
+};
+
+/** Coordinate mapping: regular voxels of size `resolution`. */
+struct LinearMapping
+{
+    LinearMapping() = default;
+    explicit LinearMapping(float resolution) { setResolution(resolution); }
+
+    void setResolution(float resolution)
+    {
+        resolution_     = resolution;
+        inv_resolution_ = 1.0f / resolution;
+    }
+    float resolution() const { return resolution_; }
+
+    /** Voxel index of a coordinate. Note that it rounds towards -infinity, so
+     * voxels -1 and 0 are not merged into a double-width cell. */
+    int32_t coord2idx(float x) const
+    {
+        return static_cast<int32_t>(std::floor(x * inv_resolution_));
+    }
+
+   private:
+    float resolution_ = 0.20f, inv_resolution_ = 1.0f / 0.20f;
+};
+
+/** Coordinate mapping: voxels of size `resolution` in a non-linear space
+ * with a quadratic mapping for |x|<radius, so voxels are wider near the
+ * origin. See FilterDecimateVoxelsQuadratic. */
+struct QuadraticMapping
+{
+    QuadraticMapping() = default;
+    QuadraticMapping(float resolution, float radius)
+    {
+        setResolution(resolution);
+        setRadius(radius);
+    }
+
+    void setResolution(float resolution)
+    {
+        linear_.setResolution(resolution);
+    }
+    float resolution() const { return linear_.resolution(); }
+
+    void setRadius(float radius)
+    {
+        radius_     = radius;
+        radius_inv_ = 1.0f / radius;
+    }
+    float radius() const { return radius_; }
+
+    float real2grid(float x) const
+    {
+        if (std::abs(x) > radius_) return x;
+        return (x < 0 ? -1.0f : 1.0f) * x * x * radius_inv_;
+    }
+    float grid2real(float y) const
+    {
+        if (std::abs(y) > radius_) return y;
+        return (y < 0 ? -1.0f : 1.0f) * std::sqrt(std::abs(y) * radius_);
+    }
+
+    int32_t coord2idx(float x) const { return linear_.coord2idx(real2grid(x)); }
+
+   private:
+    LinearMapping linear_;
+    float         radius_ = 20.0f, radius_inv_ = 1.0f / 20.0f;
+};
+
+/** A voxel key policy: how point coordinates map into voxel indices
+ * (`Mapping`) and how those are packed into 64-bit keys (`Packing`). Used as
+ * template argument of the voxel grid classes.
+ */
+template <class Mapping, class Packing = PlainPacking>
+struct KeyPolicy
+{
+    using mapping_t = Mapping;
+    using packing_t = Packing;
+
+    Mapping mapping;
+
+    int32_t coord2idx(float x) const { return mapping.coord2idx(x); }
+
+    VoxelIndices indices(float x, float y, float z) const
+    {
+        return {coord2idx(x), coord2idx(y), coord2idx(z)};
+    }
+
+    uint64_t key(float x, float y, float z) const
+    {
+        return Packing::pack(indices(x, y, z));
+    }
+
+    static uint64_t pack(const VoxelIndices& idx)
+    {
+        return Packing::pack(idx);
+    }
+    static VoxelIndices unpack(uint64_t key) { return Packing::unpack(key); }
+};
+
+/** Hasher for packed 64-bit voxel keys in unordered maps */
+struct KeyHash
+{
+    std::size_t operator()(uint64_t key) const noexcept
+    {
+        return static_cast<std::size_t>(mix_bits(key));
+    }
+};
+
+/** Hasher (and less-than comparator) for VoxelIndices in unordered and
+ * ordered containers */
+struct IndicesHash
+{
+    /// Hash operator for unordered maps:
+    std::size_t operator()(const VoxelIndices& k) const noexcept
+    {
+        return static_cast<std::size_t>(mix_bits(PlainPacking::pack(k)));
+    }
+
+    // k1 < k2?
+    bool operator()(const VoxelIndices& k1, const VoxelIndices& k2)
+        const noexcept
+    {
+        if (k1.cx_ != k2.cx_) return k1.cx_ < k2.cx_;
+        if (k1.cy_ != k2.cy_) return k1.cy_ < k2.cy_;
+        return k1.cz_ < k2.cz_;
+    }
+};
+
+}  // namespace voxel_keys
+
+/** Regular voxels, plain packing. Default of all voxel filters. */
+using LinearVoxelKeys = voxel_keys::KeyPolicy<voxel_keys::LinearMapping>;
+
+/** Voxels wider near the origin. Used in FilterDecimateVoxelsQuadratic. */
+using QuadraticVoxelKeys = voxel_keys::KeyPolicy<voxel_keys::QuadraticMapping>;
+
+/** @} */
+
+}  // namespace mp2p_icp_filters
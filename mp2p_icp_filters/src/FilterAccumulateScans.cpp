@@ -0,0 +1,227 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   FilterAccumulateScans.cpp
+ * @brief  Accumulates the last N scans into a voxel-decimated local cloud
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/FilterAccumulateScans.h>
+#include <mp2p_icp_filters/GetOrCreatePointLayer.h>
+#include <mp2p_icp_filters/voxel_keys.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/poses/CPose3D.h>
+#include <tsl/robin_map.h>
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+IMPLEMENTS_MRPT_OBJECT(
+    FilterAccumulateScans, mp2p_icp_filters::FilterBase, mp2p_icp_filters)
+
+using namespace mp2p_icp_filters;
+
+namespace
+{
+// Sum of point coordinates in a voxel, in the odometry/map frame:
+struct VoxelSum
+{
+    double   x = 0, y = 0, z = 0;
+    uint32_t count = 0;
+};
+
+// The contribution of one scan to each voxel:
+using ScanVoxels = std::vector<std::pair<uint64_t, VoxelSum>>;
+}  // namespace
+
+struct FilterAccumulateScans::Impl
+{
+    std::deque<ScanVoxels> window;
+
+    /** The union of all scans in the window */
+    tsl::robin_map<uint64_t, VoxelSum, voxel_keys::KeyHash> voxels;
+
+    void add(const ScanVoxels& scan)
+    {
+        for (const auto& [key, s] : scan)
+        {
+            auto& v = voxels[key];
+            v.x += s.x;
+            v.y += s.y;
+            v.z += s.z;
+            v.count += s.count;
+        }
+    }
+
+    void remove(const ScanVoxels& scan)
+    {
+        for (const auto& [key, s] : scan)
+        {
+            auto it = voxels.find(key);
+            ASSERT_(it != voxels.end());
+
+            auto& v = it.value();
+            ASSERT_GE_(v.count, s.count);
+            v.count -= s.count;
+            if (v.count == 0)
+            {
+                voxels.erase(it);
+                continue;
+            }
+            v.x -= s.x;
+            v.y -= s.y;
+            v.z -= s.z;
+        }
+    }
+};
+
+void FilterAccumulateScans::Parameters::load_from_yaml(
+    const mrpt::containers::yaml& c, FilterAccumulateScans& parent)
+{
+    MCP_LOAD_OPT(c, input_pointcloud_layer);
+    MCP_LOAD_REQ(c, output_pointcloud_layer);
+    MCP_LOAD_OPT(c, output_layer_class);
+    MCP_LOAD_REQ(c, window_length);
+    DECLARE_PARAMETER_IN_REQ(c, voxel_filter_resolution, parent);
+
+    ASSERT_GE_(window_length, 1U);
+
+    ASSERTMSG_(
+        c.has("robot_pose") && c["robot_pose"].isSequence() &&
+            c["robot_pose"].asSequence().size() == 6,
+        "YAML configuration must have an entry `robot_pose` with a sequence "
+        "of 6 values or variable names.");
+
+    auto cc = c["robot_pose"].asSequence();
+
+    for (int i = 0; i < 6; i++)
+        parent.parseAndDeclareParameter(
+            cc.at(i).as<std::string>(), robot_pose[i]);
+}
+
+FilterAccumulateScans::FilterAccumulateScans()
+    : impl_(mrpt::make_impl<Impl>())
+{
+    mrpt::system::COutputLogger::setLoggerName("FilterAccumulateScans");
+}
+
+void FilterAccumulateScans::initialize(const mrpt::containers::yaml& c)
+{
+    MRPT_START
+
+    MRPT_LOG_DEBUG_STREAM("Loading these params:\n" << c);
+    params_.load_from_yaml(c, *this);
+
+    reset();
+
+    MRPT_END
+}
+
+void FilterAccumulateScans::reset()
+{
+    impl_->window.clear();
+    impl_->voxels.clear();
+}
+
+std::size_t FilterAccumulateScans::scanCount() const
+{
+    return impl_->window.size();
+}
+
+void FilterAccumulateScans::filter(mp2p_icp::metric_map_t& inOut) const
+{
+    MRPT_START
+
+    checkAllParametersAreRealized();
+
+    ASSERT_GT_(params_.voxel_filter_resolution, 0);
+
+    // In:
+    const auto itLy = inOut.layers.find(params_.input_pointcloud_layer);
+    ASSERTMSG_(
+        itLy != inOut.layers.end(),
+        mrpt::format(
+            "Input layer '%s' not found.",
+            params_.input_pointcloud_layer.c_str()));
+
+    const auto* pcPtr = mp2p_icp::MapToPointsMap(*itLy->second);
+    ASSERTMSG_(
+        pcPtr, mrpt::format(
+                   "Input layer '%s' could not be converted into a point cloud "
+                   "(class='%s')",
+                   params_.input_pointcloud_layer.c_str(),
+                   itLy->second->GetRuntimeClass()->className));
+
+    const auto& xs = pcPtr->getPointsBufferRef_x();
+    const auto& ys = pcPtr->getPointsBufferRef_y();
+    const auto& zs = pcPtr->getPointsBufferRef_z();
+
+    const auto robotPose = mrpt::poses::CPose3D(params_.robot_pose);
+
+    LinearVoxelKeys kp;
+    kp.mapping.setResolution(params_.voxel_filter_resolution);
+
+    // 1) Decimate the new scan, in the odometry/map frame:
+    tsl::robin_map<uint64_t, VoxelSum, voxel_keys::KeyHash> scanVoxels;
+    scanVoxels.reserve(xs.size() / 4);  // heuristic
+
+    for (size_t i = 0; i < xs.size(); i++)
+    {
+        double gx, gy, gz;
+        robotPose.composePoint(xs[i], ys[i], zs[i], gx, gy, gz);
+
+        auto& v = scanVoxels[kp.key(
+            static_cast<float>(gx), static_cast<float>(gy),
+            static_cast<float>(gz))];
+        v.x += gx;
+        v.y += gy;
+        v.z += gz;
+        v.count++;
+    }
+
+    auto& impl = *impl_;
+
+    // 2) Insert it into the window, evicting the oldest ones:
+    impl.window.emplace_back(scanVoxels.begin(), scanVoxels.end());
+    impl.add(impl.window.back());
+
+    while (impl.window.size() > params_.window_length)
+    {
+        impl.remove(impl.window.front());
+        impl.window.pop_front();
+    }
+
+    // 3) Output, in the current vehicle frame:
+    inOut.layers.erase(params_.output_pointcloud_layer);
+
+    mrpt::maps::CPointsMap::Ptr outPc = GetOrCreatePointLayer(
+        inOut, params_.output_pointcloud_layer,
+        /*do not allow empty*/
+        false, params_.output_layer_class);
+
+    outPc->reserve(impl.voxels.size());
+
+    const auto invPose = -robotPose;
+    for (const auto& [key, v] : impl.voxels)
+    {
+        const double inv_n = 1.0 / v.count;
+        double       lx, ly, lz;
+        invPose.composePoint(v.x * inv_n, v.y * inv_n, v.z * inv_n, lx, ly, lz);
+        outPc->insertPointFast(
+            static_cast<float>(lx), static_cast<float>(ly),
+            static_cast<float>(lz));
+    }
+    outPc->mark_as_modified();
+
+    MRPT_LOG_DEBUG_STREAM(
+        "Window: " << impl.window.size() << " scans, "
+                   << impl.voxels.size() << " voxels.");
+
+    MRPT_END
+}
@@ -10,9 +10,19 @@
  * @date   Jun 10, 2019
  */
 
+#include <mp2p_icp/ProfilerEntry.h>
 #include <mp2p_icp_filters/FilterBase.h>
 #include <mrpt/system/CTimeLogger.h>
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <unordered_map>
+
+#if defined(MP2P_HAS_TBB)
+#include <tbb/parallel_for.h>
+#endif
+
 IMPLEMENTS_VIRTUAL_MRPT_OBJECT(
     FilterBase, mrpt::rtti::CObject, mp2p_icp_filters)
 
@@ -30,7 +40,7 @@ void mp2p_icp_filters::apply_filter_pipeline(
     {
         ASSERT_(f.get() != nullptr);
 
-        std::optional<mrpt::system::CTimeLoggerEntry> tle;
+        std::optional<mp2p_icp::ProfilerEntry> tle;
         if (profiler) tle.emplace(*profiler, f->GetRuntimeClass()->className);
 
         f->filter(inOut);
@@ -78,3 +88,231 @@ FilterPipeline mp2p_icp_filters::filter_pipeline_from_yaml_file(
 
     return filter_pipeline_from_yaml(yamlContent["filters"], vLevel);
 }
+
+void mp2p_icp_filters::apply_filter_pipeline_tiled(
+    const mrpt::containers::yaml& pipelineFilters,
+    mp2p_icp::metric_map_t& inOut, const tiled_pipeline_options_t& options)
+{
+    MRPT_START
+
+    const double T    = options.tile_size;
+    const double halo = options.halo;
+    ASSERT_GT_(T, 0.0);
+    ASSERT_GE_(halo, 0.0);
+    ASSERT_LT_(halo, T);
+    ASSERT_GT_(options.tiles_per_batch, 0U);
+
+    using tile_t = std::pair<int32_t, int32_t>;
+
+    const auto lambdaTile = [T](double x) -> int32_t
+    { return static_cast<int32_t>(std::floor(x / T)); };
+
+    // Calls f(tile) for the core tile of a point, and neighbor tiles if it is
+    // within their halos:
+    const auto lambdaForEachTile = [&](float x, float y, auto&& f)
+    {
+        const int32_t tx = lambdaTile(x), ty = lambdaTile(y);
+        for (int32_t dx = -1; dx <= 1; dx++)
+        {
+            if (dx != 0 && lambdaTile(x + dx * halo) != tx + dx) continue;
+            for (int32_t dy = -1; dy <= 1; dy++)
+            {
+                if (dy != 0 && lambdaTile(y + dy * halo) != ty + dy) continue;
+                f(tile_t(tx + dx, ty + dy));
+            }
+        }
+    };
+
+    std::vector<
+        std::pair<mp2p_icp::layer_name_t, const mrpt::maps::CPointsMap*>>
+        inputPointLayers;
+    std::map<mp2p_icp::layer_name_t, mrpt::maps::CMetricMap::Ptr> otherLayers;
+
+    for (const auto& [name, layer] : inOut.layers)
+    {
+        if (auto pc = dynamic_cast<const mrpt::maps::CPointsMap*>(layer.get());
+            pc)
+        {
+            // Point indices are stored as uint32_t:
+            ASSERT_LT_(pc->size(), UINT32_MAX);
+            inputPointLayers.emplace_back(name, pc);
+        }
+        else
+        {
+            otherLayers[name] = layer;
+        }
+    }
+
+    // 1) Bucket the indices of all points into tiles, including halos, in
+    // one pass over each layer:
+    const auto lambdaTileKey = [](const tile_t& t)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(t.first)) << 32) |
+               static_cast<uint32_t>(t.second);
+    };
+
+    std::unordered_map<uint64_t, size_t> slotOfTile;
+    std::vector<tile_t>                  tiles;
+
+    // [slot][layer] => indices of input points:
+    std::vector<std::vector<std::vector<uint32_t>>> tileIndices;
+
+    for (size_t l = 0; l < inputPointLayers.size(); l++)
+    {
+        const auto& xs = inputPointLayers[l].second->getPointsBufferRef_x();
+        const auto& ys = inputPointLayers[l].second->getPointsBufferRef_y();
+
+        for (size_t i = 0; i < xs.size(); i++)
+        {
+            lambdaForEachTile(
+                xs[i], ys[i],
+                [&](const tile_t& t)
+                {
+                    const auto [it, isNew] =
+                        slotOfTile.try_emplace(lambdaTileKey(t), tiles.size());
+                    if (isNew)
+                    {
+                        tiles.push_back(t);
+                        tileIndices.emplace_back(inputPointLayers.size());
+                    }
+                    tileIndices[it->second][l].push_back(
+                        static_cast<uint32_t>(i));
+                });
+        }
+    }
+    slotOfTile.clear();
+
+    // Nothing to split: just apply the pipeline as in non-tiled mode.
+    if (tiles.empty())
+    {
+        apply_filter_pipeline(
+            filter_pipeline_from_yaml(pipelineFilters, options.verbosity),
+            inOut);
+        return;
+    }
+
+    // Process tiles in a deterministic order, so outputs do not depend on
+    // the order of points:
+    std::vector<size_t> tileOrder(tiles.size());
+    for (size_t i = 0; i < tiles.size(); i++) tileOrder[i] = i;
+    std::sort(
+        tileOrder.begin(), tileOrder.end(),
+        [&](size_t a, size_t b) { return tiles[a] < tiles[b]; });
+
+    std::map<mp2p_icp::layer_name_t, mrpt::maps::CPointsMap::Ptr> outputLayers;
+
+    // 2) Process tiles in batches, so only the tile maps and outputs of one
+    // batch are held in memory at once:
+    for (size_t b0 = 0; b0 < tiles.size(); b0 += options.tiles_per_batch)
+    {
+        const size_t b1 =
+            std::min(tiles.size(), b0 + options.tiles_per_batch);
+
+        // Filter each tile, keeping only output points in its core:
+        std::vector<mp2p_icp::metric_map_t> tileOutputs(b1 - b0);
+
+#if defined(MP2P_HAS_TBB)
+        tbb::parallel_for(
+            static_cast<size_t>(0), b1 - b0,
+            [&](size_t slot)
+#else
+        for (size_t slot = 0; slot < b1 - b0; slot++)
+#endif
+            {
+                const size_t tileIdx = tileOrder[b0 + slot];
+                const auto& [tx, ty] = tiles[tileIdx];
+                auto&       idxs     = tileIndices[tileIdx];
+
+                mp2p_icp::metric_map_t tileMap;
+                for (size_t l = 0; l < inputPointLayers.size(); l++)
+                {
+                    const auto& [name, inPc] = inputPointLayers[l];
+
+                    auto pc =
+                        std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(
+                            inPc->GetRuntimeClass()->ptrCreateObject());
+                    ASSERT_(pc);
+
+                    pc->reserve(idxs[l].size());
+                    for (const auto i : idxs[l]) pc->insertPointFrom(*inPc, i);
+
+                    tileMap.layers[name] = pc;
+                }
+                idxs = {};  // free memory asap
+
+                // Other layers are shared, read-only, by all tiles:
+                for (const auto& [name, layer] : otherLayers)
+                    tileMap.layers[name] = layer;
+
+                const auto pipeline = filter_pipeline_from_yaml(
+                    pipelineFilters, options.verbosity);
+                apply_filter_pipeline(pipeline, tileMap);
+
+                for (const auto& [name, layer] : tileMap.layers)
+                {
+                    if (const auto itOther = otherLayers.find(name);
+                        itOther != otherLayers.end())
+                    {
+                        ASSERTMSG_(
+                            layer == itOther->second,
+                            mrpt::format(
+                                "apply_filter_pipeline_tiled(): non point "
+                                "cloud layer '%s' cannot be replaced by "
+                                "filters in tiled mode",
+                                name.c_str()));
+                        continue;
+                    }
+
+                    const auto* pc =
+                        dynamic_cast<const mrpt::maps::CPointsMap*>(
+                            layer.get());
+                    ASSERTMSG_(
+                        pc, mrpt::format(
+                                "apply_filter_pipeline_tiled(): output layer "
+                                "'%s' is not a point cloud",
+                                name.c_str()));
+
+                    auto corePc =
+                        std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(
+                            pc->GetRuntimeClass()->ptrCreateObject());
+
+                    const auto& xs = pc->getPointsBufferRef_x();
+                    const auto& ys = pc->getPointsBufferRef_y();
+                    for (size_t i = 0; i < xs.size(); i++)
+                    {
+                        if (lambdaTile(xs[i]) == tx && lambdaTile(ys[i]) == ty)
+                            corePc->insertPointFrom(*pc, i);
+                    }
+                    tileOutputs[slot].layers[name] = corePc;
+                }
+            }
+#if defined(MP2P_HAS_TBB)
+        );
+#endif
+
+        // 3) Stitch the tiles of this batch:
+        for (auto& tileOut : tileOutputs)
+        {
+            for (auto& [name, layer] : tileOut.layers)
+            {
+                auto pc =
+                    std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(layer);
+
+                auto it = outputLayers.find(name);
+                if (it == outputLayers.end())
+                {
+                    outputLayers[name] = pc;
+                    continue;
+                }
+                it->second->insertAnotherMap(
+                    pc.get(), mrpt::poses::CPose3D::Identity());
+            }
+            tileOut.layers.clear();
+        }
+    }
+
+    inOut.layers = otherLayers;
+    for (auto& [name, pc] : outputLayers) inOut.layers[name] = std::move(pc);
+
+    MRPT_END
+}
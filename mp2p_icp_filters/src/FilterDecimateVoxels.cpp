@@ -11,15 +11,16 @@
  */
 
 #include <mp2p_icp/pointcloud_sanity_check.h>
+#include <mp2p_icp/reproducibility.h>
 #include <mp2p_icp_filters/FilterDecimateVoxels.h>
 #include <mp2p_icp_filters/GetOrCreatePointLayer.h>
 #include <mrpt/containers/yaml.h>
 #include <mrpt/math/ops_containers.h>  // dotProduct
-#include <mrpt/random/RandomGenerators.h>
 
 //
 #include <mrpt/maps/CPointsMapXYZI.h>
 #include <mrpt/maps/CPointsMapXYZIRT.h>
+#include <tsl/robin_set.h>
 
 IMPLEMENTS_MRPT_OBJECT(
     FilterDecimateVoxels, mp2p_icp_filters::FilterBase, mp2p_icp_filters)
@@ -62,6 +63,8 @@ void FilterDecimateVoxels::Parameters::load_from_yaml(
     DECLARE_PARAMETER_IN_REQ(c, voxel_filter_resolution, parent);
 
     if (c.has("flatten_to")) flatten_to = c["flatten_to"].as<double>();
+
+    random_seed = c.getOrDefault("random_seed", random_seed);
 }
 
 FilterDecimateVoxels::FilterDecimateVoxels()
@@ -203,10 +206,8 @@ void FilterDecimateVoxels::filter(mp2p_icp::metric_map_t& inOut) const
         }
 
         // 2nd) collect grid results:
-        std::set<
-            PointCloudToVoxelGridSingle::indices_t,
-            PointCloudToVoxelGridSingle::IndicesHash>
-            flattenUsedBins;
+        // (x,y) cells already used, if flattening:
+        tsl::robin_set<uint64_t, voxel_keys::KeyHash> flattenUsedBins;
 
         grid.visit_voxels(
             [&](const PointCloudToVoxelGridSingle::indices_t& idx,
@@ -218,16 +219,13 @@ void FilterDecimateVoxels::filter(mp2p_icp::metric_map_t& inOut) const
 
                 if (params_.flatten_to.has_value())
                 {
-                    const PointCloudToVoxelGridSingle::indices_t flattenIdx = {
-                        idx.cx_, idx.cy_, 0};
+                    const uint64_t flattenKey =
+                        voxel_keys::PlainPacking::pack({idx.cx_, idx.cy_, 0});
 
-                    // first time?
-                    if (flattenUsedBins.count(flattenIdx) != 0)
+                    // First time we see this (x,y) cell?
+                    if (!flattenUsedBins.insert(flattenKey).second)
                         return;  // nope. Skip this point.
 
-                    // First time we see this (x,y) cell:
-                    flattenUsedBins.insert(flattenIdx);
-
                     outPc->insertPointFast(
                         vxl.point->x, vxl.point->y, *params_.flatten_to);
                 }
@@ -260,13 +258,11 @@ void FilterDecimateVoxels::filter(mp2p_icp::metric_map_t& inOut) const
         const auto& ys = pc.getPointsBufferRef_y();
         const auto& zs = pc.getPointsBufferRef_z();
 
-        auto rng = mrpt::random::CRandomGenerator();
-        // TODO?: rng.randomize(seed);
+        const mp2p_icp::CounterRNG rng(
+            mp2p_icp::resolve_random_seed(params_.random_seed));
 
-        std::set<
-            PointCloudToVoxelGrid::indices_t,
-            PointCloudToVoxelGrid::IndicesHash>
-            flattenUsedBins;
+        // (x,y) cells already used, if flattening:
+        tsl::robin_set<uint64_t, voxel_keys::KeyHash> flattenUsedBins;
 
         grid.visit_voxels(
             [&](const PointCloudToVoxelGrid::indices_t& idx,
@@ -327,7 +323,9 @@ void FilterDecimateVoxels::filter(mp2p_icp::metric_map_t& inOut) const
                     // Insert a randomly-picked point:
                     const auto idxInVoxel =
                         (params_.decimate_method == DecimateMethod::RandomPoint)
-                            ? (rng.drawUniform64bit() % vxl.indices.size())
+                            ? rng.index(
+                                  vxl.indices.size(),
+                                  voxel_keys::PlainPacking::pack(idx))
                             : 0UL;
 
                     const auto pt_idx = vxl.indices.at(idxInVoxel);
@@ -337,16 +335,13 @@ void FilterDecimateVoxels::filter(mp2p_icp::metric_map_t& inOut) const
                 // insert it, if passed the flatten filter:
                 if (params_.flatten_to.has_value())
                 {
-                    const PointCloudToVoxelGrid::indices_t flattenIdx = {
-                        idx.cx_, idx.cy_, 0};
+                    const uint64_t flattenKey =
+                        voxel_keys::PlainPacking::pack({idx.cx_, idx.cy_, 0});
 
-                    // first time?
-                    if (flattenUsedBins.count(flattenIdx) != 0)
+                    // First time we see this (x,y) cell?
+                    if (!flattenUsedBins.insert(flattenKey).second)
                         return;  // nope. Skip this point.
 
-                    // First time we see this (x,y) cell:
-                    flattenUsedBins.insert(flattenIdx);
-
                     if (!insertPt)
                         insertPt.emplace(
                             xs[insertPtIdx], ys[insertPtIdx], zs[insertPtIdx]);
@@ -10,12 +10,11 @@
  * @date   Nov 14, 2023
  */
 
+#include <mp2p_icp/reproducibility.h>
 #include <mp2p_icp_filters/FilterDecimateVoxelsQuadratic.h>
 #include <mp2p_icp_filters/GetOrCreatePointLayer.h>
 #include <mrpt/containers/yaml.h>
-#include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/math/ops_containers.h>  // dotProduct
-#include <mrpt/random/RandomGenerators.h>
 
 IMPLEMENTS_MRPT_OBJECT(
     FilterDecimateVoxelsQuadratic, mp2p_icp_filters::FilterBase,
@@ -36,6 +35,8 @@ void FilterDecimateVoxelsQuadratic::Parameters::load_from_yaml(
     MCP_LOAD_REQ(c, quadratic_reference_radius);
     MCP_LOAD_REQ(c, use_voxel_average);
     MCP_LOAD_REQ(c, use_closest_to_voxel_average);
+
+    random_seed = c.getOrDefault("random_seed", random_seed);
 }
 
 FilterDecimateVoxelsQuadratic::FilterDecimateVoxelsQuadratic() = default;
@@ -47,8 +48,10 @@ void FilterDecimateVoxelsQuadratic::initialize(const mrpt::containers::yaml& c)
     MRPT_LOG_DEBUG_STREAM("Loading these params:\n" << c);
     params_.load_from_yaml(c);
 
-    filter_grid_.setResolution(params_.voxel_filter_resolution);
-    quadratic_reference_radius_inv_ = 1.0f / params_.quadratic_reference_radius;
+    QuadraticVoxelKeys kp;
+    kp.mapping.setResolution(params_.voxel_filter_resolution);
+    kp.mapping.setRadius(params_.quadratic_reference_radius);
+    filter_grid_.setKeyPolicy(kp);
 
     MRPT_END
 }
@@ -91,21 +94,8 @@ void FilterDecimateVoxelsQuadratic::filter(mp2p_icp::metric_map_t& inOut) const
         }
     }
 
-    // Non-linear transform input cloud:
-    const auto& rawPc = *pcPtr;
-
-    mrpt::maps::CSimplePointsMap pc;
-    pc.reserve(rawPc.size());
-
-    const auto& xs = rawPc.getPointsBufferRef_x();
-    const auto& ys = rawPc.getPointsBufferRef_y();
-    const auto& zs = rawPc.getPointsBufferRef_z();
-    for (size_t i = 0; i < xs.size(); i++)
-    {
-        pc.insertPointFast(
-            real2grid(xs[i]), real2grid(ys[i]), real2grid(zs[i]));
-    }
-    pc.mark_as_modified();
+    // The non-linear mapping is applied by the grid key policy:
+    const auto& pc = *pcPtr;
 
     // Do filter:
     outPc->reserve(outPc->size() + pc.size() / 10);
@@ -113,22 +103,21 @@ void FilterDecimateVoxelsQuadratic::filter(mp2p_icp::metric_map_t& inOut) const
     filter_grid_.clear();
     filter_grid_.processPointCloud(pc);
 
-    //    const auto& xs = pc.getPointsBufferRef_x();
-    //    const auto& ys = pc.getPointsBufferRef_y();
-    //    const auto& zs = pc.getPointsBufferRef_z();
+    const auto& xs = pc.getPointsBufferRef_x();
+    const auto& ys = pc.getPointsBufferRef_y();
+    const auto& zs = pc.getPointsBufferRef_z();
 
-    auto rng = mrpt::random::CRandomGenerator();
-    // TODO?: rng.randomize(seed);
+    const mp2p_icp::CounterRNG rng(
+        mp2p_icp::resolve_random_seed(params_.random_seed));
 
-    // Inverse nonlinear transformation:
     auto lambdaInsertPt = [&outPc](float x, float y, float z)
     { outPc->insertPointFast(x, y, z); };
 
     size_t nonEmptyVoxels = 0;
 
     filter_grid_.visit_voxels(
-        [&](const PointCloudToVoxelGrid::indices_t&,
-            const PointCloudToVoxelGrid::voxel_t& vxl)
+        [&](const PointCloudToVoxelGridQuadratic::indices_t& idx,
+            const PointCloudToVoxelGridQuadratic::voxel_t&   vxl)
         {
             if (vxl.indices.empty()) return;
 
@@ -181,7 +170,9 @@ void FilterDecimateVoxelsQuadratic::filter(mp2p_icp::metric_map_t& inOut) const
                 // Insert a randomly-picked point:
                 const auto idxInVoxel =
                     params_.use_random_point_within_voxel
-                        ? (rng.drawUniform64bit() % vxl.indices.size())
+                        ? rng.index(
+                              vxl.indices.size(),
+                              voxel_keys::PlainPacking::pack(idx))
                         : 0UL;
 
                 const auto pt_idx = vxl.indices.at(idxInVoxel);
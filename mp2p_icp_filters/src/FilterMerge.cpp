@@ -14,20 +14,288 @@
 #include <mp2p_icp_filters/FilterMerge.h>
 #include <mrpt/containers/yaml.h>
 #include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/maps/CVoxelMap.h>
 #include <mrpt/math/TPose3D.h>
 #include <mrpt/obs/CObservationPointCloud.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <tuple>
+#include <utility>
+
+#include "voxel_ray_tracing.h"
+
+#if defined(MP2P_HAS_TBB)
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#endif
+
 IMPLEMENTS_MRPT_OBJECT(
     FilterMerge, mp2p_icp_filters::FilterBase, mp2p_icp_filters)
 
 using namespace mp2p_icp_filters;
 
+namespace
+{
+// Free/occupied observation counts of one voxel:
+struct VoxelUpdate
+{
+    Bonxai::CoordT coord;
+    uint32_t       nFree = 0, nOccupied = 0;
+};
+
+using voxel_grid_t = Bonxai::VoxelGrid<mrpt::maps::CVoxelMap::voxel_node_t>;
+
+// Updates are applied sorted by Bonxai leaf block (of 2^leafBits voxels per
+// side), to exploit the cached Bonxai accessor:
+struct BlockOrder
+{
+    uint32_t leafBits = 3;
+
+    auto key(const Bonxai::CoordT& c) const
+    {
+        return std::make_tuple(
+            c.x >> leafBits, c.y >> leafBits, c.z >> leafBits, c.x, c.y, c.z);
+    }
+    bool operator()(const VoxelUpdate& a, const VoxelUpdate& b) const
+    {
+        return key(a.coord) < key(b.coord);
+    }
+};
+
+// Sorts and merges the counts of repeated voxels:
+void sort_and_reduce(std::vector<VoxelUpdate>& updates, const BlockOrder& order)
+{
+#if defined(MP2P_HAS_TBB)
+    tbb::parallel_sort(updates.begin(), updates.end(), order);
+#else
+    std::sort(updates.begin(), updates.end(), order);
+#endif
+
+    size_t nOut = 0;
+    for (size_t i = 0; i < updates.size(); i++)
+    {
+        const auto& u = updates[i];
+        if (nOut > 0)
+        {
+            auto& prev = updates[nOut - 1];
+            if (prev.coord.x == u.coord.x && prev.coord.y == u.coord.y &&
+                prev.coord.z == u.coord.z)
+            {
+                prev.nFree += u.nFree;
+                prev.nOccupied += u.nOccupied;
+                continue;
+            }
+        }
+        updates[nOut++] = u;
+    }
+    updates.resize(nOut);
+}
+
+// Adds all voxels from "a" to "b", but "b", as free:
+void trace_free_ray(
+    const Bonxai::CoordT& a, const Bonxai::CoordT& b,
+    std::vector<VoxelUpdate>& updates)
+{
+    internal::trace_voxel_ray(
+        a.x, a.y, a.z, b.x, b.y, b.z, [&](int32_t x, int32_t y, int32_t z)
+        { updates.push_back({Bonxai::CoordT{x, y, z}, 1, 0}); });
+}
+
+// CVoxelMap log-odds updates move a cell by a fixed step per observation,
+// until it reaches or crosses a clamping threshold, then it is set to it.
+struct LogOddsUpdate
+{
+    int32_t step = 0, thres = 0;
+
+    // Result of `n` consecutive updates at once:
+    int32_t apply(int32_t cell, uint32_t n) const
+    {
+        if (n == 0) return cell;
+
+        const int32_t  absStep = std::abs(step);
+        const int32_t  dist    = step > 0 ? thres - cell : cell - thres;
+        const uint32_t nBeforeThres =
+            dist > 0 ? static_cast<uint32_t>((dist + absStep - 1) / absStep)
+                     : 0;
+        return n <= nBeforeThres ? cell + static_cast<int32_t>(n) * step
+                                 : thres;
+    }
+};
+
+// The step and threshold of free/occupied updates are measured on a
+// one-voxel scratch map with the same insertion options, so they are exactly
+// those of CVoxelMap::updateVoxel():
+std::pair<LogOddsUpdate, LogOddsUpdate> measure_log_odds_updates(
+    const mrpt::maps::CVoxelMap& map)
+{
+    const double res = map.grid().resolution;
+
+    mrpt::maps::CVoxelMap scratch(res);
+    scratch.insertionOptions = map.insertionOptions;
+
+    auto& g        = const_cast<voxel_grid_t&>(scratch.grid());
+    auto  accessor = g.createAccessor();
+
+    // Measure each kind of update in a different voxel, starting at 0:
+    const auto lambdaMeasure = [&](bool occupied)
+    {
+        const double x = occupied ? 1.5 * res : 0.5 * res;
+
+        LogOddsUpdate lu;
+        scratch.updateVoxel(x, 0.5 * res, 0.5 * res, occupied);
+        const auto* cell = accessor.value(
+            Bonxai::PosToCoord({x, 0.5 * res, 0.5 * res}, g.inv_resolution));
+        ASSERT_(cell);
+        lu.step = cell->occupancy;
+
+        // Saturate:
+        for (int i = 0; i < 256; i++)
+            scratch.updateVoxel(x, 0.5 * res, 0.5 * res, occupied);
+        lu.thres = cell->occupancy;
+        return lu;
+    };
+
+    const LogOddsUpdate freeUpdate = lambdaMeasure(false);
+    const LogOddsUpdate occUpdate  = lambdaMeasure(true);
+    return {freeUpdate, occUpdate};
+}
+
+// Whether the parallel insertion supports all the map insertion options:
+bool parallel_insertion_supports(const mrpt::maps::CVoxelMap& map)
+{
+    return map.insertionOptions.remove_voxels_farther_than <= 0;
+}
+
+// Parallel ray tracing insertion of a point cloud (in global coordinates)
+// into a voxel map:
+void parallel_insert_into_voxelmap(
+    mrpt::maps::CVoxelMap& map, const mrpt::maps::CPointsMap& pts,
+    const mrpt::poses::CPose3D&                sensorPose,
+    const std::optional<mrpt::poses::CPose3D>& localToGlobal,
+    bool                                       reduceDuplicateRays)
+{
+    auto&        grid       = const_cast<voxel_grid_t&>(map.grid());
+    const double invRes     = grid.inv_resolution;
+    const double resolution = grid.resolution;
+
+    const BlockOrder order{grid.LEAF_BITS};
+
+    const auto&  xs = pts.getPointsBufferRef_x();
+    const auto&  ys = pts.getPointsBufferRef_y();
+    const auto&  zs = pts.getPointsBufferRef_z();
+    const size_t N  = xs.size();
+
+    const auto& io       = map.insertionOptions;
+    const auto  origin   = sensorPose.translation();
+    const auto  originCo =
+        Bonxai::PosToCoord({origin.x, origin.y, origin.z}, invRes);
+
+    // As in the serial CVoxelMap insertion, only every n-th point is used:
+    const size_t decimation = std::max<size_t>(1, io.decimation);
+
+    // Split the rays in chunks, each one with its own sparse buffer:
+    constexpr size_t CHUNK_SIZE = 2048;
+    const size_t     nChunks    = (N + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    std::vector<std::vector<VoxelUpdate>> chunkUpdates(nChunks);
+
+#if defined(MP2P_HAS_TBB)
+    tbb::parallel_for(
+        static_cast<size_t>(0), nChunks,
+        [&](size_t chunk)
+#else
+    for (size_t chunk = 0; chunk < nChunks; chunk++)
+#endif
+        {
+            auto& updates = chunkUpdates[chunk];
+
+            const size_t i1 = std::min(N, (chunk + 1) * CHUNK_SIZE);
+            for (size_t i = chunk * CHUNK_SIZE; i < i1; i++)
+            {
+                if (i % decimation != 0) continue;
+
+                mrpt::math::TPoint3D pt(xs[i], ys[i], zs[i]);
+                if (localToGlobal) pt = localToGlobal->composePoint(pt);
+
+                if (io.max_range > 0 && (pt - origin).norm() > io.max_range)
+                    continue;
+
+                const auto ptCo =
+                    Bonxai::PosToCoord({pt.x, pt.y, pt.z}, invRes);
+
+                if (io.ray_trace_free_space)
+                    trace_free_ray(originCo, ptCo, updates);
+
+                updates.push_back({ptCo, 0, 1});
+            }
+            sort_and_reduce(updates, order);
+        }
+#if defined(MP2P_HAS_TBB)
+    );
+#endif
+
+    // Merge all chunks:
+    size_t nTotal = 0;
+    for (const auto& u : chunkUpdates) nTotal += u.size();
+
+    std::vector<VoxelUpdate> updates;
+    updates.reserve(nTotal);
+    for (auto& u : chunkUpdates)
+    {
+        updates.insert(updates.end(), u.begin(), u.end());
+        u = {};
+    }
+    sort_and_reduce(updates, order);
+
+    if (updates.empty()) return;
+
+    if (reduceDuplicateRays)
+    {
+        for (auto& u : updates)
+        {
+            u.nFree     = u.nOccupied != 0 ? 0 : 1;
+            u.nOccupied = u.nOccupied != 0 ? 1 : 0;
+        }
+    }
+
+    // The last observation goes through CVoxelMap::updateVoxel(), so the map
+    // invalidates its cached data (e.g. occupied voxels):
+    auto&      last         = updates.back();
+    const bool lastOccupied = last.nOccupied != 0;
+    (lastOccupied ? last.nOccupied : last.nFree)--;
+
+    // Apply all free, then all occupied observations of each voxel at once,
+    // block by block:
+    const auto [freeUpdate, occUpdate] = measure_log_odds_updates(map);
+
+    auto accessor = grid.createAccessor();
+    for (const auto& u : updates)
+    {
+        auto* cell = accessor.value(u.coord, true /*create*/);
+        ASSERT_(cell);
+
+        int32_t lo = cell->occupancy;
+        lo         = freeUpdate.apply(lo, u.nFree);
+        lo         = occUpdate.apply(lo, u.nOccupied);
+        cell->occupancy = static_cast<decltype(cell->occupancy)>(lo);
+    }
+
+    // Use the voxel center to avoid rounding issues in Bonxai:
+    map.updateVoxel(
+        (last.coord.x + 0.5) * resolution, (last.coord.y + 0.5) * resolution,
+        (last.coord.z + 0.5) * resolution, lastOccupied);
+}
+}  // namespace
+
 void FilterMerge::Parameters::load_from_yaml(
     const mrpt::containers::yaml& c, FilterMerge& parent)
 {
     MCP_LOAD_REQ(c, input_pointcloud_layer);
     MCP_LOAD_REQ(c, target_layer);
     MCP_LOAD_OPT(c, input_layer_in_local_coordinates);
+    MCP_LOAD_OPT(c, parallel_voxel_insertion);
+    MCP_LOAD_OPT(c, reduce_duplicate_rays);
 
     if (c.has("robot_pose"))
     {
@@ -91,14 +359,43 @@ void FilterMerge::filter(mp2p_icp::metric_map_t& inOut) const
 
     mrpt::maps::CMetricMap::Ptr out = inOut.layers.at(params_.target_layer);
 
-    // Create fake observation for insertion:
+    const auto robotPose = mrpt::poses::CPose3D(params_.robot_pose);
+
+    // Parallel ray tracing into voxel maps:
+    if (auto voxelMap = std::dynamic_pointer_cast<mrpt::maps::CVoxelMap>(out);
+        voxelMap && params_.parallel_voxel_insertion &&
+        parallel_insertion_supports(*voxelMap))
+    {
+        parallel_insert_into_voxelmap(
+            *voxelMap, *pcPtr, robotPose,
+            params_.input_layer_in_local_coordinates
+                ? std::optional<mrpt::poses::CPose3D>(robotPose)
+                : std::nullopt,
+            params_.reduce_duplicate_rays);
+        return;
+    }
+
+    // Point cloud targets: append directly, with one single transformation
+    // and keeping all point attributes:
+    if (auto outPc = std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(out);
+        outPc && outPc.get() != pcPtr &&
+        !outPc->insertionOptions.fuseWithExisting)
+    {
+        outPc->reserve(outPc->size() + pcPtr->size());
+        outPc->insertAnotherMap(
+            pcPtr, params_.input_layer_in_local_coordinates
+                       ? robotPose
+                       : mrpt::poses::CPose3D::Identity());
+        return;
+    }
+
+    // Other map types (voxels, grids,...) need the sensor origin, so create
+    // a fake observation for insertion:
     mrpt::obs::CObservationPointCloud obs;
     auto pts       = mrpt::maps::CSimplePointsMap::Create();
     obs.pointcloud = pts;
 
     // Copy the input layer here, as seen from the robot (hence the "-"):
-    const auto robotPose = mrpt::poses::CPose3D(params_.robot_pose);
-
     if (params_.input_layer_in_local_coordinates)
     {
         pts->insertAnotherMap(pcPtr, mrpt::poses::CPose3D::Identity());
@@ -12,6 +12,7 @@
 
 #include <mp2p_icp_filters/FilterPoleDetector.h>
 #include <mp2p_icp_filters/GetOrCreatePointLayer.h>
+#include <mp2p_icp_filters/voxel_keys.h>
 #include <mrpt/containers/yaml.h>
 #include <mrpt/math/TPoint3D.h>
 
@@ -51,33 +52,19 @@ struct index2d_t
 
 index2d_t<> xy_to_index(float x, float y, float resolution)
 {
-    return {
-        static_cast<int32_t>(x / resolution),
-        static_cast<int32_t>(y / resolution)};
+    const mp2p_icp_filters::voxel_keys::LinearMapping m(resolution);
+    return {m.coord2idx(x), m.coord2idx(y)};
 }
 
-/** This implement the optimized hash from this paper (adapted for 2D)
- *
- *  Teschner, M., Heidelberger, B., Müller, M., Pomerantes, D., & Gross, M. H.
- * (2003, November). Optimized spatial hashing for collision detection of
- * deformable objects. In Vmv (Vol. 3, pp. 47-54).
- *
- */
+/** Hash of 2D cells, as for 3D voxels (see voxel_keys.h) with z=0. */
 template <typename cell_coord_t = int32_t>
 struct index2d_hash
 {
     /// Hash operator for unordered maps:
     std::size_t operator()(const index2d_t<cell_coord_t>& k) const noexcept
     {
-        // These are the implicit assumptions of the reinterpret cast below:
-        static_assert(sizeof(cell_coord_t) == sizeof(uint32_t));
-        static_assert(
-            offsetof(index2d_t<cell_coord_t>, cx) == 0 * sizeof(uint32_t));
-        static_assert(
-            offsetof(index2d_t<cell_coord_t>, cy) == 1 * sizeof(uint32_t));
-
-        const uint32_t* vec = reinterpret_cast<const uint32_t*>(&k);
-        return ((1 << 20) - 1) & (vec[0] * 73856093 ^ vec[1] * 19349663);
+        using namespace mp2p_icp_filters;
+        return voxel_keys::IndicesHash()(VoxelIndices(k.cx, k.cy, 0));
     }
 
     /// k1 < k2? for std::map containers
@@ -0,0 +1,388 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   FilterRemoveDynamicPoints.cpp
+ * @brief  Online removal of dynamic objects while building a point map
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/FilterRemoveDynamicPoints.h>
+#include <mp2p_icp_filters/GetOrCreatePointLayer.h>
+#include <mp2p_icp_filters/voxel_keys.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/poses/CPose3D.h>
+#include <tsl/robin_map.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "voxel_ray_tracing.h"
+
+#if defined(MP2P_HAS_TBB)
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#endif
+
+IMPLEMENTS_MRPT_OBJECT(
+    FilterRemoveDynamicPoints, mp2p_icp_filters::FilterBase, mp2p_icp_filters)
+
+using namespace mp2p_icp_filters;
+
+namespace
+{
+struct VoxelStats
+{
+    uint16_t hits = 0, misses = 0;
+};
+
+// Observation of one voxel in one scan. Sorting by (key,hit) and keeping
+// the last entry of each key merges repeated observations, with hits
+// overriding misses:
+struct VoxelUpdate
+{
+    uint64_t key;
+    bool     hit;
+
+    bool operator<(const VoxelUpdate& o) const
+    {
+        return key < o.key || (key == o.key && hit < o.hit);
+    }
+};
+
+void sort_and_reduce(std::vector<VoxelUpdate>& updates)
+{
+#if defined(MP2P_HAS_TBB)
+    tbb::parallel_sort(updates.begin(), updates.end());
+#else
+    std::sort(updates.begin(), updates.end());
+#endif
+
+    size_t nOut = 0;
+    for (size_t i = 0; i < updates.size(); i++)
+    {
+        if (i + 1 < updates.size() && updates[i + 1].key == updates[i].key)
+            continue;
+        updates[nOut++] = updates[i];
+    }
+    updates.resize(nOut);
+}
+
+void saturated_increment(uint16_t& v)
+{
+    if (v != std::numeric_limits<uint16_t>::max()) v++;
+}
+}  // namespace
+
+struct FilterRemoveDynamicPoints::Impl
+{
+    tsl::robin_map<uint64_t, VoxelStats, voxel_keys::KeyHash> voxels;
+
+    // Indices of the target layer points in each voxel, and the voxel of each
+    // target layer point, so dynamic voxels are pruned without scanning the
+    // whole map:
+    tsl::robin_map<uint64_t, std::vector<uint32_t>, voxel_keys::KeyHash>
+                          voxelPoints;
+    std::vector<uint64_t> mapPointKeys;
+
+    void index_map_points(
+        const mrpt::maps::CPointsMap& pc, const LinearVoxelKeys& kp)
+    {
+        voxelPoints.clear();
+        mapPointKeys.resize(pc.size());
+
+        const auto& xs = pc.getPointsBufferRef_x();
+        const auto& ys = pc.getPointsBufferRef_y();
+        const auto& zs = pc.getPointsBufferRef_z();
+        for (size_t i = 0; i < xs.size(); i++)
+        {
+            mapPointKeys[i] = kp.key(xs[i], ys[i], zs[i]);
+            voxelPoints[mapPointKeys[i]].push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    // Removes points from the target layer by moving the last point into
+    // their place, so only the moved points must be re-indexed:
+    void remove_map_points(
+        std::vector<uint32_t>& idxs, mrpt::maps::CPointsMap& pc,
+        mrpt::maps::CPointsMap* removedPc)
+    {
+        std::sort(idxs.begin(), idxs.end(), std::greater<uint32_t>());
+
+        std::vector<float> fields;
+        size_t             M = pc.size();
+        for (const uint32_t i : idxs)
+        {
+            if (removedPc) removedPc->insertPointFrom(pc, i);
+
+            const uint32_t last = static_cast<uint32_t>(M - 1);
+            if (i != last)
+            {
+                // Since indices are processed in descending order, the last
+                // point is never one to be removed:
+                pc.getPointAllFieldsFast(last, fields);
+                pc.setPointAllFieldsFast(i, fields);
+
+                auto& lastVoxel = voxelPoints[mapPointKeys[last]];
+                *std::find(lastVoxel.begin(), lastVoxel.end(), last) = i;
+                mapPointKeys[i] = mapPointKeys[last];
+            }
+            mapPointKeys.pop_back();
+            M--;
+        }
+        pc.resize(M);
+    }
+};
+
+void FilterRemoveDynamicPoints::Parameters::load_from_yaml(
+    const mrpt::containers::yaml& c, FilterRemoveDynamicPoints& parent)
+{
+    MCP_LOAD_REQ(c, input_pointcloud_layer);
+    MCP_LOAD_REQ(c, target_layer);
+    MCP_LOAD_OPT(c, output_layer_dynamic_objects);
+    MCP_LOAD_OPT(c, input_layer_in_local_coordinates);
+    DECLARE_PARAMETER_IN_OPT(c, voxel_size, parent);
+    DECLARE_PARAMETER_IN_OPT(c, max_range, parent);
+    MCP_LOAD_OPT(c, minimum_observations);
+    MCP_LOAD_OPT(c, dynamic_threshold);
+
+    ASSERTMSG_(
+        c.has("robot_pose") && c["robot_pose"].isSequence() &&
+            c["robot_pose"].asSequence().size() == 6,
+        "YAML configuration must have an entry `robot_pose` with a sequence "
+        "of 6 values or variable names.");
+
+    auto cc = c["robot_pose"].asSequence();
+
+    for (int i = 0; i < 6; i++)
+        parent.parseAndDeclareParameter(
+            cc.at(i).as<std::string>(), robot_pose[i]);
+}
+
+FilterRemoveDynamicPoints::FilterRemoveDynamicPoints()
+    : impl_(mrpt::make_impl<Impl>())
+{
+    mrpt::system::COutputLogger::setLoggerName("FilterRemoveDynamicPoints");
+}
+
+void FilterRemoveDynamicPoints::initialize(const mrpt::containers::yaml& c)
+{
+    MRPT_START
+
+    MRPT_LOG_DEBUG_STREAM("Loading these params:\n" << c);
+    params_.load_from_yaml(c, *this);
+
+    reset();
+
+    MRPT_END
+}
+
+void FilterRemoveDynamicPoints::reset()
+{
+    impl_->voxels.clear();
+    impl_->voxelPoints.clear();
+    impl_->mapPointKeys.clear();
+}
+
+void FilterRemoveDynamicPoints::filter(mp2p_icp::metric_map_t& inOut) const
+{
+    MRPT_START
+
+    checkAllParametersAreRealized();
+
+    ASSERT_GT_(params_.voxel_size, 0);
+
+    // In:
+    const auto itLy = inOut.layers.find(params_.input_pointcloud_layer);
+    ASSERTMSG_(
+        itLy != inOut.layers.end(),
+        mrpt::format(
+            "Input layer '%s' not found.",
+            params_.input_pointcloud_layer.c_str()));
+
+    const auto* pcPtr = mp2p_icp::MapToPointsMap(*itLy->second);
+    ASSERTMSG_(
+        pcPtr, mrpt::format(
+                   "Input layer '%s' could not be converted into a point cloud "
+                   "(class='%s')",
+                   params_.input_pointcloud_layer.c_str(),
+                   itLy->second->GetRuntimeClass()->className));
+
+    // Out:
+    mrpt::maps::CPointsMap::Ptr outPc = GetOrCreatePointLayer(
+        inOut, params_.target_layer,
+        /*do not allow empty*/
+        false,
+        /* create cloud of the same type */
+        pcPtr->GetRuntimeClass()->className);
+    ASSERT_(outPc.get() != pcPtr);
+
+    mrpt::maps::CPointsMap::Ptr dynPc;
+    if (!params_.output_layer_dynamic_objects.empty())
+    {
+        dynPc = GetOrCreatePointLayer(
+            inOut, params_.output_layer_dynamic_objects, false,
+            pcPtr->GetRuntimeClass()->className);
+    }
+
+    const auto& xs = pcPtr->getPointsBufferRef_x();
+    const auto& ys = pcPtr->getPointsBufferRef_y();
+    const auto& zs = pcPtr->getPointsBufferRef_z();
+    const size_t N = xs.size();
+
+    const auto robotPose = mrpt::poses::CPose3D(params_.robot_pose);
+    const auto origin    = mrpt::math::TPoint3Df(
+        static_cast<float>(robotPose.x()), static_cast<float>(robotPose.y()),
+        static_cast<float>(robotPose.z()));
+
+    LinearVoxelKeys kp;
+    kp.mapping.setResolution(params_.voxel_size);
+
+    const VoxelIndices originIdx = kp.indices(origin.x, origin.y, origin.z);
+
+    // The target layer was modified out of this filter, or created before it:
+    if (impl_->mapPointKeys.size() != outPc->size())
+    {
+        MRPT_LOG_DEBUG_STREAM(
+            "Indexing " << outPc->size() << " points of target layer '"
+                        << params_.target_layer << "'");
+        impl_->index_map_points(*outPc, kp);
+    }
+
+    // 1) Points in the map frame, and their voxels:
+    std::vector<mrpt::math::TPoint3Df> pts(N);
+    std::vector<uint64_t>              ptKeys(N);
+
+    // 2) Parallel ray tracing, in chunks, each one with its own buffer:
+    constexpr size_t CHUNK_SIZE = 2048;
+    const size_t     nChunks    = (N + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    const float      maxRange   = static_cast<float>(params_.max_range);
+
+    std::vector<std::vector<VoxelUpdate>> chunkUpdates(nChunks);
+
+#if defined(MP2P_HAS_TBB)
+    tbb::parallel_for(
+        static_cast<size_t>(0), nChunks,
+        [&](size_t chunk)
+#else
+    for (size_t chunk = 0; chunk < nChunks; chunk++)
+#endif
+        {
+            auto& updates = chunkUpdates[chunk];
+
+            const size_t i1 = std::min(N, (chunk + 1) * CHUNK_SIZE);
+            for (size_t i = chunk * CHUNK_SIZE; i < i1; i++)
+            {
+                auto& pt = pts[i];
+                if (params_.input_layer_in_local_coordinates)
+                    robotPose.composePoint(
+                        xs[i], ys[i], zs[i], pt.x, pt.y, pt.z);
+                else
+                    pt = {xs[i], ys[i], zs[i]};
+
+                const VoxelIndices idx = kp.indices(pt.x, pt.y, pt.z);
+                ptKeys[i]              = LinearVoxelKeys::pack(idx);
+                updates.push_back({ptKeys[i], true});
+
+                if (maxRange > 0 && (pt - origin).norm() > maxRange) continue;
+
+                internal::trace_voxel_ray(
+                    originIdx.cx_, originIdx.cy_, originIdx.cz_, idx.cx_,
+                    idx.cy_, idx.cz_,
+                    [&](int32_t x, int32_t y, int32_t z)
+                    {
+                        updates.push_back(
+                            {LinearVoxelKeys::pack({x, y, z}), false});
+                    });
+            }
+            sort_and_reduce(updates);
+        }
+#if defined(MP2P_HAS_TBB)
+    );
+#endif
+
+    // Merge all chunks:
+    size_t nTotal = 0;
+    for (const auto& u : chunkUpdates) nTotal += u.size();
+
+    std::vector<VoxelUpdate> updates;
+    updates.reserve(nTotal);
+    for (auto& u : chunkUpdates)
+    {
+        updates.insert(updates.end(), u.begin(), u.end());
+        u = {};
+    }
+    sort_and_reduce(updates);
+
+    // 3) Update voxel statistics, and find out voxels with map points that
+    // became dynamic:
+    auto& voxels = impl_->voxels;
+
+    const auto isDynamic = [&](const VoxelStats& v)
+    {
+        const uint32_t n = v.hits + v.misses;
+        return n >= params_.minimum_observations &&
+               v.misses > params_.dynamic_threshold * n;
+    };
+
+    auto& voxelPoints = impl_->voxelPoints;
+
+    std::vector<uint32_t> toRemove;
+
+    for (const auto& u : updates)
+    {
+        auto& v = voxels[u.key];
+        saturated_increment(u.hit ? v.hits : v.misses);
+
+        if (!isDynamic(v)) continue;
+
+        if (auto it = voxelPoints.find(u.key); it != voxelPoints.end())
+        {
+            const auto& idxs = it->second;
+            toRemove.insert(toRemove.end(), idxs.begin(), idxs.end());
+            voxelPoints.erase(it);
+        }
+    }
+
+    // 4) Remove points from the map, in voxels that became dynamic. The cost
+    // only depends on the number of removed points, not the map size:
+    const size_t nPruned = toRemove.size();
+    if (!toRemove.empty())
+        impl_->remove_map_points(toRemove, *outPc, dynPc.get());
+
+    // 5) Append new points in non-dynamic voxels:
+    outPc->reserve(outPc->size() + N);
+
+    size_t nDynamic = 0;
+    for (size_t i = 0; i < N; i++)
+    {
+        auto& v = voxels[ptKeys[i]];
+        if (isDynamic(v))
+        {
+            nDynamic++;
+            if (dynPc) dynPc->insertPointFrom(*pcPtr, i);
+            continue;
+        }
+        voxelPoints[ptKeys[i]].push_back(static_cast<uint32_t>(outPc->size()));
+        impl_->mapPointKeys.push_back(ptKeys[i]);
+
+        // Keep all point fields (intensity, ring,...) but the coordinates:
+        outPc->insertPointFrom(*pcPtr, i);
+        outPc->setPointFast(outPc->size() - 1, pts[i].x, pts[i].y, pts[i].z);
+    }
+    outPc->mark_as_modified();
+    if (dynPc) dynPc->mark_as_modified();
+
+    MRPT_LOG_DEBUG_STREAM(
+        "Updated voxels: " << updates.size() << ", removed map points: "
+                           << nPruned << ", dynamic new points: " << nDynamic
+                           << ", total voxels: " << voxels.size());
+
+    MRPT_END
+}
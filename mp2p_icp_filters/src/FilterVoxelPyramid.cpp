@@ -0,0 +1,215 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   FilterVoxelPyramid.cpp
+ * @brief  Builds a multi-resolution pyramid of decimated point layers
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/FilterVoxelPyramid.h>
+#include <mp2p_icp_filters/GetOrCreatePointLayer.h>
+#include <mp2p_icp_filters/voxel_keys.h>
+#include <mrpt/containers/yaml.h>
+#include <tsl/robin_map.h>
+
+#include <limits>
+#include <vector>
+
+IMPLEMENTS_MRPT_OBJECT(
+    FilterVoxelPyramid, mp2p_icp_filters::FilterBase, mp2p_icp_filters)
+
+using namespace mp2p_icp_filters;
+
+namespace
+{
+using Keys = voxel_keys::PlainPacking;
+
+struct Voxel
+{
+    int32_t  cx = 0, cy = 0, cz = 0;
+    uint32_t firstPoint = 0;  //!< Index of the first input point
+    uint32_t count      = 0;
+    float    sumX = 0, sumY = 0, sumZ = 0;
+};
+
+// Voxels of one level, in order of first appearance, plus the key => voxel
+// index lookup table:
+struct Level
+{
+    std::vector<Voxel>                                      voxels;
+    tsl::robin_map<uint64_t, uint32_t, voxel_keys::KeyHash> lut;
+
+    Voxel& at(int32_t cx, int32_t cy, int32_t cz, bool& isNew)
+    {
+        const auto [it, inserted] = lut.try_emplace(
+            Keys::pack({cx, cy, cz}), static_cast<uint32_t>(voxels.size()));
+        isNew = inserted;
+        if (inserted)
+        {
+            auto& v = voxels.emplace_back();
+            v.cx    = cx;
+            v.cy    = cy;
+            v.cz    = cz;
+        }
+        return voxels[it->second];
+    }
+};
+}  // namespace
+
+void FilterVoxelPyramid::Parameters::load_from_yaml(
+    const mrpt::containers::yaml& c, FilterVoxelPyramid& parent)
+{
+    MCP_LOAD_OPT(c, input_pointcloud_layer);
+    MCP_LOAD_OPT(c, output_layer_prefix);
+    DECLARE_PARAMETER_IN_REQ(c, voxel_filter_resolution, parent);
+    MCP_LOAD_OPT(c, num_levels);
+    MCP_LOAD_OPT(c, level_shift);
+    MCP_LOAD_OPT(c, decimate_method);
+
+    ASSERT_GE_(num_levels, 1U);
+    ASSERT_(
+        decimate_method == DecimateMethod::FirstPoint ||
+        decimate_method == DecimateMethod::VoxelAverage);
+}
+
+FilterVoxelPyramid::FilterVoxelPyramid()
+{
+    mrpt::system::COutputLogger::setLoggerName("FilterVoxelPyramid");
+}
+
+void FilterVoxelPyramid::initialize(const mrpt::containers::yaml& c)
+{
+    MRPT_START
+
+    MRPT_LOG_DEBUG_STREAM("Loading these params:\n" << c);
+    params_.load_from_yaml(c, *this);
+
+    MRPT_END
+}
+
+std::string FilterVoxelPyramid::output_layer_name(uint32_t level) const
+{
+    const double res = params_.voxel_filter_resolution *
+                       static_cast<double>(1U << (level * params_.level_shift));
+    return params_.output_layer_prefix + mrpt::format("%g", res);
+}
+
+void FilterVoxelPyramid::filter(mp2p_icp::metric_map_t& inOut) const
+{
+    MRPT_START
+
+    checkAllParametersAreRealized();
+
+    ASSERT_GT_(params_.voxel_filter_resolution, 0);
+    ASSERT_LT_(params_.level_shift * (params_.num_levels - 1), 31U);
+
+    const auto itLy = inOut.layers.find(params_.input_pointcloud_layer);
+    if (itLy == inOut.layers.end())
+    {
+        THROW_EXCEPTION_FMT(
+            "Input layer '%s' not found on input map.",
+            params_.input_pointcloud_layer.c_str());
+    }
+    const auto* pcPtr = mp2p_icp::MapToPointsMap(*itLy->second);
+    if (!pcPtr)
+    {
+        THROW_EXCEPTION_FMT(
+            "Layer '%s' must be of point cloud type.",
+            params_.input_pointcloud_layer.c_str());
+    }
+    const auto& pc = *pcPtr;
+
+    const auto& xs = pc.getPointsBufferRef_x();
+    const auto& ys = pc.getPointsBufferRef_y();
+    const auto& zs = pc.getPointsBufferRef_z();
+    ASSERT_LT_(xs.size(), std::numeric_limits<uint32_t>::max());
+
+    const bool average =
+        params_.decimate_method == DecimateMethod::VoxelAverage;
+    LinearVoxelKeys kp;
+    kp.mapping.setResolution(params_.voxel_filter_resolution);
+
+    std::vector<Level> levels(params_.num_levels);
+
+    // Finest level: the only one visiting all input points:
+    levels[0].voxels.reserve(xs.size() / 4);  // heuristic
+    levels[0].lut.reserve(xs.size() / 4);
+
+    bool isNew;
+    for (size_t i = 0; i < xs.size(); i++)
+    {
+        const VoxelIndices idx = kp.indices(xs[i], ys[i], zs[i]);
+
+        Voxel& v = levels[0].at(idx.cx_, idx.cy_, idx.cz_, isNew);
+        if (isNew) v.firstPoint = static_cast<uint32_t>(i);
+        v.count++;
+        if (average)
+        {
+            v.sumX += xs[i];
+            v.sumY += ys[i];
+            v.sumZ += zs[i];
+        }
+    }
+
+    // Coarser levels: reduce the voxels of the previous one.
+    // Arithmetic right shifts of (signed) voxel indices are floor divisions.
+    // Voxels are visited in order of first appearance, so the first child of
+    // each coarse voxel holds its first input point:
+    const uint32_t s = params_.level_shift;
+    for (size_t l = 1; l < levels.size(); l++)
+    {
+        levels[l].voxels.reserve(levels[l - 1].voxels.size());
+        levels[l].lut.reserve(levels[l - 1].voxels.size());
+
+        for (const Voxel& child : levels[l - 1].voxels)
+        {
+            Voxel& v = levels[l].at(
+                child.cx >> s, child.cy >> s, child.cz >> s, isNew);
+            if (isNew) v.firstPoint = child.firstPoint;
+            v.count += child.count;
+            v.sumX += child.sumX;
+            v.sumY += child.sumY;
+            v.sumZ += child.sumZ;
+        }
+    }
+
+    // Write output layers:
+    for (uint32_t l = 0; l < levels.size(); l++)
+    {
+        const auto& voxels = levels[l].voxels;
+
+        mrpt::maps::CPointsMap::Ptr outPc = GetOrCreatePointLayer(
+            inOut, output_layer_name(l),
+            /*do not allow empty*/
+            false,
+            /* create cloud of the same type */
+            pc.GetRuntimeClass()->className);
+
+        outPc->reserve(outPc->size() + voxels.size());
+
+        for (const Voxel& v : voxels)
+        {
+            if (average)
+            {
+                const float inv_n = 1.0f / static_cast<float>(v.count);
+                outPc->insertPointFast(
+                    v.sumX * inv_n, v.sumY * inv_n, v.sumZ * inv_n);
+            }
+            else
+            {
+                outPc->insertPointFrom(pc, v.firstPoint);
+            }
+        }
+        outPc->mark_as_modified();
+
+        MRPT_LOG_DEBUG_STREAM(
+            "Level #" << l << ": layer '" << output_layer_name(l)
+                      << "' voxels=" << voxels.size());
+    }
+
+    MRPT_END
+}
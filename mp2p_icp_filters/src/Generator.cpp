@@ -18,6 +18,7 @@
 #include <mrpt/containers/yaml.h>
 #include <mrpt/core/get_env.h>
 #include <mrpt/maps/CMultiMetricMap.h>
+#include <mrpt/maps/CPointsMapXYZI.h>
 #include <mrpt/maps/CPointsMapXYZIRT.h>
 #include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/obs/CObservation2DRangeScan.h>
@@ -27,7 +28,9 @@
 #include <mrpt/obs/CObservationVelodyneScan.h>
 #include <mrpt/obs/CSensoryFrame.h>
 #include <mrpt/system/filesystem.h>
+#include <mrpt/version.h>
 
+#include <algorithm>
 #include <filesystem>
 namespace fs = std::filesystem;
 
@@ -35,10 +38,114 @@ namespace fs = std::filesystem;
 #include <dlfcn.h>
 #endif
 
+#if defined(MP2P_HAS_TBB)
+#include <tbb/parallel_for.h>
+#endif
+
 IMPLEMENTS_MRPT_OBJECT(Generator, mrpt::rtti::CObject, mp2p_icp_filters)
 
 using namespace mp2p_icp_filters;
 
+namespace
+{
+/** Appends all points in "in" to "out", transformed by "pose" (if
+ * provided), in one single pass over presized output buffers, including the
+ * optional intensity, ring and timestamp channels.
+ *
+ * \return false if the class of "out" may have other per-point channels not
+ * handled here, hence the caller must fall back to insertAnotherMap().
+ */
+bool append_points(
+    mrpt::maps::CPointsMap& out, const mrpt::maps::CPointsMap& in,
+    const std::optional<mrpt::poses::CPose3D>& pose)
+{
+#if MRPT_VERSION >= 0x020b04
+    const auto* outClass = out.GetRuntimeClass();
+    if (outClass != CLASS_ID(mrpt::maps::CSimplePointsMap) &&
+        outClass != CLASS_ID(mrpt::maps::CPointsMapXYZI) &&
+        outClass != CLASS_ID(mrpt::maps::CPointsMapXYZIRT))
+        return false;
+
+    const auto&  xs = in.getPointsBufferRef_x();
+    const auto&  ys = in.getPointsBufferRef_y();
+    const auto&  zs = in.getPointsBufferRef_z();
+    const size_t n  = xs.size();
+    const size_t n0 = out.size();
+
+    out.resize(n0 + n);
+
+    // optional fields: keep all output channels with the same length than
+    // x,y,z, filling with zeros if the input does not have them:
+    const auto lambdaPrepareChannel = [&](auto* outCh, const auto* inCh)
+    {
+        const bool inHasData = inCh && inCh->size() == n && n != 0;
+        if (outCh && (inHasData || !outCh->empty())) outCh->resize(n0 + n, 0);
+        return (outCh && inHasData) ? inCh : nullptr;
+    };
+
+    auto* out_Is = out.getPointsBufferRef_intensity();
+    auto* out_Rs = out.getPointsBufferRef_ring();
+    auto* out_Ts = out.getPointsBufferRef_timestamp();
+
+    const auto* Is =
+        lambdaPrepareChannel(out_Is, in.getPointsBufferRef_intensity());
+    const auto* Rs = lambdaPrepareChannel(out_Rs, in.getPointsBufferRef_ring());
+    const auto* Ts =
+        lambdaPrepareChannel(out_Ts, in.getPointsBufferRef_timestamp());
+
+    if (Is) std::copy(Is->begin(), Is->end(), out_Is->begin() + n0);
+    if (Rs) std::copy(Rs->begin(), Rs->end(), out_Rs->begin() + n0);
+    if (Ts) std::copy(Ts->begin(), Ts->end(), out_Ts->begin() + n0);
+
+    if (!pose)
+    {
+        for (size_t i = 0; i < n; i++)
+            out.setPointFast(n0 + i, xs[i], ys[i], zs[i]);
+    }
+    else
+    {
+        // Use a float version of the SE(3) transformation:
+        const auto& R  = pose->getRotationMatrix();
+        const float r00 = static_cast<float>(R(0, 0)),
+                    r01 = static_cast<float>(R(0, 1)),
+                    r02 = static_cast<float>(R(0, 2)),
+                    r10 = static_cast<float>(R(1, 0)),
+                    r11 = static_cast<float>(R(1, 1)),
+                    r12 = static_cast<float>(R(1, 2)),
+                    r20 = static_cast<float>(R(2, 0)),
+                    r21 = static_cast<float>(R(2, 1)),
+                    r22 = static_cast<float>(R(2, 2));
+        const float tx = static_cast<float>(pose->x()),
+                    ty = static_cast<float>(pose->y()),
+                    tz = static_cast<float>(pose->z());
+
+#if defined(MP2P_HAS_TBB)
+        tbb::parallel_for(
+            static_cast<size_t>(0), n,
+            [&](size_t i)
+#else
+        for (size_t i = 0; i < n; i++)
+#endif
+            {
+                const float x = xs[i], y = ys[i], z = zs[i];
+                out.setPointFast(
+                    n0 + i, tx + r00 * x + r01 * y + r02 * z,
+                    ty + r10 * x + r11 * y + r12 * z,
+                    tz + r20 * x + r21 * y + r22 * z);
+            }
+#if defined(MP2P_HAS_TBB)
+        );
+#endif
+    }
+
+    out.mark_as_modified();
+    return true;
+#else
+    return false;
+#endif
+}
+}  // namespace
+
 Generator::Generator() : mrpt::system::COutputLogger("Generator") {}
 
 void Generator::Parameters::load_from_yaml(
@@ -130,6 +237,10 @@ void Generator::initialize(const mrpt::containers::yaml& c)
     process_class_names_regex_ = std::regex(params_.process_class_names_regex);
     process_sensor_labels_regex_ =
         std::regex(params_.process_sensor_labels_regex);
+    {
+        std::unique_lock lck(filterDecisionCache_.mtx);
+        filterDecisionCache_.decisions.clear();
+    }
 
     initialized_ = true;
     MRPT_END
@@ -167,6 +278,33 @@ bool Generator::process(
     MRPT_END
 }
 
+bool Generator::observationPassesFilters(const mrpt::obs::CObservation& o) const
+{
+    auto&      cache = filterDecisionCache_;
+    const auto cls   = o.GetRuntimeClass();
+
+    {
+        // Read-only lookup, safe with concurrent readers:
+        std::shared_lock lck(cache.mtx);
+        if (const auto itCls = cache.decisions.find(cls);
+            itCls != cache.decisions.end())
+        {
+            const auto& byLabel = itCls->second;
+            if (const auto it = byLabel.find(o.sensorLabel);
+                it != byLabel.end())
+                return it->second;
+        }
+    }
+
+    const bool pass =
+        std::regex_match(cls->className, process_class_names_regex_) &&
+        std::regex_match(o.sensorLabel, process_sensor_labels_regex_);
+
+    std::unique_lock lck(cache.mtx);
+    cache.decisions[cls].emplace(o.sensorLabel, pass);
+    return pass;
+}
+
 bool Generator::filterScan2D(  //
     [[maybe_unused]] const mrpt::obs::CObservation2DRangeScan&  pc,
     [[maybe_unused]] mp2p_icp::metric_map_t&                    out,
@@ -208,6 +346,11 @@ bool Generator::filterPointCloud(  //
     mp2p_icp::metric_map_t&                    out,
     const std::optional<mrpt::poses::CPose3D>& robotPose) const
 {
+    const mrpt::poses::CPose3D p =
+        robotPose ? robotPose.value() + sensorPose : sensorPose;
+
+    const bool isIdentity = (p == mrpt::poses::CPose3D::Identity());
+
     // Create if new: Append to existing layer, if already existed.
     mrpt::maps::CPointsMap::Ptr outPc;
     if (auto itLy = out.layers.find(params_.target_layer);
@@ -219,7 +362,31 @@ bool Generator::filterPointCloud(  //
                 "Layer '%s' must be of point cloud type.",
                 params_.target_layer.c_str());
     }
-    else
+
+    // Fast path: no transformation needed and no output layer yet: the new
+    // layer is a copy of the input cloud, made by its class copy constructor
+    // in one bulk copy of all its buffers. The input cloud is not shared,
+    // since later filters may modify the layer in place.
+    if (isIdentity && !outPc)
+    {
+        outPc = std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(
+            pc.duplicateGetSmartPtr());
+        ASSERT_(outPc);
+
+        MRPT_LOG_DEBUG_FMT(
+            "[filterPointCloud] Copied input cloud as new layer '%s' of type "
+            "'%s'",
+            params_.target_layer.c_str(), outPc->GetRuntimeClass()->className);
+
+        out.layers[params_.target_layer] = outPc;
+
+        const bool sanityPassed = mp2p_icp::pointcloud_sanity_check(*outPc);
+        ASSERT_(sanityPassed);
+
+        return true;
+    }
+
+    if (!outPc)
     {
         // Make a new layer of the same type than the input cloud:
         outPc = std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(
@@ -233,10 +400,14 @@ bool Generator::filterPointCloud(  //
         out.layers[params_.target_layer] = outPc;
     }
 
-    const mrpt::poses::CPose3D p =
-        robotPose ? robotPose.value() + sensorPose : sensorPose;
-
-    outPc->insertAnotherMap(&pc, p);
+    // Single pass transformation into presized buffers, or generic
+    // (slower) insertion for other point cloud classes:
+    if (!append_points(
+            *outPc, pc,
+            isIdentity ? std::nullopt : std::optional<mrpt::poses::CPose3D>(p)))
+    {
+        outPc->insertAnotherMap(&pc, p);
+    }
 
     const bool sanityPassed = mp2p_icp::pointcloud_sanity_check(*outPc);
     ASSERT_(sanityPassed);
@@ -307,6 +478,127 @@ bool mp2p_icp_filters::apply_generators(
     return anyHandled;
 }
 
+bool mp2p_icp_filters::apply_generators_per_sensor(
+    const GeneratorSet& generators, const mrpt::obs::CSensoryFrame& sf,
+    mp2p_icp::metric_map_t&                    output,
+    const std::optional<mrpt::poses::CPose3D>& robotPose)
+{
+    MRPT_START
+
+    ASSERT_(!generators.empty());
+
+#if defined(MP2P_HAS_TBB)
+    bool allGeneratePointClouds = true, allReentrant = true;
+    for (const auto& g : generators)
+    {
+        ASSERT_(g.get() != nullptr);
+        if (!g->params_.metric_map_definition_ini_file.empty() ||
+            !g->params_.metric_map_definition.empty())
+            allGeneratePointClouds = false;
+        if (!g->isReentrant()) allReentrant = false;
+    }
+
+    const size_t nObs = sf.size();
+    if (!allGeneratePointClouds || !allReentrant || nObs < 2)
+        return apply_generators(generators, sf, output, robotPose);
+
+    std::vector<mrpt::obs::CObservation::Ptr> observations;
+    observations.reserve(nObs);
+    for (const auto& obs : sf)
+    {
+        if (!obs) continue;
+        observations.push_back(obs);
+
+        // Evaluate the filter decisions before going multithread, so worker
+        // threads only find() them in the caches under a shared lock, and
+        // load lazy-load observations now, since load() is not thread safe:
+        bool passesAny = false;
+        for (const auto& g : generators)
+            passesAny = g->observationPassesFilters(*obs) || passesAny;
+        if (passesAny) obs->load();
+    }
+
+    std::vector<mp2p_icp::metric_map_t> partialMaps(observations.size());
+    std::vector<uint8_t>                handled(observations.size(), 0);
+
+    tbb::parallel_for(
+        static_cast<size_t>(0), observations.size(),
+        [&](size_t i)
+        {
+            for (const auto& g : generators)
+            {
+                if (g->process(*observations[i], partialMaps[i], robotPose))
+                    handled[i] = 1;
+            }
+        });
+
+    // Merge: first, count all new points per layer:
+    std::map<mp2p_icp::layer_name_t, size_t> newPointsPerLayer;
+    for (const auto& pm : partialMaps)
+    {
+        for (const auto& [name, layer] : pm.layers)
+        {
+            const auto* pc =
+                dynamic_cast<const mrpt::maps::CPointsMap*>(layer.get());
+            ASSERTMSG_(
+                pc, mrpt::format(
+                        "apply_generators_per_sensor(): layer '%s' is not a "
+                        "point cloud",
+                        name.c_str()));
+            newPointsPerLayer[name] += pc->size();
+        }
+    }
+
+    // Then, append in the SF order, with one reservation per layer:
+    for (auto& pm : partialMaps)
+    {
+        for (auto& [name, layer] : pm.layers)
+        {
+            auto pc = std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(layer);
+
+            auto itOut = output.layers.find(name);
+            if (itOut == output.layers.end())
+            {
+                // The first one is moved, not copied:
+                auto& nToReserve = newPointsPerLayer.at(name);
+                pc->reserve(nToReserve);
+                nToReserve = 0;
+
+                output.layers[name] = pc;
+                continue;
+            }
+
+            auto outPc = std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(
+                itOut->second);
+            ASSERTMSG_(
+                outPc, mrpt::format(
+                           "Layer '%s' must be of point cloud type.",
+                           name.c_str()));
+
+            if (auto& nToReserve = newPointsPerLayer.at(name); nToReserve != 0)
+            {
+                outPc->reserve(outPc->size() + nToReserve);
+                nToReserve = 0;
+            }
+
+            if (!append_points(*outPc, *pc, std::nullopt))
+            {
+                outPc->insertAnotherMap(
+                    pc.get(), mrpt::poses::CPose3D::Identity());
+            }
+        }
+        pm.layers.clear();
+    }
+
+    return std::any_of(
+        handled.begin(), handled.end(), [](uint8_t h) { return h != 0; });
+#else
+    return apply_generators(generators, sf, output, robotPose);
+#endif
+
+    MRPT_END
+}
+
 GeneratorSet mp2p_icp_filters::generators_from_yaml(
     const mrpt::containers::yaml& c, const mrpt::system::VerbosityLevel& vLevel)
 {
@@ -366,8 +658,7 @@ bool Generator::implProcessDefault(
     if (obsClassName == "mrpt::obs::CObservationComment"s ||
         obsClassName == "mrpt::obs::CObservationGPS"s ||
         obsClassName == "mrpt::obs::CObservationRobotPose"s ||
-        !std::regex_match(obsClassName, process_class_names_regex_) ||
-        !std::regex_match(o.sensorLabel, process_sensor_labels_regex_))
+        !observationPassesFilters(o))
     {
         MRPT_LOG_DEBUG_STREAM("Skipping this observation");
         return false;
@@ -417,15 +708,26 @@ bool Generator::implProcessDefault(
             dynamic_cast<const mrpt::obs::CObservation3DRangeScan*>(&o);
         obs3D && obs3D->points3D_x.empty())
     {
-        mrpt::maps::CSimplePointsMap tmpMap;
-
         mrpt::obs::T3DPointsProjectionParams pp;
         pp.takeIntoAccountSensorPoseOnRobot = true;
         pp.robotPoseInTheWorld              = robotPose;
-        const_cast<mrpt::obs::CObservation3DRangeScan*>(obs3D)->unprojectInto(
-            tmpMap, pp);
 
-        outPc->insertAnotherMap(&tmpMap, mrpt::poses::CPose3D::Identity());
+        auto* obs3DNonConst =
+            const_cast<mrpt::obs::CObservation3DRangeScan*>(obs3D);
+
+        // unprojectInto() overwrites the output cloud contents, so it can be
+        // used directly only if the output layer is still empty:
+        if (outPc->empty())
+        {
+            obs3DNonConst->unprojectInto(*outPc, pp);
+            return true;
+        }
+
+        mrpt::maps::CSimplePointsMap tmpMap;
+        obs3DNonConst->unprojectInto(tmpMap, pp);
+
+        if (!append_points(*outPc, tmpMap, std::nullopt))
+            outPc->insertAnotherMap(&tmpMap, mrpt::poses::CPose3D::Identity());
 
         return true;
     }
@@ -545,8 +847,7 @@ bool Generator::implProcessCustomMap(
 
     // user-given filters: Done *AFTER* creating the map, if needed.
     if (obsClassName == "mrpt::obs::CObservationComment"s ||
-        !std::regex_match(obsClassName, process_class_names_regex_) ||
-        !std::regex_match(o.sensorLabel, process_sensor_labels_regex_))
+        !observationPassesFilters(o))
     {
         MRPT_LOG_DEBUG_STREAM("Skipping this observation");
         return false;
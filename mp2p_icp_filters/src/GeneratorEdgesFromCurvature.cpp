@@ -51,18 +51,13 @@ bool GeneratorEdgesFromCurvature::process(
 
     checkAllParametersAreRealized();
 
-    const auto obsClassName = o.GetRuntimeClass()->className;
-
     // default: use point clouds:
     ASSERT_(params_.metric_map_definition_ini_file.empty());
 
     bool processed = false;
 
     // user-given filters: Done *AFTER* creating the map, if needed.
-    if (!std::regex_match(obsClassName, process_class_names_regex_))
-        return false;
-    if (!std::regex_match(o.sensorLabel, process_sensor_labels_regex_))
-        return false;
+    if (!observationPassesFilters(o)) return false;
 
     if (auto oRS = dynamic_cast<const CObservationRotatingScan*>(&o); oRS)
         processed = filterRotatingScan(*oRS, out, robotPose);
@@ -17,26 +17,48 @@
 
 using namespace mp2p_icp_filters;
 
-struct PointCloudToVoxelGrid::Impl
+template <class KeyPolicy>
+struct PointCloudToVoxelGridT<KeyPolicy>::Impl
 {
-    tsl::robin_map<indices_t, voxel_t, IndicesHash> pts_voxels;
+    tsl::robin_map<uint64_t, voxel_t, voxel_keys::KeyHash> pts_voxels;
+
+    /** Indices of voxels with far keys, which cannot be unpacked */
+    tsl::robin_map<uint64_t, indices_t, voxel_keys::KeyHash> far_indices;
+
+    void clear()
+    {
+        pts_voxels.clear();
+        far_indices.clear();
+    }
 };
 
-PointCloudToVoxelGrid::PointCloudToVoxelGrid() : impl_(mrpt::make_impl<Impl>())
+template <class KeyPolicy>
+PointCloudToVoxelGridT<KeyPolicy>::PointCloudToVoxelGridT()
+    : impl_(mrpt::make_impl<Impl>())
 {
 }
 
-void PointCloudToVoxelGrid::setResolution(const float voxel_size)
+template <class KeyPolicy>
+void PointCloudToVoxelGridT<KeyPolicy>::setResolution(const float voxel_size)
 {
     MRPT_START
 
-    impl_->pts_voxels.clear();
-    resolution_ = voxel_size;
+    impl_->clear();
+    key_policy_.mapping.setResolution(voxel_size);
 
     MRPT_END
 }
 
-void PointCloudToVoxelGrid::processPointCloud(const mrpt::maps::CPointsMap& p)
+template <class KeyPolicy>
+void PointCloudToVoxelGridT<KeyPolicy>::setKeyPolicy(const KeyPolicy& kp)
+{
+    impl_->clear();
+    key_policy_ = kp;
+}
+
+template <class KeyPolicy>
+void PointCloudToVoxelGridT<KeyPolicy>::processPointCloud(
+    const mrpt::maps::CPointsMap& p)
 {
     using mrpt::max3;
     using std::abs;
@@ -67,24 +89,42 @@ void PointCloudToVoxelGrid::processPointCloud(const mrpt::maps::CPointsMap& p)
         y0 = ys[i];
         z0 = zs[i];
 
-        const indices_t vxl_idx = {coord2idx(x0), coord2idx(y0), coord2idx(z0)};
+        const auto idx = key_policy_.indices(x0, y0, z0);
+        const auto key = KeyPolicy::pack(idx);
+        if (voxel_keys::is_far_key(key)) impl_->far_indices[key] = idx;
 
-        auto& cell = pts_voxels[vxl_idx];
-        cell.indices.push_back(i);  // only if not out of grid range
+        auto& cell = pts_voxels[key];
+        cell.indices.push_back(i);
     }
 }
 
-void PointCloudToVoxelGrid::clear()
+template <class KeyPolicy>
+void PointCloudToVoxelGridT<KeyPolicy>::clear()
 {
     //
-    impl_->pts_voxels.clear();
+    impl_->clear();
 }
 
-void PointCloudToVoxelGrid::visit_voxels(
+template <class KeyPolicy>
+void PointCloudToVoxelGridT<KeyPolicy>::visit_voxels(
     const std::function<void(const indices_t idx, const voxel_t& vxl)>&
         userCode) const
 {
-    for (const auto& [idx, vxl] : impl_->pts_voxels) userCode(idx, vxl);
+    for (const auto& [key, vxl] : impl_->pts_voxels)
+    {
+        userCode(
+            voxel_keys::is_far_key(key) ? impl_->far_indices.at(key)
+                                        : KeyPolicy::unpack(key),
+            vxl);
+    }
+}
+
+template <class KeyPolicy>
+size_t PointCloudToVoxelGridT<KeyPolicy>::size() const
+{
+    return impl_->pts_voxels.size();
 }
 
-size_t PointCloudToVoxelGrid::size() const { return impl_->pts_voxels.size(); }
+// Explicit instantiations:
+template class mp2p_icp_filters::PointCloudToVoxelGridT<LinearVoxelKeys>;
+template class mp2p_icp_filters::PointCloudToVoxelGridT<QuadraticVoxelKeys>;
@@ -11,14 +11,158 @@
  */
 
 #include <mp2p_icp_filters/PointCloudToVoxelGridSingle.h>
-// Used in the PIMP:
-#include <tsl/robin_map.h>
+#include <mrpt/core/exceptions.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#if defined(MP2P_HAS_TBB)
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
 
 using namespace mp2p_icp_filters;
 
+namespace
+{
+// Packed keys only use the lower 63 bits:
+constexpr uint64_t EMPTY_KEY = std::numeric_limits<uint64_t>::max();
+constexpr uint32_t NO_POINT  = std::numeric_limits<uint32_t>::max();
+
+// Minimum number of points inserted between table size checks:
+constexpr std::size_t MIN_CHUNK_POINTS = 1 << 16;
+
+// One voxel, 16 bytes. Fields are atomic so the table can be filled in
+// parallel without locks:
+struct Slot
+{
+    std::atomic<uint64_t> key{EMPTY_KEY};
+    /** Lowest global point index in the voxel (see Impl::sources) */
+    std::atomic<uint32_t> pointIdx{NO_POINT};
+    std::atomic<uint32_t> pointCount{0};
+};
+static_assert(sizeof(Slot) == 16);
+}  // namespace
+
+/** A flat open-addressing (linear probing) table of Slot's, with a
+ * power-of-two capacity of at least twice the number of voxels. */
 struct PointCloudToVoxelGridSingle::Impl
 {
-    tsl::robin_map<indices_t, voxel_t, IndicesHash> pts_voxels;
+    std::unique_ptr<Slot[]>  slots;
+    std::size_t              capacity = 0;
+    std::atomic<std::size_t> occupied{0};
+
+    /** Input clouds, and the global index of their first points */
+    std::vector<const mrpt::maps::CPointsMap*> sources;
+    std::vector<uint32_t>                      sourceOffsets;
+    uint32_t                                   totalPoints = 0;
+
+    Impl() = default;
+
+    // Deep copy, required by mrpt::pimpl:
+    Impl(const Impl& o)
+        : sources(o.sources),
+          sourceOffsets(o.sourceOffsets),
+          totalPoints(o.totalPoints)
+    {
+        if (o.capacity) allocate(o.capacity);
+        for (std::size_t i = 0; i < capacity; i++)
+        {
+            slots[i].key.store(o.slots[i].key.load());
+            slots[i].pointIdx.store(o.slots[i].pointIdx.load());
+            slots[i].pointCount.store(o.slots[i].pointCount.load());
+        }
+        occupied = o.occupied.load();
+    }
+
+    void allocate(std::size_t newCapacity)
+    {
+        slots.reset(new Slot[newCapacity]);
+        capacity = newCapacity;
+        occupied = 0;
+    }
+
+    // Empties all slots, keeping the allocated memory:
+    void reset_slots()
+    {
+        if (occupied == 0) return;
+        for (std::size_t i = 0; i < capacity; i++)
+        {
+            slots[i].key.store(EMPTY_KEY, std::memory_order_relaxed);
+            slots[i].pointIdx.store(NO_POINT, std::memory_order_relaxed);
+            slots[i].pointCount.store(0, std::memory_order_relaxed);
+        }
+        occupied = 0;
+    }
+
+    // Thread-safe, as long as there is no rehash() in the meanwhile:
+    void insert(uint64_t key, uint32_t globalPointIdx)
+    {
+        const std::size_t mask = capacity - 1;
+
+        std::size_t i = voxel_keys::mix_bits(key) & mask;
+        for (;; i = (i + 1) & mask)
+        {
+            uint64_t k = slots[i].key.load(std::memory_order_acquire);
+            if (k == EMPTY_KEY)
+            {
+                if (slots[i].key.compare_exchange_strong(
+                        k, key, std::memory_order_acq_rel))
+                {
+                    occupied.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+                // else: "k" now holds the key stored by another thread.
+            }
+            if (k == key) break;
+        }
+
+        Slot& s = slots[i];
+        s.pointCount.fetch_add(1, std::memory_order_relaxed);
+
+        // Keep the first point (lowest index) of each voxel:
+        uint32_t cur = s.pointIdx.load(std::memory_order_relaxed);
+        while (globalPointIdx < cur &&
+               !s.pointIdx.compare_exchange_weak(
+                   cur, globalPointIdx, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // Ensures room for "extraVoxels" more voxels:
+    void reserve(std::size_t extraVoxels)
+    {
+        const std::size_t needed = 2 * (occupied + extraVoxels);
+        if (needed <= capacity) return;
+
+        std::size_t newCapacity = std::max<std::size_t>(capacity, 64);
+        while (newCapacity < needed) newCapacity *= 2;
+
+        auto              oldSlots    = std::move(slots);
+        const std::size_t oldCapacity = capacity;
+        allocate(newCapacity);
+
+        for (std::size_t i = 0; i < oldCapacity; i++)
+        {
+            const Slot& o = oldSlots[i];
+            const auto  k = o.key.load(std::memory_order_relaxed);
+            if (k == EMPTY_KEY) continue;
+
+            const std::size_t mask = capacity - 1;
+            std::size_t       j    = voxel_keys::mix_bits(k) & mask;
+            while (slots[j].key.load(std::memory_order_relaxed) != EMPTY_KEY)
+                j = (j + 1) & mask;
+
+            Slot& n = slots[j];
+            n.key.store(k, std::memory_order_relaxed);
+            n.pointIdx.store(o.pointIdx.load(), std::memory_order_relaxed);
+            n.pointCount.store(o.pointCount.load(), std::memory_order_relaxed);
+            occupied++;
+        }
+    }
 };
 
 PointCloudToVoxelGridSingle::PointCloudToVoxelGridSingle()
@@ -30,8 +174,8 @@ void PointCloudToVoxelGridSingle::setResolution(const float voxel_size)
 {
     MRPT_START
 
-    impl_->pts_voxels.clear();
-    resolution_ = voxel_size;
+    clear();
+    key_policy_.mapping.setResolution(voxel_size);
 
     MRPT_END
 }
@@ -39,61 +183,130 @@ void PointCloudToVoxelGridSingle::setResolution(const float voxel_size)
 void PointCloudToVoxelGridSingle::processPointCloud(
     const mrpt::maps::CPointsMap& p)
 {
-    using mrpt::max3;
-    using std::abs;
+    MRPT_START
 
     const auto& xs   = p.getPointsBufferRef_x();
     const auto& ys   = p.getPointsBufferRef_y();
     const auto& zs   = p.getPointsBufferRef_z();
     const auto  npts = xs.size();
 
-    auto& pts_voxels = impl_->pts_voxels;
-
-    pts_voxels.reserve(pts_voxels.size() + npts);
+    auto& impl = *impl_;
 
-    for (std::size_t i = 0; i < npts; i++)
-    {
-        const auto x = xs[i];
-        const auto y = ys[i];
-        const auto z = zs[i];
+    ASSERT_LT_(
+        static_cast<uint64_t>(impl.totalPoints) + npts,
+        static_cast<uint64_t>(NO_POINT));
 
-        const indices_t vxl_idx = {coord2idx(x), coord2idx(y), coord2idx(z)};
+    const uint32_t offset = impl.totalPoints;
+    impl.sources.push_back(&p);
+    impl.sourceOffsets.push_back(offset);
+    impl.totalPoints += static_cast<uint32_t>(npts);
 
-        auto itVoxel = pts_voxels.find(vxl_idx);
+    // Insert points in chunks, growing the table before each one for its
+    // worst case (one new voxel per point). The table size follows the
+    // actual number of voxels, not the number of points. Chunks grow with
+    // the table, so the number of chunks stays small for dense clouds:
+    for (size_t chunkStart = 0; chunkStart < npts;)
+    {
+        const size_t chunkLen = std::min<size_t>(
+            npts - chunkStart,
+            std::max<size_t>(MIN_CHUNK_POINTS, impl.occupied));
+        const size_t chunkEnd = chunkStart + chunkLen;
 
-        if (itVoxel != pts_voxels.end())
-        {
-            // (const cast: required for tsl::robin_map)
-            auto& vx = const_cast<voxel_t&>(itVoxel->second);
+        impl.reserve(chunkLen);
 
-            if (vx.pointCount == 0)
-                vx = {mrpt::math::TPoint3Df(x, y, z), i, &p, 1};
-            else
-                vx.pointCount++;
-        }
-        else
-        {
-            // insert new
-            pts_voxels[vxl_idx] = {mrpt::math::TPoint3Df(x, y, z), i, &p, 1};
-        }
+#if defined(MP2P_HAS_TBB)
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(chunkStart, chunkEnd),
+            [&](const tbb::blocked_range<size_t>& r)
+            {
+                for (size_t i = r.begin(); i < r.end(); i++)
+                    impl.insert(
+                        key_policy_.key(xs[i], ys[i], zs[i]),
+                        offset + static_cast<uint32_t>(i));
+            });
+#else
+        for (size_t i = chunkStart; i < chunkEnd; i++)
+            impl.insert(
+                key_policy_.key(xs[i], ys[i], zs[i]),
+                offset + static_cast<uint32_t>(i));
+#endif
+        chunkStart = chunkEnd;
     }
+
+    MRPT_END
 }
 
 void PointCloudToVoxelGridSingle::clear()
 {
-    //
-    impl_->pts_voxels.min_load_factor(0.01f);
-    impl_->pts_voxels.clear();
+    auto& impl = *impl_;
+
+    // Keep the memory, to be reused by the next scan:
+    impl.reset_slots();
+
+    impl.sources.clear();
+    impl.sourceOffsets.clear();
+    impl.totalPoints = 0;
 }
 
 void PointCloudToVoxelGridSingle::visit_voxels(
     const std::function<void(const indices_t idx, const voxel_t& vxl)>&
         userCode) const
 {
-    for (const auto& [idx, vxl] : impl_->pts_voxels) userCode(idx, vxl);
-}
+    const auto& impl = *impl_;
 
-size_t PointCloudToVoxelGridSingle::size() const
-{
-    return impl_->pts_voxels.size();
+    const auto lambdaVisitSlot = [&](const Slot& s)
+    {
+        const auto k = s.key.load(std::memory_order_relaxed);
+        if (k == EMPTY_KEY) return;
+
+        const uint32_t globalIdx = s.pointIdx.load(std::memory_order_relaxed);
+
+        // Find the source cloud:
+        const auto itSrc = std::upper_bound(
+                               impl.sourceOffsets.begin(),
+                               impl.sourceOffsets.end(), globalIdx) -
+                           1;
+        const auto  srcIdx = std::distance(impl.sourceOffsets.begin(), itSrc);
+        const auto* src    = impl.sources[srcIdx];
+        const auto  ptIdx  = static_cast<size_t>(globalIdx - *itSrc);
+
+        voxel_t vxl;
+        const auto& pt = vxl.point.emplace(
+            src->getPointsBufferRef_x()[ptIdx],
+            src->getPointsBufferRef_y()[ptIdx],
+            src->getPointsBufferRef_z()[ptIdx]);
+        vxl.pointIdx   = ptIdx;
+        vxl.source     = src;
+        vxl.pointCount = s.pointCount.load(std::memory_order_relaxed);
+
+        // Far keys cannot be unpacked, but all points in a voxel have the
+        // same indices:
+        userCode(
+            voxel_keys::is_far_key(k) ? key_policy_.indices(pt.x, pt.y, pt.z)
+                                      : LinearVoxelKeys::unpack(k),
+            vxl);
+    };
+
+    // The slot of each voxel depends on the order in which threads inserted
+    // them, so always visit them sorted by their (unique) first point index,
+    // i.e. in the order of processPointCloud() calls and point indices. Users
+    // like FilterDecimateVoxels with `flatten_to` depend on this order.
+    std::vector<const Slot*> occupiedSlots;
+    occupiedSlots.reserve(impl.occupied);
+    for (std::size_t i = 0; i < impl.capacity; i++)
+    {
+        if (impl.slots[i].key.load(std::memory_order_relaxed) != EMPTY_KEY)
+            occupiedSlots.push_back(&impl.slots[i]);
+    }
+    std::sort(
+        occupiedSlots.begin(), occupiedSlots.end(),
+        [](const Slot* a, const Slot* b)
+        {
+            return a->pointIdx.load(std::memory_order_relaxed) <
+                   b->pointIdx.load(std::memory_order_relaxed);
+        });
+
+    for (const Slot* s : occupiedSlots) lambdaVisitSlot(*s);
 }
+
+size_t PointCloudToVoxelGridSingle::size() const { return impl_->occupied; }
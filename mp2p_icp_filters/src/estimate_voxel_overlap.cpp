@@ -0,0 +1,168 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   estimate_voxel_overlap.cpp
+ * @brief  Fast overlap estimation between two metric maps using voxels
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/estimate_voxel_overlap.h>
+#include <mp2p_icp_filters/voxel_keys.h>
+#include <mrpt/core/exceptions.h>
+
+#include <algorithm>
+#include <optional>
+
+#if defined(MP2P_HAS_TBB)
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#endif
+
+using namespace mp2p_icp_filters;
+
+namespace
+{
+LinearVoxelKeys make_voxel_keys(const VoxelOverlapParameters& p)
+{
+    ASSERT_GT_(p.voxel_size, 0.0f);
+
+    LinearVoxelKeys kp;
+    kp.mapping.setResolution(p.voxel_size);
+    return kp;
+}
+
+// Returns the sorted list of unique packed keys of occupied voxels:
+std::vector<uint64_t> occupied_voxels(
+    const mp2p_icp::metric_map_t&              m,
+    const std::optional<mrpt::poses::CPose3D>& pose,
+    const VoxelOverlapParameters&              p)
+{
+    const LinearVoxelKeys kp = make_voxel_keys(p);
+
+    std::vector<const mrpt::maps::CPointsMap*> pcs;
+
+    if (p.layers.empty())
+    {
+        for (const auto& [name, layer] : m.layers)
+        {
+            if (!layer) continue;
+            if (const auto* pc = mp2p_icp::MapToPointsMap(*layer); pc)
+                pcs.push_back(pc);
+        }
+    }
+    else
+    {
+        for (const auto& name : p.layers)
+        {
+            const auto it = m.layers.find(name);
+            if (it == m.layers.end() || !it->second) continue;
+            const auto* pc = mp2p_icp::MapToPointsMap(*it->second);
+            ASSERTMSG_(
+                pc, mrpt::format(
+                        "Layer '%s' cannot be converted into a point cloud",
+                        name.c_str()));
+            pcs.push_back(pc);
+        }
+    }
+
+    const std::size_t decim = std::max<uint32_t>(1, p.decimation);
+
+    std::size_t nTotal = 0;
+    for (const auto* pc : pcs) nTotal += (pc->size() + decim - 1) / decim;
+
+    std::vector<uint64_t> keys(nTotal);
+
+    std::size_t offset = 0;
+    for (const auto* pc : pcs)
+    {
+        const auto&       xs = pc->getPointsBufferRef_x();
+        const auto&       ys = pc->getPointsBufferRef_y();
+        const auto&       zs = pc->getPointsBufferRef_z();
+        const std::size_t n  = (xs.size() + decim - 1) / decim;
+
+#if defined(MP2P_HAS_TBB)
+        tbb::parallel_for(
+            static_cast<std::size_t>(0), n,
+            [&](std::size_t i)
+#else
+        for (std::size_t i = 0; i < n; i++)
+#endif
+            {
+                const std::size_t j = i * decim;
+
+                mrpt::math::TPoint3Df pt(xs[j], ys[j], zs[j]);
+                if (pose)
+                    pose->composePoint(xs[j], ys[j], zs[j], pt.x, pt.y, pt.z);
+
+                keys[offset + i] = kp.key(pt.x, pt.y, pt.z);
+            }
+#if defined(MP2P_HAS_TBB)
+        );
+#endif
+        offset += n;
+    }
+
+#if defined(MP2P_HAS_TBB)
+    tbb::parallel_sort(keys.begin(), keys.end());
+#else
+    std::sort(keys.begin(), keys.end());
+#endif
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    return keys;
+}
+}  // namespace
+
+VoxelOverlapIndex::VoxelOverlapIndex(
+    const mp2p_icp::metric_map_t& global, const VoxelOverlapParameters& params)
+    : params_(params), keys_(occupied_voxels(global, std::nullopt, params))
+{
+}
+
+bool VoxelOverlapIndex::contains(uint64_t key) const
+{
+    return std::binary_search(keys_.begin(), keys_.end(), key);
+}
+
+VoxelOverlapResult mp2p_icp_filters::estimate_voxel_overlap(
+    const mp2p_icp::metric_map_t& global, const mp2p_icp::metric_map_t& local,
+    const mrpt::poses::CPose3D&   localPose,
+    const VoxelOverlapParameters& params)
+{
+    MRPT_START
+
+    return estimate_voxel_overlap(
+        VoxelOverlapIndex(global, params), local, localPose);
+
+    MRPT_END
+}
+
+VoxelOverlapResult mp2p_icp_filters::estimate_voxel_overlap(
+    const VoxelOverlapIndex& global, const mp2p_icp::metric_map_t& local,
+    const mrpt::poses::CPose3D& localPose)
+{
+    MRPT_START
+
+    const auto localKeys =
+        occupied_voxels(local, localPose, global.parameters());
+
+    VoxelOverlapResult r;
+    r.globalVoxels = global.size();
+    r.localVoxels  = localKeys.size();
+
+    for (const uint64_t k : localKeys)
+        if (global.contains(k)) r.commonVoxels++;
+
+    if (r.localVoxels != 0)
+        r.overlap = static_cast<double>(r.commonVoxels) / r.localVoxels;
+
+    const std::size_t nUnion = r.globalVoxels + r.localVoxels - r.commonVoxels;
+    if (nUnion != 0) r.jaccard = static_cast<double>(r.commonVoxels) / nUnion;
+
+    return r;
+    MRPT_END
+}
@@ -15,6 +15,7 @@
  *
  */
 
+#include <mp2p_icp_filters/FilterAccumulateScans.h>
 #include <mp2p_icp_filters/FilterAdjustTimestamps.h>
 #include <mp2p_icp_filters/FilterBoundingBox.h>
 #include <mp2p_icp_filters/FilterByIntensity.h>
@@ -31,6 +32,8 @@
 #include <mp2p_icp_filters/FilterNormalizeIntensity.h>
 #include <mp2p_icp_filters/FilterPoleDetector.h>
 #include <mp2p_icp_filters/FilterRemoveByVoxelOccupancy.h>
+#include <mp2p_icp_filters/FilterRemoveDynamicPoints.h>
+#include <mp2p_icp_filters/FilterVoxelPyramid.h>
 #include <mp2p_icp_filters/FilterVoxelSlice.h>
 #include <mp2p_icp_filters/Generator.h>
 #include <mp2p_icp_filters/GeneratorEdgesFromCurvature.h>
@@ -47,6 +50,7 @@ MRPT_INITIALIZER(register_mola_lidar_segmentation)
     registerClass(CLASS_ID(mp2p_icp_filters::GeneratorEdgesFromCurvature));
 
     // Filters:
+    registerClass(CLASS_ID(mp2p_icp_filters::FilterAccumulateScans));
     registerClass(CLASS_ID(mp2p_icp_filters::FilterAdjustTimestamps));
     registerClass(CLASS_ID(mp2p_icp_filters::FilterBase));
     registerClass(CLASS_ID(mp2p_icp_filters::FilterBoundingBox));
@@ -64,5 +68,7 @@ MRPT_INITIALIZER(register_mola_lidar_segmentation)
     registerClass(CLASS_ID(mp2p_icp_filters::FilterNormalizeIntensity));
     registerClass(CLASS_ID(mp2p_icp_filters::FilterPoleDetector));
     registerClass(CLASS_ID(mp2p_icp_filters::FilterRemoveByVoxelOccupancy));
+    registerClass(CLASS_ID(mp2p_icp_filters::FilterRemoveDynamicPoints));
+    registerClass(CLASS_ID(mp2p_icp_filters::FilterVoxelPyramid));
     registerClass(CLASS_ID(mp2p_icp_filters::FilterVoxelSlice));
 }
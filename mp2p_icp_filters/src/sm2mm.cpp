@@ -18,14 +18,60 @@
 #include <mrpt/system/progress.h>
 #include <mrpt/version.h>
 
+#include <cmath>
 #include <iostream>
 
+bool mp2p_icp_filters::sm2mm_shard_t::contains(double x, double y) const
+{
+    ASSERT_GT_(tile_size, 0.0);
+
+    const double x0 = tile_x * tile_size - margin;
+    const double y0 = tile_y * tile_size - margin;
+    const double x1 = (tile_x + 1) * tile_size + margin;
+    const double y1 = (tile_y + 1) * tile_size + margin;
+
+    return x >= x0 && x < x1 && y >= y0 && y < y1;
+}
+
+std::pair<int32_t, int32_t> mp2p_icp_filters::sm2mm_shard_t::tile_of(
+    double x, double y, double tileSize)
+{
+    ASSERT_GT_(tileSize, 0.0);
+
+    return {
+        static_cast<int32_t>(std::floor(x / tileSize)),
+        static_cast<int32_t>(std::floor(y / tileSize))};
+}
+
+std::map<std::pair<int32_t, int32_t>, size_t>
+    mp2p_icp_filters::simplemap_shard_tiles(
+        const mrpt::maps::CSimpleMap& sm, double tileSize)
+{
+    std::map<std::pair<int32_t, int32_t>, size_t> tiles;
+
+    for (size_t i = 0; i < sm.size(); i++)
+    {
+#if MRPT_VERSION >= 0x020b05
+        const auto& [pose, sf, twist] = sm.get(i);
+#else
+        const auto& [pose, sf] = sm.get(i);
+#endif
+        ASSERT_(pose);
+        const auto p = pose->getMeanVal();
+        tiles[sm2mm_shard_t::tile_of(p.x(), p.y(), tileSize)]++;
+    }
+    return tiles;
+}
+
 void mp2p_icp_filters::simplemap_to_metricmap(
     const mrpt::maps::CSimpleMap& sm, mp2p_icp::metric_map_t& mm,
-    const mrpt::containers::yaml& yamlData, const sm2mm_options_t& options)
+    const mrpt::containers::yaml& yamlData, const sm2mm_options_t& options,
+    const mrpt::optional_ref<sm2mm_stats_t>& outStats)
 {
     mm.clear();
 
+    sm2mm_stats_t stats;
+
     // Generators:
     mp2p_icp_filters::GeneratorSet generators;
     if (yamlData.has("generators"))
@@ -126,6 +172,11 @@ void mp2p_icp_filters::simplemap_to_metricmap(
         ASSERT_(sf);
         const mrpt::poses::CPose3D robotPose = pose->getMeanVal();
 
+        // Not in our shard?
+        if (options.shard &&
+            !options.shard->contains(robotPose.x(), robotPose.y()))
+            continue;
+
         // Update pose variables:
         ps.updateVariables(
             {{"robot_x", robotPose.x()},
@@ -136,19 +187,32 @@ void mp2p_icp_filters::simplemap_to_metricmap(
              {"robot_roll", robotPose.roll()}});
         ps.realize();
 
-        for (const auto& obs : *sf)
+        if (options.parallel_sensors)
         {
-            ASSERT_(obs);
-            obs->load();
+            // All observations at once, then filter them together:
+            const bool handled = mp2p_icp_filters::apply_generators_per_sensor(
+                generators, *sf, mm, robotPose);
+
+            if (handled) mp2p_icp_filters::apply_filter_pipeline(filters, mm);
 
-            bool handled = mp2p_icp_filters::apply_generators(
-                generators, *obs, mm, robotPose);
+            for (const auto& obs : *sf) obs->unload();
+        }
+        else
+        {
+            for (const auto& obs : *sf)
+            {
+                ASSERT_(obs);
+                obs->load();
 
-            if (!handled) continue;
+                bool handled = mp2p_icp_filters::apply_generators(
+                    generators, *obs, mm, robotPose);
 
-            // process it:
-            mp2p_icp_filters::apply_filter_pipeline(filters, mm);
-            obs->unload();
+                if (!handled) continue;
+
+                // process it:
+                mp2p_icp_filters::apply_filter_pipeline(filters, mm);
+                obs->unload();
+            }
         }
 
 #if 0
@@ -165,6 +229,17 @@ void mp2p_icp_filters::simplemap_to_metricmap(
         }
 #endif
 
+        // Peak memory tracking:
+        if (outStats)
+        {
+            const size_t mem = mm.memory_footprint().total();
+            if (mem > stats.peakMemory)
+            {
+                stats.peakMemory         = mem;
+                stats.peakMemoryKeyframe = curKF;
+            }
+        }
+
         // progress bar:
         if (options.showProgressBar)
         {
@@ -196,4 +271,10 @@ void mp2p_icp_filters::simplemap_to_metricmap(
 
         std::cout << "Done with 'final_filters'." << std::endl;
     }
+
+    if (outStats)
+    {
+        mrpt::keep_max(stats.peakMemory, mm.memory_footprint().total());
+        outStats.value().get() = stats;
+    }
 }
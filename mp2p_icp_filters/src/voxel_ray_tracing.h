@@ -0,0 +1,61 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   voxel_ray_tracing.h
+ * @brief  Internal header: voxel traversal of rays
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace mp2p_icp_filters::internal
+{
+/** 3D Bresenham traversal of the voxels from "a" to "b", calling
+ * `visitor(x,y,z)` for all of them but "b" (the ray end point). */
+template <typename VISITOR>
+void trace_voxel_ray(
+    int32_t ax, int32_t ay, int32_t az, int32_t bx, int32_t by, int32_t bz,
+    VISITOR&& visitor)
+{
+    const int32_t d[3]  = {bx - ax, by - ay, bz - az};
+    const int32_t ad[3] = {std::abs(d[0]), std::abs(d[1]), std::abs(d[2])};
+    const int32_t s[3]  = {
+        d[0] < 0 ? -1 : 1, d[1] < 0 ? -1 : 1, d[2] < 0 ? -1 : 1};
+
+    // index of the dominant axis:
+    const int i0 = (ad[0] >= ad[1] && ad[0] >= ad[2]) ? 0
+                   : (ad[1] >= ad[2])                 ? 1
+                                                      : 2;
+    const int i1 = (i0 + 1) % 3, i2 = (i0 + 2) % 3;
+
+    int32_t c[3] = {ax, ay, az};
+    int32_t e1 = 2 * ad[i1] - ad[i0], e2 = 2 * ad[i2] - ad[i0];
+
+    for (int32_t k = 0; k < ad[i0]; k++)
+    {
+        visitor(c[0], c[1], c[2]);
+
+        if (e1 > 0)
+        {
+            c[i1] += s[i1];
+            e1 -= 2 * ad[i0];
+        }
+        if (e2 > 0)
+        {
+            c[i2] += s[i2];
+            e2 -= 2 * ad[i0];
+        }
+        e1 += 2 * ad[i1];
+        e2 += 2 * ad[i2];
+        c[i0] += s[i0];
+    }
+}
+
+}  // namespace mp2p_icp_filters::internal
@@ -0,0 +1,78 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ProfilerEntry.h
+ * @brief  Scoped time and heap allocation profiling
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mrpt/system/CTimeLogger.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace mp2p_icp
+{
+/** \addtogroup mp2p_icp_map_grp
+ * @{ */
+
+/** Number of heap allocations and requested bytes. */
+struct alloc_counters_t
+{
+    uint64_t allocs = 0;
+    uint64_t bytes  = 0;
+};
+
+/** Returns true if the library was built with `MP2PICP_ALLOC_PROFILING=ON`,
+ * hence the global `operator new` is replaced and heap allocations are
+ * counted. Otherwise, thread_alloc_counters() always returns zeros.
+ */
+bool alloc_counters_available();
+
+/** Returns the running count of heap allocations done by the calling thread
+ * since it started. \sa alloc_counters_available()
+ */
+alloc_counters_t thread_alloc_counters();
+
+/** A drop-in replacement of mrpt::system::CTimeLoggerEntry which, in
+ * addition to measuring the time of the scope, counts the heap allocations
+ * done within it by the calling thread, if alloc_counters_available().
+ *
+ * Counts are stored in the same mrpt::system::CTimeLogger as user measures
+ * named `<section>.allocs` and `<section>.alloc_bytes`, so they are reported
+ * alongside timings by `getStatsAsText()` and the like. Nothing is recorded
+ * if the profiler is disabled.
+ *
+ * Note that allocations done by other threads (e.g. TBB workers) on behalf
+ * of the scope are not accounted for.
+ */
+class ProfilerEntry
+{
+   public:
+    ProfilerEntry(
+        mrpt::system::CTimeLogger& profiler, const std::string_view& section);
+    ~ProfilerEntry();
+
+    ProfilerEntry(const ProfilerEntry&)            = delete;
+    ProfilerEntry& operator=(const ProfilerEntry&) = delete;
+
+    /** Ends the scope before the object is destroyed. */
+    void stop();
+
+   private:
+    mrpt::system::CTimeLoggerEntry tle_;
+    mrpt::system::CTimeLogger&     profiler_;
+    std::string                    section_;
+    alloc_counters_t               start_;
+    bool                           counting_ = false;
+};
+
+/** @} */
+
+}  // namespace mp2p_icp
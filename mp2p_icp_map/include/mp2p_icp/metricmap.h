@@ -22,11 +22,13 @@
 #include <mrpt/math/geometry.h>
 #include <mrpt/poses/CPose3DPDFGaussian.h>
 #include <mrpt/serialization/CSerializable.h>
+#include <mrpt/core/optional_ref.h>
 #include <mrpt/topography/data_types.h>
 
 #include <map>
 #include <memory>
 #include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -148,6 +150,95 @@ class metric_map_t : public mrpt::serialization::CSerializable,
      */
     bool load_from_file(const std::string& fileName);
 
+    /** Metadata of one layer, as stored in the layers directory of
+     * serialized metric_map_t objects (since serialization v5).
+     * \sa load_from_file(), layers_info()
+     */
+    struct layer_info_t
+    {
+        layer_name_t name;
+        std::string  className;  //!< e.g. "mrpt::maps::CSimplePointsMap"
+        std::string  description;  //!< CMetricMap::asString()
+        uint64_t     pointCount = 0;  //!< For point cloud layers
+        uint64_t     voxelCount = 0;  //!< For voxel map layers
+        /** Size of the layer in the file. 0 if unknown (e.g. old files). */
+        uint64_t serializedBytes = 0;
+    };
+
+    /** Returns the metadata of all layers currently in memory. */
+    std::vector<layer_info_t> layers_info() const;
+
+    /** Loads a metric_map_t object from a file, but only decoding the given
+     * subset of layers. Lines, planes, id, label and georeferencing are always
+     * loaded. Since serialization v5, layers not in the list are skipped
+     * without decoding them; with older files all layers are decoded, then
+     * unwanted ones are discarded.
+     *
+     * Note that `.mm` files are gzip-compressed, so skipped layers are still
+     * read and decompressed: what is saved is the memory and the time to
+     * build the layer objects, not the decompression time.
+     *
+     * \param layersToLoad Names of layers to load. Names not existing in the
+     *        file are silently ignored. An empty set means "no layer at all",
+     *        useful to only read the layers directory.
+     * \param outLayersInfo If provided, the metadata of all layers existing
+     *        in the file (loaded or not) will be stored here.
+     * \return true on success.
+     */
+    bool load_from_file(
+        const std::string& fileName, const std::set<layer_name_t>& layersToLoad,
+        const mrpt::optional_ref<std::vector<layer_info_t>>& outLayersInfo =
+            std::nullopt);
+
+    /** Builds the nearest-neighbor search indices (e.g. KD-trees) of all
+     * layers implementing mrpt::maps::NearestNeighborsCapable, so the first
+     * query (e.g. the first ICP::align() against this map) does not need to
+     * pay for it. Layers are processed in parallel, one thread per layer.
+     *
+     * Indices are built lazily anyway by the underlying map classes, so
+     * calling this is optional. It is useful right after load_from_file()
+     * for large maps used for localization.
+     *
+     * \note NN indices are not stored in `.mm` files, and are always rebuilt
+     * after loading a map. The KD-trees of MRPT point maps and the caches of
+     * voxel maps are private to those classes, with no API to export them or
+     * to restore a prebuilt one. Persisting them would need changes in MRPT
+     * first, so this method is the supported way to build them upfront.
+     */
+    void nn_prepare_for_queries() const;
+
+    /** Approximate RAM usage of a metric_map_t, in bytes, broken down by
+     * layer and component. \sa memory_footprint()
+     */
+    struct memory_footprint_t
+    {
+        struct layer_t
+        {
+            size_t points     = 0;  //!< x,y,z buffers (by capacity)
+            size_t attributes = 0;  //!< intensity, ring, timestamp, etc.
+            size_t other      = 0;  //!< Voxel maps
+            /** True for layer classes whose memory cannot be accounted for,
+             * which then count as 0 bytes. */
+            bool unknown = false;
+
+            size_t total() const { return points + attributes + other; }
+        };
+
+        std::map<layer_name_t, layer_t> layers;
+        size_t                          lines  = 0;
+        size_t                          planes = 0;
+
+        size_t      total() const;
+        std::string asString() const;  //!< Human-readable, one per line
+    };
+
+    /** Returns the approximate RAM usage of the map contents. Vector buffers
+     * are accounted by their capacity, not their size. Voxel maps report the
+     * memory of their underlying Bonxai grids. Other layer classes are marked
+     * as `unknown`. KD-tree indices of point clouds are not included, since
+     * they are built lazily and MRPT does not expose whether they exist. */
+    memory_footprint_t memory_footprint() const;
+
     /** Returns a shared_ptr to the given point cloud layer, or throws if
      *  the layer does not exist or it contains a different type of metric map
      * (e.g. if it is a gridmap).
@@ -0,0 +1,122 @@
+/* -------------------------------------------------------------------------
+ * A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   reproducibility.h
+ * @brief  Library-wide reproducibility mode and counter-based RNG streams
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace mp2p_icp
+{
+/** \addtogroup mp2p_icp_map_grp
+ * @{
+ */
+
+/** Returns whether the library-wide reproducibility mode is enabled.
+ *
+ * In this mode, all algorithms that draw random numbers and were not given
+ * an explicit seed use a fixed one (see REPRODUCIBLE_DEFAULT_SEED) instead
+ * of a time-based seed, so repeated runs over the same input produce
+ * identical outputs. Random draws are always done with CounterRNG streams,
+ * and parallel reductions are done in a fixed order, so results do not
+ * depend on the number of threads either.
+ *
+ * Its initial value is read from the environment variable
+ * `MP2P_ICP_REPRODUCIBLE` (Default=false).
+ */
+[[nodiscard]] bool reproducible_mode();
+
+/** Enables or disables the reproducibility mode. \sa reproducible_mode() */
+void set_reproducible_mode(bool enabled);
+
+/** Seed used instead of "0" (=unset) while in reproducible_mode(). */
+constexpr uint64_t REPRODUCIBLE_DEFAULT_SEED = 0x6d7032705f696370ULL;
+
+/** Returns `seed` if it is not zero. Otherwise, REPRODUCIBLE_DEFAULT_SEED if
+ * reproducible_mode() is enabled, or a time-based seed if it is not.
+ */
+[[nodiscard]] uint64_t resolve_random_seed(uint64_t seed);
+
+/** A stateless, counter-based random number generator (Philox4x32-10,
+ * Salmon et al., SC 2011).
+ *
+ * Each draw is a pure function of `(seed, stream, counter)`, so random
+ * numbers can be assigned to, e.g., point indices or voxel keys (the
+ * "stream") and drawn in any order or from any thread with identical
+ * results, unlike sequential engines whose output depends on how many
+ * numbers were drawn before.
+ */
+class CounterRNG
+{
+   public:
+    CounterRNG() = default;
+    explicit CounterRNG(uint64_t seed) : seed_(seed) {}
+
+    uint64_t seed() const { return seed_; }
+
+    /** Returns 64 random bits for the given stream and counter. */
+    uint64_t operator()(uint64_t stream, uint64_t counter = 0) const
+    {
+        const auto r = philox(
+            {static_cast<uint32_t>(counter),
+             static_cast<uint32_t>(counter >> 32),
+             static_cast<uint32_t>(stream),
+             static_cast<uint32_t>(stream >> 32)},
+            {static_cast<uint32_t>(seed_), static_cast<uint32_t>(seed_ >> 32)});
+
+        return (static_cast<uint64_t>(r[1]) << 32) | r[0];
+    }
+
+    /** Returns an integer in the range [0,n-1], n>0. */
+    std::size_t index(
+        std::size_t n, uint64_t stream, uint64_t counter = 0) const
+    {
+        return static_cast<std::size_t>((*this)(stream, counter) % n);
+    }
+
+    /** Returns a real number in the range [0,1). */
+    double uniform(uint64_t stream, uint64_t counter = 0) const
+    {
+        return static_cast<double>((*this)(stream, counter) >> 11) *
+               (1.0 / 9007199254740992.0);
+    }
+
+    using block_t = std::array<uint32_t, 4>;
+    using key_t   = std::array<uint32_t, 2>;
+
+    /** The Philox4x32 bijection with 10 rounds. */
+    static block_t philox(block_t ctr, key_t key)
+    {
+        for (int round = 0; round < 10; round++)
+        {
+            const uint64_t p0 = static_cast<uint64_t>(0xD2511F53U) * ctr[0];
+            const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57U) * ctr[2];
+
+            ctr = {
+                static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+                static_cast<uint32_t>(p1),
+                static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+                static_cast<uint32_t>(p0)};
+
+            key[0] += 0x9E3779B9U;
+            key[1] += 0xBB67AE85U;
+        }
+        return ctr;
+    }
+
+   private:
+    uint64_t seed_ = 0;
+};
+
+/** @} */
+
+}  // namespace mp2p_icp
@@ -0,0 +1,100 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ProfilerEntry.cpp
+ * @brief  Scoped time and heap allocation profiling
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/ProfilerEntry.h>
+
+#if defined(MP2P_ALLOC_PROFILING)
+#include <cstdlib>
+#include <new>
+#endif
+
+using namespace mp2p_icp;
+
+#if defined(MP2P_ALLOC_PROFILING)
+namespace
+{
+// Constant-initialized, so it is safe to use from operator new at any time:
+thread_local alloc_counters_t tlsAllocCounters;
+}  // namespace
+
+// Replacements of the global allocation functions. The array, nothrow and
+// sized variants are implemented by the standard library in terms of these.
+// Over-aligned variants are left untouched (hence, not counted).
+void* operator new(std::size_t n)
+{
+    tlsAllocCounters.allocs++;
+    tlsAllocCounters.bytes += n;
+
+    if (n == 0) n = 1;
+    for (;;)
+    {
+        if (void* p = std::malloc(n); p) return p;
+
+        auto handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#endif
+
+bool mp2p_icp::alloc_counters_available()
+{
+#if defined(MP2P_ALLOC_PROFILING)
+    return true;
+#else
+    return false;
+#endif
+}
+
+alloc_counters_t mp2p_icp::thread_alloc_counters()
+{
+#if defined(MP2P_ALLOC_PROFILING)
+    return tlsAllocCounters;
+#else
+    return {};
+#endif
+}
+
+ProfilerEntry::ProfilerEntry(
+    mrpt::system::CTimeLogger& profiler, const std::string_view& section)
+    : tle_(profiler, section), profiler_(profiler)
+{
+    counting_ = alloc_counters_available() && profiler_.isEnabled();
+    if (!counting_) return;
+
+    section_ = section;
+    start_   = thread_alloc_counters();
+}
+
+ProfilerEntry::~ProfilerEntry() { stop(); }
+
+void ProfilerEntry::stop()
+{
+    if (!counting_)
+    {
+        tle_.stop();
+        return;
+    }
+    counting_ = false;
+
+    const auto end = thread_alloc_counters();
+    tle_.stop();
+
+    profiler_.registerUserMeasure(
+        section_ + ".allocs", static_cast<double>(end.allocs - start_.allocs));
+    profiler_.registerUserMeasure(
+        section_ + ".alloc_bytes",
+        static_cast<double>(end.bytes - start_.bytes));
+}
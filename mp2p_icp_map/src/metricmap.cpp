@@ -13,6 +13,7 @@
 #include <mp2p_icp/metricmap.h>
 #include <mrpt/io/CFileGZInputStream.h>
 #include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/io/CMemoryStream.h>
 #include <mrpt/maps/CVoxelMap.h>
 #include <mrpt/maps/CVoxelMapRGB.h>
 #include <mrpt/math/CHistogram.h>
@@ -26,17 +27,69 @@
 #include <mrpt/serialization/optional_serialization.h>
 #include <mrpt/serialization/stl_serialization.h>
 #include <mrpt/system/string_utils.h>  // unitsFormat()
+#include <mrpt/version.h>
 
 #include <algorithm>
+#include <future>
 #include <iterator>
+#include <utility>  // exchange
 
 IMPLEMENTS_MRPT_OBJECT(
     metric_map_t, mrpt::serialization::CSerializable, mp2p_icp)
 
 using namespace mp2p_icp;
 
+namespace
+{
+metric_map_t::layer_info_t layer_info_from_map(
+    const layer_name_t& name, const mrpt::maps::CMetricMap& map)
+{
+    metric_map_t::layer_info_t li;
+    li.name        = name;
+    li.className   = map.GetRuntimeClass()->className;
+    li.description = map.asString();
+
+    if (auto pts = dynamic_cast<const mrpt::maps::CPointsMap*>(&map); pts)
+        li.pointCount = pts->size();
+    else if (auto vxs = dynamic_cast<const mrpt::maps::CVoxelMap*>(&map); vxs)
+        li.voxelCount = vxs->grid().activeCellsCount();
+
+    return li;
+}
+
+// Only used while loading a subset of layers, from load_from_file(). It is
+// passed down to serializeFrom() in a thread-local variable, so it is not part
+// of metric_map_t objects:
+struct LoadContext
+{
+    const std::set<layer_name_t>*           layersToLoad = nullptr;
+    std::vector<metric_map_t::layer_info_t> layersInfo;
+};
+thread_local LoadContext* currentLoadContext = nullptr;
+
+class ScopedLoadContext
+{
+   public:
+    explicit ScopedLoadContext(LoadContext& ctx) { currentLoadContext = &ctx; }
+    ~ScopedLoadContext() { currentLoadContext = nullptr; }
+};
+
+// Consumes (and discards) a number of bytes from an archive:
+void skip_bytes(mrpt::serialization::CArchive& in, uint64_t len)
+{
+    constexpr uint64_t   CHUNK = 1 << 20;
+    std::vector<uint8_t> buf(std::min(len, CHUNK));
+    while (len > 0)
+    {
+        const auto n = std::min(len, CHUNK);
+        in.ReadBuffer(buf.data(), n);
+        len -= n;
+    }
+}
+}  // namespace
+
 // Implementation of the CSerializable virtual interface:
-uint8_t metric_map_t::serializeGetVersion() const { return 4; }
+uint8_t metric_map_t::serializeGetVersion() const { return 5; }
 void    metric_map_t::serializeTo(mrpt::serialization::CArchive& out) const
 {
     out << lines;
@@ -47,8 +100,29 @@ void    metric_map_t::serializeTo(mrpt::serialization::CArchive& out) const
     out.WriteAs<uint32_t>(lines.size());
     for (const auto& l : lines) out << l;
 
+    // v5: layers directory, then each layer as a length-prefixed block so it
+    // can be skipped while loading without decoding it:
     out.WriteAs<uint32_t>(layers.size());
-    for (const auto& l : layers) out << l.first << *l.second.get();
+    for (const auto& l : layers)
+    {
+        const auto li = layer_info_from_map(l.first, *l.second);
+        out << li.name << li.className << li.description << li.pointCount
+            << li.voxelCount;
+    }
+
+    for (const auto& l : layers)
+    {
+        // Each layer is serialized once into memory, then written with its
+        // length prefix. .mm files are gzip streams, which cannot seek back
+        // to patch the prefix after writing the layer:
+        mrpt::io::CMemoryStream buf;
+        auto bufArch = mrpt::serialization::archiveFrom(buf);
+        bufArch << *l.second;
+
+        const uint64_t len = buf.getTotalBytesCount();
+        out.WriteAs<uint64_t>(len);
+        out.WriteBuffer(buf.getRawBufferData(), len);
+    }
 
     out << id << label;  // new in v1
 
@@ -68,6 +142,7 @@ void metric_map_t::serializeFrom(
         case 2:
         case 3:
         case 4:
+        case 5:
         {
             in >> lines;
             const auto nPls = in.ReadAs<uint32_t>();
@@ -80,12 +155,60 @@ void metric_map_t::serializeFrom(
 
             const auto nPts = in.ReadAs<uint32_t>();
             layers.clear();
-            for (std::size_t i = 0; i < nPts; i++)
+
+            // Taken, so nested objects being decoded do not see it:
+            LoadContext* const loadContext =
+                std::exchange(currentLoadContext, nullptr);
+
+            const auto lambdaWantLayer = [loadContext](const layer_name_t& name)
             {
-                std::string name;
-                in >> name;
-                layers[name] = mrpt::ptr_cast<mrpt::maps::CMetricMap>::from(
-                    in.ReadObject());
+                return !loadContext || !loadContext->layersToLoad ||
+                       loadContext->layersToLoad->count(name) != 0;
+            };
+
+            if (version >= 5)
+            {
+                // Layers directory:
+                std::vector<layer_info_t> dir(nPts);
+                for (auto& li : dir)
+                {
+                    in >> li.name >> li.className >> li.description >>
+                        li.pointCount >> li.voxelCount;
+                }
+                // Layers data:
+                for (auto& li : dir)
+                {
+                    li.serializedBytes = in.ReadAs<uint64_t>();
+                    if (lambdaWantLayer(li.name))
+                    {
+                        layers[li.name] =
+                            mrpt::ptr_cast<mrpt::maps::CMetricMap>::from(
+                                in.ReadObject());
+                    }
+                    else { skip_bytes(in, li.serializedBytes); }
+                }
+                if (loadContext) loadContext->layersInfo = std::move(dir);
+            }
+            else
+            {
+                std::vector<layer_info_t> dir;
+                for (std::size_t i = 0; i < nPts; i++)
+                {
+                    std::string name;
+                    in >> name;
+                    auto m = mrpt::ptr_cast<mrpt::maps::CMetricMap>::from(
+                        in.ReadObject());
+                    if (!loadContext)
+                    {
+                        layers[name] = std::move(m);
+                        continue;
+                    }
+                    // Old files do not have a directory: build it from the
+                    // decoded layers:
+                    dir.push_back(layer_info_from_map(name, *m));
+                    if (lambdaWantLayer(name)) layers[name] = std::move(m);
+                }
+                if (loadContext) loadContext->layersInfo = std::move(dir);
             }
 
             if (version >= 1) { in >> id >> label; }
@@ -586,6 +709,143 @@ bool metric_map_t::load_from_file(const std::string& fileName)
     return true;
 }
 
+bool metric_map_t::load_from_file(
+    const std::string& fileName, const std::set<layer_name_t>& layersToLoad,
+    const mrpt::optional_ref<std::vector<layer_info_t>>& outLayersInfo)
+{
+    auto f = mrpt::io::CFileGZInputStream(fileName);
+    if (!f.is_open()) return false;
+
+    LoadContext ctx;
+    ctx.layersToLoad = &layersToLoad;
+    {
+        const ScopedLoadContext scopedCtx(ctx);
+
+        auto arch = mrpt::serialization::archiveFrom(f);
+        arch >> *this;
+    }
+
+    if (outLayersInfo) outLayersInfo.value().get() = std::move(ctx.layersInfo);
+
+    return true;
+}
+
+std::vector<metric_map_t::layer_info_t> metric_map_t::layers_info() const
+{
+    std::vector<layer_info_t> ret;
+    for (const auto& [name, map] : layers)
+    {
+        ASSERT_(map);
+        ret.push_back(layer_info_from_map(name, *map));
+    }
+    return ret;
+}
+
+void metric_map_t::nn_prepare_for_queries() const
+{
+    MRPT_START
+
+    std::vector<std::future<void>> tasks;
+    for (const auto& [name, map] : layers)
+    {
+        if (!map) continue;
+        const auto* nn = MapToNN(*map, false /*dont throw*/);
+        if (!nn) continue;
+
+        tasks.emplace_back(std::async(
+            std::launch::async, [nn]() { nn->nn_prepare_for_3d_queries(); }));
+    }
+    // Wait for all, and re-throw exceptions, if any:
+    for (auto& t : tasks) t.get();
+
+    MRPT_END
+}
+
+metric_map_t::memory_footprint_t metric_map_t::memory_footprint() const
+{
+    using mrpt::maps::CPointsMap;
+
+    memory_footprint_t m;
+    m.lines  = lines.capacity() * sizeof(mrpt::math::TLine3D);
+    m.planes = planes.capacity() * sizeof(plane_patch_t);
+
+    for (const auto& [name, map] : layers)
+    {
+        auto& l = m.layers[name];
+        if (!map) continue;
+
+        if (auto pts = dynamic_cast<const CPointsMap*>(map.get()); pts)
+        {
+            l.points = (pts->getPointsBufferRef_x().capacity() +
+                        pts->getPointsBufferRef_y().capacity() +
+                        pts->getPointsBufferRef_z().capacity()) *
+                       sizeof(float);
+#if MRPT_VERSION >= 0x020b04
+            if (const auto* b = pts->getPointsBufferRef_intensity(); b)
+                l.attributes += b->capacity() * sizeof(float);
+            if (const auto* b = pts->getPointsBufferRef_ring(); b)
+                l.attributes += b->capacity() * sizeof(uint16_t);
+            if (const auto* b = pts->getPointsBufferRef_timestamp(); b)
+                l.attributes += b->capacity() * sizeof(float);
+#endif
+        }
+        else if (auto vxs = dynamic_cast<const mrpt::maps::CVoxelMap*>(
+                     map.get());
+                 vxs)
+        {
+            l.other = sizeof(*vxs) + vxs->grid().memUsage();
+        }
+        else if (auto vxc = dynamic_cast<const mrpt::maps::CVoxelMapRGB*>(
+                     map.get());
+                 vxc)
+        {
+            l.other = sizeof(*vxc) + vxc->grid().memUsage();
+        }
+        else
+        {
+            l.unknown = true;
+        }
+    }
+    return m;
+}
+
+size_t metric_map_t::memory_footprint_t::total() const
+{
+    size_t t = lines + planes;
+    for (const auto& [name, l] : layers) t += l.total();
+    return t;
+}
+
+std::string metric_map_t::memory_footprint_t::asString() const
+{
+    using mrpt::system::unitsFormat;
+    using namespace std::string_literals;
+
+    std::string s;
+    for (const auto& [name, l] : layers)
+    {
+        if (l.unknown)
+        {
+            s += mrpt::format(
+                "%-20s   unknown\n", ("'"s + name + "'").c_str());
+            continue;
+        }
+        s += mrpt::format(
+            "%-20s %9sB (points: %sB, attributes: %sB, other: %sB)\n",
+            ("'"s + name + "'").c_str(), unitsFormat(l.total()).c_str(),
+            unitsFormat(l.points).c_str(), unitsFormat(l.attributes).c_str(),
+            unitsFormat(l.other).c_str());
+    }
+    if (lines != 0 || planes != 0)
+    {
+        s += mrpt::format(
+            "%-20s %9sB\n%-20s %9sB\n", "lines", unitsFormat(lines).c_str(),
+            "planes", unitsFormat(planes).c_str());
+    }
+    s += mrpt::format("%-20s %9sB\n", "TOTAL", unitsFormat(total()).c_str());
+    return s;
+}
+
 metric_map_t::Ptr metric_map_t::get_shared_from_this()
 {
     try
@@ -0,0 +1,43 @@
+/* -------------------------------------------------------------------------
+ * A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   reproducibility.cpp
+ * @brief  Library-wide reproducibility mode and counter-based RNG streams
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/reproducibility.h>
+#include <mrpt/core/get_env.h>
+
+#include <atomic>
+#include <chrono>
+
+namespace
+{
+std::atomic_bool& reproducible_mode_flag()
+{
+    static std::atomic_bool flag =
+        mrpt::get_env<bool>("MP2P_ICP_REPRODUCIBLE", false);
+    return flag;
+}
+}  // namespace
+
+bool mp2p_icp::reproducible_mode() { return reproducible_mode_flag(); }
+
+void mp2p_icp::set_reproducible_mode(bool enabled)
+{
+    reproducible_mode_flag() = enabled;
+}
+
+uint64_t mp2p_icp::resolve_random_seed(uint64_t seed)
+{
+    if (seed != 0) return seed;
+    if (reproducible_mode()) return REPRODUCIBLE_DEFAULT_SEED;
+
+    return static_cast<uint64_t>(
+        std::chrono::system_clock::now().time_since_epoch().count());
+}
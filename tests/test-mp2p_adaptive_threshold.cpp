@@ -0,0 +1,154 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_adaptive_threshold.cpp
+ * @brief  Unit tests for KISS-ICP-like adaptive thresholds
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/AdaptiveThreshold.h>
+#include <mp2p_icp/Matcher_Points_DistanceThreshold.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+using mrpt::poses::CPose3D;
+
+void test_deviation()
+{
+    using mp2p_icp::AdaptiveThreshold;
+
+    // Pure translation:
+    ASSERT_NEAR_(
+        AdaptiveThreshold::deviation(CPose3D(0.3, 0.4, 0, 0, 0, 0), 50.0), 0.5,
+        1e-9);
+
+    // Pure rotation: chord of a point at the maximum range:
+    const double yaw = mrpt::DEG2RAD(2.0);
+    ASSERT_NEAR_(
+        AdaptiveThreshold::deviation(CPose3D(0, 0, 0, yaw, 0, 0), 50.0),
+        2 * 50.0 * std::sin(0.5 * yaw), 1e-9);
+}
+
+void test_model()
+{
+    mp2p_icp::AdaptiveThresholdParameters p;
+    p.initial_threshold     = 2.0;
+    p.min_motion            = 0.1;
+    p.min_threshold         = 0.05;
+    p.sigma_multiplier      = 3.0;
+    p.shrink_with_icp_steps = true;
+
+    mp2p_icp::AdaptiveThreshold at(p);
+    const CPose3D               guess(10.0, 0, 0, 0, 0, 0);
+
+    // No history yet:
+    ASSERT_(!at.sigma().has_value());
+    ASSERT_NEAR_(at.threshold(std::nullopt, 50.0), 2.0, 1e-9);
+
+    // Errors below "min_motion" are ignored:
+    at.update(guess, CPose3D(10.05, 0, 0, 0, 0, 0), 50.0);
+    ASSERT_EQUAL_(at.samples(), 0UL);
+
+    // sigma = RMS of deviations:
+    at.update(guess, CPose3D(10.3, 0, 0, 0, 0, 0), 50.0);
+    at.update(guess, CPose3D(10.0, 0.4, 0, 0, 0, 0), 50.0);
+    ASSERT_EQUAL_(at.samples(), 2UL);
+    ASSERT_NEAR_(*at.sigma(), std::sqrt((0.09 + 0.16) / 2), 1e-9);
+    ASSERT_NEAR_(at.threshold(std::nullopt, 50.0), 3 * *at.sigma(), 1e-9);
+
+    // Shrinks with small ICP steps, down to min_threshold:
+    const CPose3D smallStep(0.01, 0, 0, 0, 0, 0);
+    ASSERT_NEAR_(at.threshold(smallStep, 50.0), 0.05, 1e-9);
+
+    // ...but never grows with large steps:
+    const CPose3D largeStep(1.0, 0, 0, 0, 0, 0);
+    ASSERT_NEAR_(at.threshold(largeStep, 50.0), 3 * *at.sigma(), 1e-9);
+
+    // Sliding window:
+    at.reset();
+    at.params.window_length = 2;
+    at.update(guess, CPose3D(11.0, 0, 0, 0, 0, 0), 50.0);
+    at.update(guess, CPose3D(10.2, 0, 0, 0, 0, 0), 50.0);
+    at.update(guess, CPose3D(10.2, 0, 0, 0, 0, 0), 50.0);
+    ASSERT_EQUAL_(at.samples(), 2UL);
+    ASSERT_NEAR_(*at.sigma(), 0.2, 1e-9);
+}
+
+void test_matcher_persistence()
+{
+    auto glPts = mrpt::maps::CSimplePointsMap::Create();
+    auto lcPts = mrpt::maps::CSimplePointsMap::Create();
+    for (int i = 0; i < 20; i++)
+    {
+        glPts->insertPoint(i * 0.5f, 1.0f, 0);
+        lcPts->insertPoint(i * 0.5f, 1.0f, 0);
+    }
+
+    mp2p_icp::metric_map_t pcGlobal, pcLocal;
+    pcGlobal.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = glPts;
+    pcLocal.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW]  = lcPts;
+
+    const auto p = mrpt::containers::yaml::FromText(R"###(
+thresholdAngularDeg: 0.0
+adaptiveThreshold:
+  initial_threshold: 0.10
+  min_threshold: 0.01
+)###");
+
+    mp2p_icp::Matcher_Points_DistanceThreshold m;
+    m.initialize(p);
+    ASSERT_(m.adaptiveThreshold.has_value());
+
+    const auto lambdaMatch = [&](const CPose3D& pose)
+    {
+        mp2p_icp::Pairings   pairs;
+        mp2p_icp::MatchState ms(pcGlobal, pcLocal);
+        m.match(pcGlobal, pcLocal, pose, {}, ms, pairs);
+        return pairs.paired_pt2pt.size();
+    };
+
+    // 0.2 m away: out of the initial threshold:
+    const CPose3D guess(0.2, 0, 0, 0, 0, 0);
+    ASSERT_EQUAL_(lambdaMatch(guess), 0UL);
+
+    // After learning that guesses are ~0.2 m off, it finds pairings:
+    mp2p_icp::Results r;
+    r.optimal_tf.mean = CPose3D::Identity();
+    m.onAlignmentFinished(guess, r);
+
+    const auto* model = m.adaptiveThresholdModel("raw", "raw");
+    ASSERT_(model != nullptr);
+    ASSERT_EQUAL_(model->samples(), 1UL);
+    ASSERT_NEAR_(*model->sigma(), 0.2, 1e-6);
+
+    ASSERT_EQUAL_(lambdaMatch(guess), lcPts->size());
+
+    m.resetAdaptiveThresholds();
+    ASSERT_(m.adaptiveThresholdModel("raw", "raw") == nullptr);
+}
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_deviation();
+        test_model();
+        test_matcher_persistence();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,249 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_filter_accumulate_scans.cpp
+ * @brief  Unit tests for FilterAccumulateScans
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/Parameterizable.h>
+#include <mp2p_icp_filters/FilterAccumulateScans.h>
+#include <mp2p_icp_filters/FilterDecimateVoxels.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <array>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <utility>
+
+namespace
+{
+constexpr double   RESOLUTION = 0.25;
+constexpr uint32_t WINDOW_LENGTH = 4;
+constexpr size_t   NUM_SCANS = 10, POINTS_PER_SCAN = 5000;
+
+using voxel_idx_t = std::array<int, 3>;
+using voxels_t    = std::map<voxel_idx_t, mrpt::math::TPoint3D>;
+
+mrpt::poses::CPose3D scan_pose(size_t k)
+{
+    return mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+        0.6 * k, -0.3 * k, 0.05 * k, mrpt::DEG2RAD(7.0 * k),
+        mrpt::DEG2RAD(1.0 * k), mrpt::DEG2RAD(-2.0 * k));
+}
+
+// A scan in the vehicle frame, whose points in the odometry frame are close
+// to voxel centers, so voxel indices do not depend on round-off errors:
+mrpt::maps::CSimplePointsMap::Ptr make_scan(const mrpt::poses::CPose3D& pose)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+
+    const auto invPose = -pose;
+    const auto c       = pose.translation();
+
+    auto pc = mrpt::maps::CSimplePointsMap::Create();
+    for (size_t i = 0; i < POINTS_PER_SCAN; i++)
+    {
+        double g[3];
+        for (int k = 0; k < 3; k++)
+        {
+            const int  half = k == 2 ? 4 : 16;
+            const int  base = static_cast<int>(std::floor(c[k] / RESOLUTION));
+            const auto r    = rng.drawUniform32bit() % (2 * half);
+            const int  idx  = base + static_cast<int>(r) - half;
+            g[k] = (idx + 0.5 + rng.drawUniform(-0.3, 0.3)) * RESOLUTION;
+        }
+        double lx, ly, lz;
+        invPose.composePoint(g[0], g[1], g[2], lx, ly, lz);
+        pc->insertPoint(lx, ly, lz);
+    }
+    return pc;
+}
+
+voxel_idx_t voxel_of(const mrpt::math::TPoint3D& p)
+{
+    return {
+        static_cast<int>(std::floor(p.x / RESOLUTION)),
+        static_cast<int>(std::floor(p.y / RESOLUTION)),
+        static_cast<int>(std::floor(p.z / RESOLUTION))};
+}
+
+// The filter output, back in the odometry frame:
+voxels_t output_voxels(
+    const mp2p_icp::metric_map_t& m, const mrpt::poses::CPose3D& pose)
+{
+    const auto pc = m.point_layer("accumulated");
+    ASSERT_(pc);
+
+    voxels_t voxels;
+    for (size_t i = 0; i < pc->size(); i++)
+    {
+        float x, y, z;
+        pc->getPoint(i, x, y, z);
+        const auto g = pose.composePoint(mrpt::math::TPoint3D(x, y, z));
+
+        const bool isNew = voxels.emplace(voxel_of(g), g).second;
+        ASSERT_(isNew);
+    }
+    return voxels;
+}
+
+// Reference: voxel averages of the given scans in the odometry frame, by
+// FilterDecimateVoxels:
+voxels_t expected_voxels(
+    const std::deque<std::pair<mrpt::maps::CSimplePointsMap::Ptr,
+                               mrpt::poses::CPose3D>>& scans)
+{
+    auto all = mrpt::maps::CSimplePointsMap::Create();
+    for (const auto& [pc, pose] : scans)
+    {
+        for (size_t i = 0; i < pc->size(); i++)
+        {
+            float x, y, z;
+            pc->getPoint(i, x, y, z);
+            double gx, gy, gz;
+            pose.composePoint(x, y, z, gx, gy, gz);
+            all->insertPoint(gx, gy, gz);
+        }
+    }
+    mp2p_icp::metric_map_t m;
+    m.layers["all"] = all;
+
+    mp2p_icp_filters::FilterDecimateVoxels decim;
+    decim.initialize(mrpt::containers::yaml::FromText(mrpt::format(
+        "input_pointcloud_layer: ['all']\n"
+        "output_pointcloud_layer: 'decimated'\n"
+        "voxel_filter_resolution: %f\n"
+        "decimate_method: DecimateMethod::VoxelAverage\n",
+        RESOLUTION)));
+    decim.filter(m);
+
+    const auto pc = m.point_layer("decimated");
+    ASSERT_(pc);
+
+    voxels_t voxels;
+    for (size_t i = 0; i < pc->size(); i++)
+    {
+        float x, y, z;
+        pc->getPoint(i, x, y, z);
+        const auto p = mrpt::math::TPoint3D(x, y, z);
+        voxels.emplace(voxel_of(p), p);
+    }
+    return voxels;
+}
+
+void compare(const voxels_t& out, const voxels_t& expected)
+{
+    ASSERT_EQUAL_(out.size(), expected.size());
+    for (const auto& [idx, p] : out)
+    {
+        const auto it = expected.find(idx);
+        ASSERT_(it != expected.end());
+        // Float vs double sums, and the round trip to the vehicle frame:
+        ASSERT_NEAR_(p.x, it->second.x, 1e-3);
+        ASSERT_NEAR_(p.y, it->second.y, 1e-3);
+        ASSERT_NEAR_(p.z, it->second.z, 1e-3);
+    }
+}
+
+void test_accumulate_scans()
+{
+    mrpt::random::getRandomGenerator().randomize(1234);
+
+    mp2p_icp_filters::FilterAccumulateScans f;
+    f.initialize(mrpt::containers::yaml::FromText(mrpt::format(
+        "input_pointcloud_layer: 'scan'\n"
+        "output_pointcloud_layer: 'accumulated'\n"
+        "window_length: %u\n"
+        "voxel_filter_resolution: %f\n"
+        "robot_pose: [robot_x, robot_y, robot_z, robot_yaw, robot_pitch, "
+        "robot_roll]\n",
+        static_cast<unsigned>(WINDOW_LENGTH), RESOLUTION)));
+
+    mp2p_icp::ParameterSource ps;
+    ps.attach(f);
+
+    const auto process = [&](const mrpt::maps::CSimplePointsMap::Ptr& scan,
+                             const mrpt::poses::CPose3D&              pose) {
+        ps.updateVariable("robot_x", pose.x());
+        ps.updateVariable("robot_y", pose.y());
+        ps.updateVariable("robot_z", pose.z());
+        ps.updateVariable("robot_yaw", pose.yaw());
+        ps.updateVariable("robot_pitch", pose.pitch());
+        ps.updateVariable("robot_roll", pose.roll());
+        ps.realize();
+
+        mp2p_icp::metric_map_t m;
+        m.layers["scan"] = scan;
+        f.filter(m);
+        return output_voxels(m, pose);
+    };
+
+    ASSERT_EQUAL_(f.scanCount(), 0U);
+
+    std::deque<std::pair<mrpt::maps::CSimplePointsMap::Ptr,
+                         mrpt::poses::CPose3D>>
+        window;
+
+    for (size_t k = 0; k < NUM_SCANS; k++)
+    {
+        const auto pose = scan_pose(k);
+        const auto scan = make_scan(pose);
+
+        window.emplace_back(scan, pose);
+        if (window.size() > WINDOW_LENGTH) window.pop_front();
+
+        const auto out = process(scan, pose);
+
+        ASSERT_EQUAL_(f.scanCount(), window.size());
+        compare(out, expected_voxels(window));
+
+        std::cout << "AccumulateScans scan #" << k << ": " << out.size()
+                  << " voxels, OK\n";
+    }
+
+    // After reset(), only new scans are accumulated:
+    f.reset();
+    ASSERT_EQUAL_(f.scanCount(), 0U);
+
+    const auto pose = scan_pose(NUM_SCANS);
+    const auto scan = make_scan(pose);
+
+    window.clear();
+    window.emplace_back(scan, pose);
+
+    const auto out = process(scan, pose);
+
+    ASSERT_EQUAL_(f.scanCount(), 1U);
+    compare(out, expected_voxels(window));
+
+    std::cout << "AccumulateScans after reset(): " << out.size()
+              << " voxels, OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_accumulate_scans();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
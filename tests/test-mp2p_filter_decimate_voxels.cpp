@@ -0,0 +1,162 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_filter_decimate_voxels.cpp
+ * @brief  Unit tests for FilterDecimateVoxels
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/FilterDecimateVoxels.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace
+{
+using points_t = std::vector<mrpt::math::TPoint3Df>;
+
+// A cloud with several points per voxel, in random order, around the origin
+// so negative coordinates are also tested:
+mrpt::maps::CSimplePointsMap::Ptr random_cloud(size_t n, uint32_t seed)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(seed);
+
+    auto pc = mrpt::maps::CSimplePointsMap::Create();
+    for (size_t i = 0; i < n; i++)
+    {
+        pc->insertPointFast(
+            rng.drawUniform<float>(-20.0f, 20.0f),
+            rng.drawUniform<float>(-20.0f, 20.0f),
+            rng.drawUniform<float>(-2.0f, 2.0f));
+    }
+    pc->mark_as_modified();
+    return pc;
+}
+
+// The reference FirstPoint decimation: scan all points in order, keep the
+// first one of each voxel and, if flattening, the first voxel of each (x,y)
+// cell:
+points_t reference_first_point(
+    const std::vector<const mrpt::maps::CPointsMap*>& clouds,
+    float resolution, std::optional<float> flattenTo)
+{
+    const float inv_res = 1.0f / resolution;
+    const auto  idx     = [inv_res](float v)
+    { return static_cast<int32_t>(std::floor(v * inv_res)); };
+
+    std::set<std::array<int32_t, 3>> usedVoxels;
+    std::set<std::array<int32_t, 2>> usedBins;
+    points_t                         out;
+
+    for (const auto* pc : clouds)
+    {
+        const auto& xs = pc->getPointsBufferRef_x();
+        const auto& ys = pc->getPointsBufferRef_y();
+        const auto& zs = pc->getPointsBufferRef_z();
+        for (size_t i = 0; i < xs.size(); i++)
+        {
+            const int32_t cx = idx(xs[i]), cy = idx(ys[i]), cz = idx(zs[i]);
+            if (!usedVoxels.insert({cx, cy, cz}).second) continue;
+
+            if (flattenTo)
+            {
+                if (!usedBins.insert({cx, cy}).second) continue;
+                out.emplace_back(xs[i], ys[i], *flattenTo);
+            }
+            else { out.emplace_back(xs[i], ys[i], zs[i]); }
+        }
+    }
+    return out;
+}
+
+points_t run_filter(
+    const mp2p_icp::metric_map_t& in, const std::string& inputLayers,
+    const std::string& extraParams)
+{
+    const auto params = mrpt::containers::yaml::FromText(
+        "input_pointcloud_layer: " + inputLayers +
+        "\n"
+        "output_pointcloud_layer: 'decimated'\n"
+        "voxel_filter_resolution: 0.5\n"
+        "decimate_method: DecimateMethod::FirstPoint\n" +
+        extraParams);
+
+    mp2p_icp_filters::FilterDecimateVoxels f;
+    f.initialize(params);
+
+    mp2p_icp::metric_map_t m = in;
+    f.filter(m);
+
+    const auto pc = m.point_layer("decimated");
+    ASSERT_(pc);
+
+    points_t out;
+    for (size_t i = 0; i < pc->size(); i++)
+    {
+        float x, y, z;
+        pc->getPoint(i, x, y, z);
+        out.emplace_back(x, y, z);
+    }
+    return out;
+}
+
+void test_first_point(bool flatten)
+{
+    const auto pc1 = random_cloud(100'000, 123);
+    const auto pc2 = random_cloud(50'000, 456);
+
+    mp2p_icp::metric_map_t in;
+    in.layers["a"] = pc1;
+    in.layers["b"] = pc2;
+
+    const std::optional<float> flattenTo =
+        flatten ? std::optional<float>(1.5f) : std::nullopt;
+    const std::string extraParams =
+        flatten ? std::string("flatten_to: 1.5\n") : std::string();
+
+    const auto expected =
+        reference_first_point({pc1.get(), pc2.get()}, 0.5f, flattenTo);
+
+    // Repeat, since the voxel table is filled in parallel:
+    for (int rep = 0; rep < 5; rep++)
+    {
+        const auto out = run_filter(in, "['a', 'b']", extraParams);
+
+        ASSERT_EQUAL_(out.size(), expected.size());
+        for (size_t i = 0; i < out.size(); i++)
+            ASSERT_(out[i] == expected[i]);
+    }
+
+    std::cout << "FirstPoint decimation" << (flatten ? " (flatten_to)" : "")
+              << ": " << expected.size() << " points, OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_first_point(false);
+        test_first_point(true);
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,250 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_filter_merge_voxels.cpp
+ * @brief  Unit tests for FilterMerge parallel insertion into CVoxelMap
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/FilterMerge.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/maps/CVoxelMap.h>
+
+#include <iostream>
+#include <vector>
+
+namespace
+{
+using voxel_grid_t = Bonxai::VoxelGrid<mrpt::maps::CVoxelMap::voxel_node_t>;
+
+void merge_into(
+    mp2p_icp::metric_map_t& m, const mrpt::math::TPoint3D& sensor,
+    bool parallel)
+{
+    mp2p_icp_filters::FilterMerge f;
+    f.initialize(mrpt::containers::yaml::FromText(mrpt::format(
+        "input_pointcloud_layer: 'scan'\n"
+        "target_layer: 'voxels'\n"
+        "robot_pose: [%f, %f, %f, 0, 0, 0]\n"
+        "parallel_voxel_insertion: %s\n",
+        sensor.x, sensor.y, sensor.z, parallel ? "true" : "false")));
+    f.filter(m);
+}
+
+voxel_grid_t& grid_of(const mp2p_icp::metric_map_t& m)
+{
+    const auto vm =
+        std::dynamic_pointer_cast<mrpt::maps::CVoxelMap>(m.layers.at("voxels"));
+    ASSERT_(vm);
+    return const_cast<voxel_grid_t&>(vm->grid());
+}
+
+// Repeated observations of the same voxels must give the same log-odds than
+// one CVoxelMap::updateVoxel() call per observation, including clamping:
+void test_aggregated_updates()
+{
+    constexpr double res = 0.1;
+
+    for (const size_t n : {1UL, 2UL, 5UL, 50UL, 300UL})
+    {
+        // n points in the same voxel (10,0,0), seen from voxel (0,0,0):
+        auto scan = mrpt::maps::CSimplePointsMap::Create();
+        for (size_t i = 0; i < n; i++) scan->insertPoint(1.05f, 0.05f, 0.05f);
+
+        mp2p_icp::metric_map_t m;
+        m.layers["scan"]   = scan;
+        m.layers["voxels"] = mrpt::maps::CVoxelMap::Create(res);
+        merge_into(m, {0.05, 0.05, 0.05}, true);
+
+        mrpt::maps::CVoxelMap ref(res);
+        for (size_t i = 0; i < n; i++)
+        {
+            for (int x = 0; x < 10; x++)
+                ref.updateVoxel((x + 0.5) * res, 0.05, 0.05, false);
+            ref.updateVoxel(1.05, 0.05, 0.05, true);
+        }
+
+        auto& g      = grid_of(m);
+        auto  acc    = g.createAccessor();
+        auto& gRef   = const_cast<voxel_grid_t&>(ref.grid());
+        auto  accRef = gRef.createAccessor();
+
+        ASSERT_EQUAL_(g.activeCellsCount(), gRef.activeCellsCount());
+        for (int x = 0; x <= 10; x++)
+        {
+            const auto* c    = acc.value(Bonxai::CoordT{x, 0, 0});
+            const auto* cRef = accRef.value(Bonxai::CoordT{x, 0, 0});
+            ASSERT_(c && cRef);
+            ASSERT_EQUAL_(c->occupancy, cRef->occupancy);
+        }
+    }
+
+    std::cout << "Aggregated voxel updates: OK\n";
+}
+
+// A room with walls and floor:
+mrpt::maps::CSimplePointsMap::Ptr room_points()
+{
+    auto pc = mrpt::maps::CSimplePointsMap::Create();
+    for (int i = -50; i < 50; i++)
+    {
+        const float a = i * 0.1f + 0.05f;
+        for (int k = 0; k < 30; k++)
+        {
+            const float z = k * 0.1f + 0.05f;
+            pc->insertPoint(a, -4.95f, z);
+            pc->insertPoint(a, 4.95f, z);
+            pc->insertPoint(-4.95f, a, z);
+            pc->insertPoint(4.95f, a, z);
+        }
+        for (int j = -50; j < 50; j++)
+            pc->insertPoint(a, j * 0.1f + 0.05f, 0.05f);
+    }
+    return pc;
+}
+
+// The parallel path must classify voxels as the serial insertObservation()
+// one. Rays are traced with different algorithms, so a few voxels may differ:
+void test_same_as_serial()
+{
+    const auto scan = room_points();
+
+    mp2p_icp::metric_map_t serial, parallel;
+    serial.layers["scan"]     = scan;
+    serial.layers["voxels"]   = mrpt::maps::CVoxelMap::Create(0.2);
+    parallel.layers["scan"]   = scan;
+    parallel.layers["voxels"] = mrpt::maps::CVoxelMap::Create(0.2);
+
+    for (const auto& sensor : std::vector<mrpt::math::TPoint3D>{
+             {0.0, 0.0, 1.0}, {1.0, 0.5, 1.0}, {-1.5, -1.0, 1.2}})
+    {
+        merge_into(serial, sensor, false);
+        merge_into(parallel, sensor, true);
+    }
+
+    auto accSerial = grid_of(serial).createAccessor();
+
+    size_t nCompared = 0, nAgree = 0;
+    grid_of(parallel).forEachCell(
+        [&](mrpt::maps::CVoxelMap::voxel_node_t& data,
+            const Bonxai::CoordT&                coord)
+        {
+            const auto* c = accSerial.value(coord);
+            if (!c || c->occupancy == 0 || data.occupancy == 0) return;
+
+            nCompared++;
+            if ((c->occupancy > 0) == (data.occupancy > 0)) nAgree++;
+        });
+
+    ASSERT_GT_(nCompared, 10'000UL);
+    ASSERT_GT_(static_cast<double>(nAgree) / nCompared, 0.95);
+
+    std::cout << "Parallel vs serial voxel insertion: " << nAgree << "/"
+              << nCompared << " voxels agree, OK\n";
+}
+
+// Non-default insertion options: decimation, max_range and log-odds
+// probabilities are honored by the parallel path:
+void test_insertion_options()
+{
+    constexpr double res = 0.1;
+
+    const auto lambdaSetOptions = [](mrpt::maps::CVoxelMap& vm)
+    {
+        auto& io      = vm.insertionOptions;
+        io.decimation = 2;
+        io.max_range  = 2.0;
+        io.prob_hit   = 0.8;
+        io.prob_miss  = 0.3;
+    };
+
+    // 5 points in voxel (10,0,0), then 3 in voxel (30,0,0), out of range:
+    auto scan = mrpt::maps::CSimplePointsMap::Create();
+    for (int i = 0; i < 5; i++) scan->insertPoint(1.05f, 0.05f, 0.05f);
+    for (int i = 0; i < 3; i++) scan->insertPoint(3.05f, 0.05f, 0.05f);
+
+    auto vm = mrpt::maps::CVoxelMap::Create(res);
+    lambdaSetOptions(*vm);
+
+    mp2p_icp::metric_map_t m;
+    m.layers["scan"]   = scan;
+    m.layers["voxels"] = vm;
+    merge_into(m, {0.05, 0.05, 0.05}, true);
+
+    // Only points #0, #2 and #4 are inserted (#6 is out of range):
+    mrpt::maps::CVoxelMap ref(res);
+    lambdaSetOptions(ref);
+    for (int i = 0; i < 3; i++)
+    {
+        for (int x = 0; x < 10; x++)
+            ref.updateVoxel((x + 0.5) * res, 0.05, 0.05, false);
+        ref.updateVoxel(1.05, 0.05, 0.05, true);
+    }
+
+    auto& g      = grid_of(m);
+    auto  acc    = g.createAccessor();
+    auto& gRef   = const_cast<voxel_grid_t&>(ref.grid());
+    auto  accRef = gRef.createAccessor();
+
+    ASSERT_EQUAL_(g.activeCellsCount(), gRef.activeCellsCount());
+    for (int x = 0; x <= 10; x++)
+    {
+        const auto* c    = acc.value(Bonxai::CoordT{x, 0, 0});
+        const auto* cRef = accRef.value(Bonxai::CoordT{x, 0, 0});
+        ASSERT_(c && cRef);
+        ASSERT_EQUAL_(c->occupancy, cRef->occupancy);
+    }
+
+    // Options not supported by the parallel path fall back to the serial
+    // one, so both give the same map:
+    mp2p_icp::metric_map_t serial, parallel;
+    for (auto* mm : {&serial, &parallel})
+    {
+        auto vmm = mrpt::maps::CVoxelMap::Create(0.2);
+        vmm->insertionOptions.remove_voxels_farther_than = 3.0;
+
+        mm->layers["scan"]   = room_points();
+        mm->layers["voxels"] = vmm;
+    }
+    merge_into(serial, {0.0, 0.0, 1.0}, false);
+    merge_into(parallel, {0.0, 0.0, 1.0}, true);
+
+    auto accSerial = grid_of(serial).createAccessor();
+    ASSERT_EQUAL_(
+        grid_of(parallel).activeCellsCount(),
+        grid_of(serial).activeCellsCount());
+    grid_of(parallel).forEachCell(
+        [&](mrpt::maps::CVoxelMap::voxel_node_t& data,
+            const Bonxai::CoordT&                coord)
+        {
+            const auto* c = accSerial.value(coord);
+            ASSERT_(c);
+            ASSERT_EQUAL_(c->occupancy, data.occupancy);
+        });
+
+    std::cout << "Voxel insertion options: OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_aggregated_updates();
+        test_same_as_serial();
+        test_insertion_options();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
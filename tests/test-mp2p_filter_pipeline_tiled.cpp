@@ -0,0 +1,140 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_filter_pipeline_tiled.cpp
+ * @brief  Unit tests for apply_filter_pipeline_tiled()
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/FilterBase.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+using points_t = std::vector<std::array<float, 3>>;
+
+const auto pipelineYaml = mrpt::containers::yaml::FromText(R"###(
+- class_name: mp2p_icp_filters::FilterDecimateVoxels
+  params:
+    input_pointcloud_layer: 'raw'
+    output_pointcloud_layer: 'decimated'
+    voxel_filter_resolution: 0.5
+    decimate_method: DecimateMethod::FirstPoint
+)###");
+
+mp2p_icp::metric_map_t make_map(size_t n)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    auto pc = mrpt::maps::CSimplePointsMap::Create();
+    for (size_t i = 0; i < n; i++)
+    {
+        pc->insertPoint(
+            rng.drawUniform<float>(-40.0f, 40.0f),
+            rng.drawUniform<float>(-40.0f, 40.0f),
+            rng.drawUniform<float>(-2.0f, 2.0f));
+    }
+
+    mp2p_icp::metric_map_t m;
+    m.layers["raw"]  = pc;
+    m.layers["grid"] = mrpt::maps::COccupancyGridMap2D::Create();
+    return m;
+}
+
+points_t sorted_points(const mp2p_icp::metric_map_t& m, const char* layer)
+{
+    const auto pc = m.point_layer(layer);
+    ASSERT_(pc);
+
+    points_t pts;
+    for (size_t i = 0; i < pc->size(); i++)
+    {
+        float x, y, z;
+        pc->getPoint(i, x, y, z);
+        pts.push_back({x, y, z});
+    }
+    std::sort(pts.begin(), pts.end());
+    return pts;
+}
+
+void test_same_as_non_tiled()
+{
+    const auto in = make_map(200'000);
+
+    mp2p_icp::metric_map_t ref = in;
+    mp2p_icp_filters::apply_filter_pipeline(
+        mp2p_icp_filters::filter_pipeline_from_yaml(pipelineYaml), ref);
+
+    // Tiles multiple of the voxel size, with different batch sizes:
+    for (const size_t tilesPerBatch : {1UL, 7UL, 1000UL})
+    {
+        mp2p_icp_filters::tiled_pipeline_options_t opts;
+        opts.tile_size       = 8.0;
+        opts.halo            = 1.0;
+        opts.tiles_per_batch = tilesPerBatch;
+
+        mp2p_icp::metric_map_t tiled = in;
+        mp2p_icp_filters::apply_filter_pipeline_tiled(
+            pipelineYaml, tiled, opts);
+
+        ASSERT_(sorted_points(tiled, "decimated") ==
+                sorted_points(ref, "decimated"));
+        // Each input point is kept in exactly one tile:
+        ASSERT_(sorted_points(tiled, "raw") == sorted_points(in, "raw"));
+
+        // Non point layers are kept as they were:
+        ASSERT_(tiled.layers.at("grid") == in.layers.at("grid"));
+    }
+
+    std::cout << "Tiled pipeline: " << ref.point_layer("decimated")->size()
+              << " points, OK\n";
+}
+
+void test_no_points()
+{
+    auto in = make_map(0);
+
+    mp2p_icp::metric_map_t ref = in;
+    mp2p_icp_filters::apply_filter_pipeline(
+        mp2p_icp_filters::filter_pipeline_from_yaml(pipelineYaml), ref);
+
+    mp2p_icp_filters::apply_filter_pipeline_tiled(pipelineYaml, in);
+
+    ASSERT_EQUAL_(in.layers.size(), ref.layers.size());
+    for (const auto& [name, layer] : ref.layers)
+        ASSERT_(in.layers.count(name) != 0);
+    ASSERT_(in.point_layer("raw"));
+
+    std::cout << "Tiled pipeline, empty map: OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_same_as_non_tiled();
+        test_no_points();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
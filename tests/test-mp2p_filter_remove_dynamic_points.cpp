@@ -0,0 +1,161 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_filter_remove_dynamic_points.cpp
+ * @brief  Unit tests for FilterRemoveDynamicPoints
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/FilterRemoveDynamicPoints.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+using points_t = std::vector<std::array<float, 3>>;
+
+// A static wall at x=10.1, seen from the origin:
+points_t wall_points()
+{
+    points_t pts;
+    for (int iy = -30; iy <= 30; iy++)
+        for (int iz = -10; iz <= 10; iz++)
+            pts.push_back({10.1f, iy * 0.1f, iz * 0.1f});
+    return pts;
+}
+
+// An object in front of the wall, hiding part of it:
+points_t object_points()
+{
+    points_t pts;
+    for (int iy = -4; iy <= 4; iy++)
+        for (int iz = -4; iz <= 4; iz++)
+            pts.push_back({5.1f, iy * 0.1f, iz * 0.1f});
+    return pts;
+}
+
+mp2p_icp::metric_map_t make_scan(bool withObject)
+{
+    auto pc = mrpt::maps::CSimplePointsMap::Create();
+    for (const auto& p : wall_points()) pc->insertPoint(p[0], p[1], p[2]);
+    if (withObject)
+        for (const auto& p : object_points()) pc->insertPoint(p[0], p[1], p[2]);
+
+    mp2p_icp::metric_map_t m;
+    m.layers["scan"] = pc;
+    return m;
+}
+
+points_t sorted_points(const mp2p_icp::metric_map_t& m, const char* layer)
+{
+    const auto pc = m.point_layer(layer);
+    ASSERT_(pc);
+
+    points_t pts;
+    for (size_t i = 0; i < pc->size(); i++)
+    {
+        float x, y, z;
+        pc->getPoint(i, x, y, z);
+        pts.push_back({x, y, z});
+    }
+    std::sort(pts.begin(), pts.end());
+    return pts;
+}
+
+points_t repeated(const points_t& pts, size_t times)
+{
+    points_t all;
+    for (size_t i = 0; i < times; i++)
+        all.insert(all.end(), pts.begin(), pts.end());
+    std::sort(all.begin(), all.end());
+    return all;
+}
+
+void test_hits_misses_prune()
+{
+    mp2p_icp_filters::FilterRemoveDynamicPoints f;
+    f.initialize(mrpt::containers::yaml::FromText(R"###(
+input_pointcloud_layer: 'scan'
+target_layer: 'map'
+output_layer_dynamic_objects: 'dynamic'
+robot_pose: [0, 0, 0, 0, 0, 0]
+voxel_size: 0.25
+minimum_observations: 3
+dynamic_threshold: 0.5
+)###"));
+
+    const auto wall   = wall_points();
+    const auto object = object_points();
+
+    mp2p_icp::metric_map_t map;
+    const auto             lambdaInsertScan = [&](bool withObject)
+    {
+        auto scan = make_scan(withObject);
+        map.layers["scan"] = scan.layers["scan"];
+        f.filter(map);
+    };
+
+    // 1st scan: the object is in the map.
+    lambdaInsertScan(true);
+    {
+        points_t expected = wall;
+        expected.insert(expected.end(), object.begin(), object.end());
+        std::sort(expected.begin(), expected.end());
+        ASSERT_(sorted_points(map, "map") == expected);
+        ASSERT_(map.point_layer("dynamic")->empty());
+    }
+
+    // 2nd scan, the object moved away: 1 hit + 1 miss is not enough
+    // observations yet.
+    lambdaInsertScan(false);
+    ASSERT_EQUAL_(
+        map.point_layer("map")->size(), 2 * wall.size() + object.size());
+
+    // 3rd scan: 1 hit + 2 misses, the object voxels are dynamic and their
+    // points are moved out of the map:
+    lambdaInsertScan(false);
+    ASSERT_(sorted_points(map, "map") == repeated(wall, 3));
+    ASSERT_(sorted_points(map, "dynamic") == repeated(object, 1));
+
+    // 4th, 5th scans: new points in dynamic voxels are not inserted
+    // (2 hits + 3 misses):
+    lambdaInsertScan(false);
+    lambdaInsertScan(true);
+    ASSERT_(sorted_points(map, "map") == repeated(wall, 5));
+    ASSERT_(sorted_points(map, "dynamic") == repeated(object, 2));
+
+    // After reset(), points already in the map are indexed again:
+    f.reset();
+    for (int i = 0; i < 3; i++) lambdaInsertScan(i == 0);
+    ASSERT_(sorted_points(map, "map") == repeated(wall, 8));
+    ASSERT_(sorted_points(map, "dynamic") == repeated(object, 3));
+
+    std::cout << "FilterRemoveDynamicPoints: "
+              << map.point_layer("map")->size() << " map points, OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_hits_misses_prune();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,131 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_filter_voxel_pyramid.cpp
+ * @brief  Unit tests for FilterVoxelPyramid
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/FilterDecimateVoxels.h>
+#include <mp2p_icp_filters/FilterVoxelPyramid.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+using points_t = std::vector<std::array<float, 3>>;
+
+// Power of two resolutions, so the voxel indices of all levels are exact:
+constexpr double FINEST_RESOLUTION = 0.125;
+constexpr int    NUM_LEVELS = 3, LEVEL_SHIFT = 2;
+
+points_t layer_points(const mp2p_icp::metric_map_t& m, const std::string& ly)
+{
+    const auto pc = m.point_layer(ly);
+    ASSERT_(pc);
+
+    points_t pts;
+    for (size_t i = 0; i < pc->size(); i++)
+    {
+        float x, y, z;
+        pc->getPoint(i, x, y, z);
+        pts.push_back({x, y, z});
+    }
+    return pts;
+}
+
+void test_pyramid(const char* method)
+{
+    // A cloud around the origin, so negative coordinates are also tested:
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    auto pc = mrpt::maps::CSimplePointsMap::Create();
+    for (size_t i = 0; i < 100'000; i++)
+    {
+        pc->insertPoint(
+            rng.drawUniform<float>(-20.0f, 20.0f),
+            rng.drawUniform<float>(-20.0f, 20.0f),
+            rng.drawUniform<float>(-2.0f, 2.0f));
+    }
+    mp2p_icp::metric_map_t in;
+    in.layers["raw"] = pc;
+
+    mp2p_icp_filters::FilterVoxelPyramid pyramid;
+    pyramid.initialize(mrpt::containers::yaml::FromText(mrpt::format(
+        "input_pointcloud_layer: 'raw'\n"
+        "voxel_filter_resolution: %f\n"
+        "num_levels: %d\n"
+        "level_shift: %d\n"
+        "decimate_method: DecimateMethod::%s\n",
+        FINEST_RESOLUTION, NUM_LEVELS, LEVEL_SHIFT, method)));
+
+    mp2p_icp::metric_map_t out = in;
+    pyramid.filter(out);
+
+    const bool firstPoint = std::string(method) == "FirstPoint";
+
+    for (int l = 0; l < NUM_LEVELS; l++)
+    {
+        const double res = FINEST_RESOLUTION * (1 << (l * LEVEL_SHIFT));
+
+        mp2p_icp_filters::FilterDecimateVoxels decim;
+        decim.initialize(mrpt::containers::yaml::FromText(mrpt::format(
+            "input_pointcloud_layer: ['raw']\n"
+            "output_pointcloud_layer: 'decimated'\n"
+            "voxel_filter_resolution: %f\n"
+            "decimate_method: DecimateMethod::%s\n",
+            res, method)));
+
+        mp2p_icp::metric_map_t ref = in;
+        decim.filter(ref);
+
+        auto pts    = layer_points(out, pyramid.output_layer_name(l));
+        auto refPts = layer_points(ref, "decimated");
+        ASSERT_EQUAL_(pts.size(), refPts.size());
+
+        std::sort(pts.begin(), pts.end());
+        std::sort(refPts.begin(), refPts.end());
+
+        if (firstPoint) { ASSERT_(pts == refPts); }
+        else
+        {
+            // Averages may differ in the order of summation:
+            for (size_t i = 0; i < pts.size(); i++)
+                for (int k = 0; k < 3; k++)
+                    ASSERT_NEAR_(pts[i][k], refPts[i][k], 1e-4f);
+        }
+
+        std::cout << "VoxelPyramid " << method << ", level #" << l
+                  << " (res=" << res << "): " << pts.size()
+                  << " points, OK\n";
+    }
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_pyramid("FirstPoint");
+        test_pyramid("VoxelAverage");
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
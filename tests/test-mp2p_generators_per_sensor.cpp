@@ -0,0 +1,168 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_generators_per_sensor.cpp
+ * @brief  Unit tests for apply_generators_per_sensor()
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/Generator.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/obs/CObservationPointCloud.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <iostream>
+#include <set>
+#include <thread>
+
+namespace
+{
+using mp2p_icp_filters::Generator;
+
+// A generator with mutable state, which must never be called concurrently:
+class NonReentrantGenerator : public Generator
+{
+   public:
+    bool process(
+        const mrpt::obs::CObservation& o, mp2p_icp::metric_map_t& out,
+        const std::optional<mrpt::poses::CPose3D>& robotPose =
+            std::nullopt) const override
+    {
+        callingThreads.insert(std::this_thread::get_id());
+        return Generator::process(o, out, robotPose);
+    }
+
+    bool isReentrant() const override { return false; }
+
+    mutable std::set<std::thread::id> callingThreads;
+};
+
+mrpt::obs::CSensoryFrame make_sf(size_t nSensors, size_t nPoints)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    mrpt::obs::CSensoryFrame sf;
+    for (size_t s = 0; s < nSensors; s++)
+    {
+        auto obs         = mrpt::obs::CObservationPointCloud::Create();
+        obs->sensorLabel = "lidar" + std::to_string(s);
+        obs->sensorPose  = mrpt::poses::CPose3D(s * 0.5, 0, 1.0, 0.1 * s, 0, 0);
+
+        auto pc = mrpt::maps::CSimplePointsMap::Create();
+        for (size_t i = 0; i < nPoints; i++)
+        {
+            pc->insertPoint(
+                rng.drawUniform<float>(-30.0f, 30.0f),
+                rng.drawUniform<float>(-30.0f, 30.0f),
+                rng.drawUniform<float>(-2.0f, 5.0f));
+        }
+        obs->pointcloud = pc;
+        sf.insert(obs);
+    }
+    return sf;
+}
+
+void compare_maps(
+    const mp2p_icp::metric_map_t& a, const mp2p_icp::metric_map_t& b)
+{
+    ASSERT_EQUAL_(a.layers.size(), b.layers.size());
+    for (const auto& [name, layer] : a.layers)
+    {
+        const auto pa = a.point_layer(name);
+        const auto pb = b.point_layer(name);
+        ASSERT_(pa && pb);
+        ASSERT_EQUAL_(pa->size(), pb->size());
+
+        for (size_t i = 0; i < pa->size(); i++)
+        {
+            float xa, ya, za, xb, yb, zb;
+            pa->getPoint(i, xa, ya, za);
+            pb->getPoint(i, xb, yb, zb);
+            ASSERT_NEAR_(xa, xb, 1e-4f);
+            ASSERT_NEAR_(ya, yb, 1e-4f);
+            ASSERT_NEAR_(za, zb, 1e-4f);
+        }
+    }
+}
+
+mp2p_icp_filters::GeneratorSet make_generators()
+{
+    // All sensors into "raw", plus only "lidar1" into its own layer:
+    auto g1 = Generator::Create();
+    g1->initialize({});
+
+    auto                   g2 = Generator::Create();
+    mrpt::containers::yaml p2;
+    p2["target_layer"]                = "lidar1";
+    p2["process_sensor_labels_regex"] = "lidar1";
+    g2->initialize(p2);
+
+    return {g1, g2};
+}
+
+void test_same_as_serial()
+{
+    const auto sf        = make_sf(4, 20'000);
+    const auto robotPose = mrpt::poses::CPose3D(10.0, -2.0, 0, 0.3, 0, 0);
+
+    mp2p_icp::metric_map_t serial, parallel;
+    ASSERT_(mp2p_icp_filters::apply_generators(
+        make_generators(), sf, serial, robotPose));
+    ASSERT_(mp2p_icp_filters::apply_generators_per_sensor(
+        make_generators(), sf, parallel, robotPose));
+
+    ASSERT_EQUAL_(serial.point_layer("raw")->size(), 4 * 20'000UL);
+    ASSERT_EQUAL_(serial.point_layer("lidar1")->size(), 20'000UL);
+    compare_maps(serial, parallel);
+
+    // Appending to former contents:
+    ASSERT_(mp2p_icp_filters::apply_generators(
+        make_generators(), sf, serial, robotPose));
+    ASSERT_(mp2p_icp_filters::apply_generators_per_sensor(
+        make_generators(), sf, parallel, robotPose));
+    compare_maps(serial, parallel);
+}
+
+void test_non_reentrant_fallback()
+{
+    const auto sf = make_sf(8, 5'000);
+
+    auto g = std::make_shared<NonReentrantGenerator>();
+    g->initialize({});
+
+    mp2p_icp::metric_map_t serial, parallel;
+    ASSERT_(mp2p_icp_filters::apply_generators(
+        make_generators(), sf, serial, std::nullopt));
+
+    auto gens = make_generators();
+    gens.at(0) = g;
+    ASSERT_(mp2p_icp_filters::apply_generators_per_sensor(
+        gens, sf, parallel, std::nullopt));
+
+    ASSERT_EQUAL_(g->callingThreads.size(), 1UL);
+    compare_maps(serial, parallel);
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_same_as_serial();
+        test_non_reentrant_fallback();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
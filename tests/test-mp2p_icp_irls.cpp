@@ -0,0 +1,224 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_icp_irls.cpp
+ * @brief  Unit tests for ICP IRLS mode (solverIterationsPerMatching)
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/ICP.h>
+#include <mp2p_icp/Matcher_Points_DistanceThreshold.h>
+#include <mp2p_icp/Solver_GaussNewton.h>
+#include <mp2p_icp/Solver_Horn.h>
+#include <mp2p_icp/Solver_OLAE.h>
+#include <mp2p_icp/optimal_tf_gauss_newton.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <iostream>
+#include <vector>
+
+namespace
+{
+const auto gtPose = mrpt::poses::CPose3D(0.10, -0.05, 0.02, 0.01, 0.005, 0);
+
+// Pairings from a random cloud, with noise and a fraction of outliers:
+mp2p_icp::Pairings make_pairings(size_t n)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    mp2p_icp::Pairings pairings;
+    for (size_t i = 0; i < n; i++)
+    {
+        mrpt::tfest::TMatchingPair p;
+        p.localIdx  = i;
+        p.globalIdx = i;
+        p.local     = {
+            rng.drawUniform<float>(-20.0f, 20.0f),
+            rng.drawUniform<float>(-20.0f, 20.0f),
+            rng.drawUniform<float>(-2.0f, 5.0f)};
+
+        double gx, gy, gz;
+        gtPose.composePoint(p.local.x, p.local.y, p.local.z, gx, gy, gz);
+        p.global = mrpt::math::TPoint3Df(
+            gx + rng.drawGaussian1D(0, 0.01), gy + rng.drawGaussian1D(0, 0.01),
+            gz + rng.drawGaussian1D(0, 0.01));
+        if (i % 10 == 0) p.global.x += 2.0f;  // outlier
+
+        pairings.paired_pt2pt.push_back(p);
+    }
+    return pairings;
+}
+
+mrpt::poses::CPose3D solve_gn(
+    const mp2p_icp::Pairings& pairings, mp2p_icp::RobustKernel kernel,
+    bool kernelOnPointPairings)
+{
+    mp2p_icp::OptimalTF_GN_Parameters gnParams;
+    gnParams.linearizationPoint.emplace();
+    gnParams.kernel                = kernel;
+    gnParams.kernelParam           = 0.5;
+    gnParams.kernelOnPointPairings = kernelOnPointPairings;
+
+    mp2p_icp::OptimalTF_Result result;
+    ASSERT_(mp2p_icp::optimal_tf_gauss_newton(pairings, result, gnParams));
+    return result.optimalPose;
+}
+
+void assert_same_pose(
+    const mrpt::poses::CPose3D& a, const mrpt::poses::CPose3D& b,
+    double tolerance)
+{
+    for (int i = 0; i < 6; i++) ASSERT_NEAR_(a[i], b[i], tolerance);
+}
+
+// Per-pairing weights (one block per pairing, as set by IRLS) must give the
+// same solution than the same weights given in larger blocks:
+void test_point_weight_blocks()
+{
+    auto grouped = make_pairings(5'000);
+    grouped.point_weights = {{2'000, 1.0}, {1'000, 0.25}, {2'000, 0.5}};
+
+    auto perPair = grouped;
+    perPair.point_weights.clear();
+    for (const auto& [count, w] : grouped.point_weights)
+        for (size_t i = 0; i < count; i++)
+            perPair.point_weights.emplace_back(1, w);
+
+    assert_same_pose(
+        solve_gn(grouped, mp2p_icp::RobustKernel::None, true),
+        solve_gn(perPair, mp2p_icp::RobustKernel::None, true), 1e-9);
+
+    // A solver kernel disabled for point pairings is not applied on top of
+    // the point weights:
+    assert_same_pose(
+        solve_gn(perPair, mp2p_icp::RobustKernel::Cauchy, false),
+        solve_gn(perPair, mp2p_icp::RobustKernel::None, true), 1e-9);
+
+    std::cout << "Point weight blocks: OK\n";
+}
+
+mp2p_icp::Results run_icp(
+    const mp2p_icp::Parameters& p,
+    mp2p_icp::Solver::Ptr       solver = mp2p_icp::Solver_GaussNewton::Create())
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(4321);
+
+    auto global = mrpt::maps::CSimplePointsMap::Create();
+    for (size_t i = 0; i < 10'000; i++)
+    {
+        global->insertPoint(
+            rng.drawUniform<float>(-10.0f, 10.0f),
+            rng.drawUniform<float>(-10.0f, 10.0f),
+            rng.drawUniform<float>(-2.0f, 2.0f));
+    }
+    auto local = mrpt::maps::CSimplePointsMap::Create();
+    local->changeCoordinatesReference(*global, -gtPose);
+    // Outliers in the local cloud:
+    for (size_t i = 0; i < 1'000; i++)
+    {
+        local->insertPoint(
+            rng.drawUniform<float>(-10.0f, 10.0f),
+            rng.drawUniform<float>(-10.0f, 10.0f),
+            rng.drawUniform<float>(-2.0f, 2.0f));
+    }
+
+    mp2p_icp::metric_map_t pcGlobal, pcLocal;
+    pcGlobal.layers["raw"] = global;
+    pcLocal.layers["raw"]  = local;
+
+    auto matcher = mp2p_icp::Matcher_Points_DistanceThreshold::Create();
+
+    mrpt::containers::yaml mp;
+    mp["threshold"]           = 0.5;
+    mp["thresholdAngularDeg"] = 0;
+    matcher->initialize(mp);
+
+    mp2p_icp::ICP icp;
+    icp.matchers().push_back(matcher);
+    icp.solvers().push_back(solver);
+
+    mp2p_icp::Results r;
+    icp.align(pcLocal, pcGlobal, mrpt::math::TPose3D::Identity(), p, r);
+    return r;
+}
+
+void test_icp_irls()
+{
+    mp2p_icp::Parameters p;
+    p.maxIterations = 200;
+
+    // N=1: plain ICP, the IRLS kernel parameters have no effect:
+    const auto r1 = run_icp(p);
+
+    mp2p_icp::Parameters p1 = p;
+    p1.solverIterationsPerMatching = 1;
+    p1.irlsKernel                  = mp2p_icp::RobustKernel::GemanMcClure;
+    p1.irlsKernelParam             = 0.1;
+    const auto r1b                 = run_icp(p1);
+
+    ASSERT_EQUAL_(r1.nIterations, r1b.nIterations);
+    assert_same_pose(r1.optimal_tf.mean, r1b.optimal_tf.mean, 1e-9);
+
+    // N>1: converges to the same solution:
+    mp2p_icp::Parameters pN = p;
+    pN.solverIterationsPerMatching = 5;
+    const auto rN                  = run_icp(pN);
+
+    ASSERT_(rN.terminationReason == mp2p_icp::IterTermReason::Stalled);
+    ASSERT_LT_((rN.optimal_tf.mean - gtPose).norm(), 0.02);
+    ASSERT_LT_((r1.optimal_tf.mean - gtPose).norm(), 0.02);
+
+    std::cout << "ICP IRLS: " << r1.nIterations << " iterations (N=1), "
+              << rN.nIterations << " iterations (N=5), OK\n";
+}
+
+// Solvers that cannot use point weights are rejected in IRLS mode:
+void test_irls_unsupported_solver()
+{
+    mp2p_icp::Parameters p;
+    p.maxIterations               = 10;
+    p.solverIterationsPerMatching = 3;
+
+    for (const auto& solver : std::vector<mp2p_icp::Solver::Ptr>{
+             mp2p_icp::Solver_Horn::Create(), mp2p_icp::Solver_OLAE::Create()})
+    {
+        bool thrown = false;
+        try
+        {
+            run_icp(p, solver);
+        }
+        catch (const std::exception&)
+        {
+            thrown = true;
+        }
+        ASSERT_(thrown);
+    }
+
+    std::cout << "ICP IRLS with unsupported solvers: OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_point_weight_blocks();
+        test_icp_irls();
+        test_irls_unsupported_solver();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,199 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_icp_time_budget.cpp
+ * @brief  Unit tests for ICP "anytime" mode (Parameters::timeBudget)
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/ICP.h>
+#include <mp2p_icp/Matcher_Points_Base.h>
+#include <mp2p_icp/Solver_Horn.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <iostream>
+#include <optional>
+#include <vector>
+
+namespace
+{
+// Simulated cost of matching one local point [s]:
+constexpr double SECONDS_PER_POINT = 1e-7;
+
+// A matcher with known correspondences (local point "i" is global point "i"),
+// whose cost is proportional to the number of local points it uses: it
+// advances a simulated clock, so the test does not depend on the wall-clock
+// time. It records the local points limit seen in each call and, when the
+// workload is reduced, it returns half of the pairings as outliers.
+class OracleMatcher : public mp2p_icp::Matcher_Points_Base
+{
+   public:
+    mrpt::rtti::CObject* clone() const override
+    {
+        return new OracleMatcher(*this);
+    }
+
+    mutable std::vector<std::optional<uint64_t>> seenLimits;
+    mutable double                               simulatedTime = 0;
+
+   private:
+    void implMatchOneLayer(
+        const mrpt::maps::CMetricMap& pcGlobal,
+        const mrpt::maps::CPointsMap& pcLocal,
+        const mrpt::poses::CPose3D&             localPose,
+        const mp2p_icp::MatchContext&           mc,
+        [[maybe_unused]] mp2p_icp::MatchState&  ms,
+        [[maybe_unused]] const std::string&     globalName,
+        [[maybe_unused]] const std::string&     localName,
+        mp2p_icp::Pairings&                     out) const override
+    {
+        seenLimits.push_back(mc.maxLocalPointsPerLayer);
+
+        const auto* pcGlobalPts =
+            dynamic_cast<const mrpt::maps::CPointsMap*>(&pcGlobal);
+        ASSERT_(pcGlobalPts);
+
+        const auto tl = transform_local_to_global(
+            pcLocal, localPose, maxLocalPoints(mc), 1 /*seed*/);
+
+        const size_t n = tl.x_locals.size();
+        simulatedTime += SECONDS_PER_POINT * static_cast<double>(n);
+
+        const auto& gxs = pcGlobalPts->getPointsBufferRef_x();
+        const auto& gys = pcGlobalPts->getPointsBufferRef_y();
+        const auto& gzs = pcGlobalPts->getPointsBufferRef_z();
+        const auto& lxs = pcLocal.getPointsBufferRef_x();
+        const auto& lys = pcLocal.getPointsBufferRef_y();
+        const auto& lzs = pcLocal.getPointsBufferRef_z();
+
+        const bool outliers = mc.maxLocalPointsPerLayer.has_value();
+
+        for (size_t i = 0; i < n; i++)
+        {
+            const size_t idx = tl.idxs.has_value() ? (*tl.idxs)[i] : i;
+
+            mrpt::tfest::TMatchingPair p;
+            p.globalIdx = idx;
+            p.localIdx  = idx;
+            p.global    = {gxs[idx], gys[idx], gzs[idx]};
+            p.local     = {lxs[idx], lys[idx], lzs[idx]};
+            if (outliers && (i % 2) == 0) p.global.x += 3.0f;
+            out.paired_pt2pt.push_back(p);
+        }
+    }
+};
+
+constexpr size_t NUM_POINTS = 20'000;
+
+void test_time_budget()
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    auto global = mrpt::maps::CSimplePointsMap::Create();
+    for (size_t i = 0; i < NUM_POINTS; i++)
+    {
+        global->insertPoint(
+            rng.drawUniform<float>(-20.0f, 20.0f),
+            rng.drawUniform<float>(-20.0f, 20.0f),
+            rng.drawUniform<float>(-2.0f, 5.0f));
+    }
+
+    const auto gtPose = mrpt::poses::CPose3D(1.0, -0.5, 0.1, 0.2, 0, 0);
+
+    auto local = mrpt::maps::CSimplePointsMap::Create();
+    local->changeCoordinatesReference(*global, -gtPose);
+
+    mp2p_icp::metric_map_t pcGlobal, pcLocal;
+    pcGlobal.layers["raw"] = global;
+    pcLocal.layers["raw"]  = local;
+
+    mp2p_icp::ICP icp;
+    auto          matcher = std::make_shared<OracleMatcher>();
+    icp.matchers().push_back(matcher);
+    icp.solvers().push_back(mp2p_icp::Solver_Horn::Create());
+    icp.setTimeSource([matcher]() { return matcher->simulatedTime; });
+
+    mp2p_icp::Parameters p;
+    p.maxIterations    = 10'000;
+    p.minAbsStep_trans = 0;  // never stall: run until the time is out
+    p.minAbsStep_rot   = 0;
+
+    p.timeBudgetMinLocalPoints = 10;
+
+    // 1st call: 2 ms per full iteration. 50 full iterations fit in the
+    // budget, then one more with half the points:
+    p.timeBudget = 0.101;
+
+    mp2p_icp::Results r;
+    icp.align(pcLocal, pcGlobal, mrpt::math::TPose3D::Identity(), p, r);
+
+    ASSERT_(r.terminationReason == mp2p_icp::IterTermReason::Timeout);
+    ASSERT_EQUAL_(r.nIterations, 51U);
+
+    // The matcher object itself is never modified:
+    ASSERT_EQUAL_(matcher->maxLocalPointsPerLayer_, 0U);
+
+    // One call per iteration, plus one to match again at the best solution,
+    // which was not the last one:
+    const auto& limits = matcher->seenLimits;
+    ASSERT_EQUAL_(limits.size(), r.nIterations + 1);
+
+    // The workload is reduced only for the last iteration. No estimate is
+    // available for the very first one:
+    double loopCost = 0;
+    for (size_t i = 0; i < r.nIterations; i++)
+    {
+        ASSERT_EQUAL_(limits[i].has_value(), i + 1 == r.nIterations);
+        loopCost += SECONDS_PER_POINT *
+                    static_cast<double>(limits[i].value_or(NUM_POINTS));
+    }
+    ASSERT_GT_(*limits.back(), NUM_POINTS / 2 - 10);
+    ASSERT_LE_(*limits.back(), NUM_POINTS / 2);
+    ASSERT_LE_(loopCost, p.timeBudget + 1e-9);
+
+    // The returned solution is the best one, not the last (with outliers),
+    // with pairings matched again at its pose:
+    ASSERT_LT_((r.optimal_tf.mean - gtPose).norm(), 1e-3);
+    ASSERT_EQUAL_(r.finalPairings.paired_pt2pt.size(), *limits.back());
+
+    // 2nd call: less than one full iteration fits in the budget, and the
+    // first iteration must be already reduced using the former timings:
+    matcher->seenLimits.clear();
+    p.timeBudget = 1e-3;
+
+    icp.align(pcLocal, pcGlobal, mrpt::math::TPose3D::Identity(), p, r);
+
+    ASSERT_(r.terminationReason == mp2p_icp::IterTermReason::Timeout);
+    ASSERT_EQUAL_(r.nIterations, 1U);
+    // The only iteration is the best one, it is not matched again:
+    ASSERT_EQUAL_(limits.size(), 1U);
+    ASSERT_(limits.front().has_value());
+    ASSERT_LE_(*limits.front(), NUM_POINTS / 2);
+    ASSERT_EQUAL_(matcher->maxLocalPointsPerLayer_, 0U);
+
+    std::cout << "Time budget: " << r.nIterations << " iterations, "
+              << 1e3 * loopCost << " ms simulated, OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_time_budget();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
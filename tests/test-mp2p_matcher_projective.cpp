@@ -0,0 +1,132 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_matcher_projective.cpp
+ * @brief  Unit tests for Matcher_Points_Projective
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/Matcher_Points_Projective.h>
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <iostream>
+#include <vector>
+
+namespace
+{
+constexpr int    NCOLS = 64, NROWS = 32;
+constexpr double FOCAL = 32.0;
+
+// The point at `range` (along +X) seen at the center of pixel (u,v):
+mrpt::math::TPoint3Df pixel_point(int u, int v, double range)
+{
+    const double y = -((u + 0.5) - NCOLS / 2.0) / FOCAL;
+    const double z = -((v + 0.5) - NROWS / 2.0) / FOCAL;
+    return {
+        static_cast<float>(range), static_cast<float>(range * y),
+        static_cast<float>(range * z)};
+}
+
+// An organized scan of a wall at x=10 in the local frame, one point per
+// pixel, plus points occluded by it, which must never be paired. The global
+// map has the same points, seen from `localPose`:
+void test_pose(const mrpt::poses::CPose3D& localPose)
+{
+    auto global = mrpt::maps::CSimplePointsMap::Create();
+    auto local  = mrpt::maps::CSimplePointsMap::Create();
+
+    const auto lambdaInsertGlobal = [&](const mrpt::math::TPoint3Df& p)
+    {
+        const auto g =
+            localPose.composePoint(mrpt::math::TPoint3D(p.x, p.y, p.z));
+        global->insertPoint(g.x, g.y, g.z);
+    };
+
+    for (int v = 0; v < NROWS; v++)
+    {
+        for (int u = 0; u < NCOLS; u++)
+        {
+            const auto p = pixel_point(u, v, 10.0);
+            lambdaInsertGlobal(p);
+            local->insertPoint(p.x, p.y, p.z);
+        }
+    }
+    const size_t nWall = global->size();
+
+    for (int v = 0; v < NROWS; v++)
+    {
+        for (int u = 0; u < NCOLS; u++)
+            lambdaInsertGlobal(pixel_point(u, v, 20.0));
+    }
+
+    // Local points without a valid pairing: far from the wall in its pixel,
+    // behind the camera, out of the image, and almost on the image plane
+    // (projected beyond the int range):
+    const auto pFar = pixel_point(10, 10, 5.0);
+    local->insertPoint(pFar.x, pFar.y, pFar.z);
+    local->insertPoint(-10.0f, 0.0f, 0.0f);
+    local->insertPoint(0.1f, 50.0f, 0.0f);
+    local->insertPoint(1e-9f, -1.0f, 0.5f);
+
+    mp2p_icp::metric_map_t pcGlobal, pcLocal;
+    pcGlobal.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = global;
+    pcLocal.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW]  = local;
+
+    mp2p_icp::Matcher_Points_Projective m;
+    mrpt::containers::yaml              p;
+    p["ncols"]     = NCOLS;
+    p["nrows"]     = NROWS;
+    p["cx"]        = NCOLS / 2.0;
+    p["cy"]        = NROWS / 2.0;
+    p["fx"]        = FOCAL;
+    p["fy"]        = FOCAL;
+    p["threshold"] = 0.5;
+    m.initialize(p);
+
+    mp2p_icp::Pairings   pairs;
+    mp2p_icp::MatchState ms(pcGlobal, pcLocal);
+    m.match(pcGlobal, pcLocal, localPose, {}, ms, pairs);
+
+    ASSERT_EQUAL_(pairs.potential_pairings, local->size());
+    ASSERT_EQUAL_(pairs.paired_pt2pt.size(), nWall);
+
+    std::vector<bool> localPaired(nWall, false);
+    for (const auto& pair : pairs.paired_pt2pt)
+    {
+        ASSERT_LT_(pair.localIdx, nWall);
+        ASSERT_EQUAL_(pair.globalIdx, pair.localIdx);
+        ASSERT_LT_(pair.errorSquareAfterTransformation, 1e-6f);
+        ASSERT_(!localPaired[pair.localIdx]);
+        localPaired[pair.localIdx] = true;
+    }
+
+    std::cout << "Projective matcher, pose " << localPose << ": " << nWall
+              << " pairings, OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_pose(mrpt::poses::CPose3D::Identity());
+        test_pose(mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+            5.0, -3.0, 1.0, mrpt::DEG2RAD(30.0), mrpt::DEG2RAD(-5.0),
+            mrpt::DEG2RAD(10.0)));
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
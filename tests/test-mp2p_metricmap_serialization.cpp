@@ -0,0 +1,202 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_metricmap_serialization.cpp
+ * @brief  Unit tests for metric_map_t serialization (v5 vs v4 files)
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/maps/CPointsMapXYZI.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/serialization/optional_serialization.h>
+#include <mrpt/serialization/stl_serialization.h>
+#include <mrpt/system/filesystem.h>
+
+#include <iostream>
+
+namespace
+{
+using mp2p_icp::metric_map_t;
+
+// Writes metric maps in the former serialization format (v4), without the
+// layers directory:
+class MapWriterV4 : public metric_map_t
+{
+   public:
+    explicit MapWriterV4(const metric_map_t& m) : metric_map_t(m) {}
+
+   protected:
+    uint8_t serializeGetVersion() const override { return 4; }
+    void    serializeTo(mrpt::serialization::CArchive& out) const override
+    {
+        out << lines;
+
+        out.WriteAs<uint32_t>(planes.size());
+        for (const auto& p : planes) out << p.plane << p.centroid;
+
+        out.WriteAs<uint32_t>(lines.size());
+        for (const auto& l : lines) out << l;
+
+        out.WriteAs<uint32_t>(layers.size());
+        for (const auto& l : layers) out << l.first << *l.second.get();
+
+        out << id << label;
+        out << georeferencing;
+
+        derivedSerializeTo(out);
+    }
+};
+
+metric_map_t make_map()
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    auto a = mrpt::maps::CSimplePointsMap::Create();
+    auto b = mrpt::maps::CPointsMapXYZI::Create();
+    for (size_t i = 0; i < 10'000; i++)
+    {
+        a->insertPoint(
+            rng.drawUniform<float>(-10.0f, 10.0f),
+            rng.drawUniform<float>(-10.0f, 10.0f),
+            rng.drawUniform<float>(-1.0f, 1.0f));
+    }
+    for (size_t i = 0; i < 2'000; i++)
+    {
+        b->insertPointFast(
+            rng.drawUniform<float>(-10.0f, 10.0f),
+            rng.drawUniform<float>(-10.0f, 10.0f),
+            rng.drawUniform<float>(-1.0f, 1.0f));
+        b->insertPointField_Intensity(rng.drawUniform<float>(0.0f, 1.0f));
+    }
+    b->mark_as_modified();
+
+    metric_map_t m;
+    m.layers["a"] = a;
+    m.layers["b"] = b;
+    m.id          = 42;
+    m.label       = "test map";
+
+    auto& g                       = m.georeferencing.emplace();
+    g.geo_coord.lat.decimal_value = 36.8;
+    g.geo_coord.lon.decimal_value = -2.4;
+    g.geo_coord.height            = 10.0;
+    g.T_enu_to_map.mean = mrpt::poses::CPose3D(1.0, 2.0, 3.0, 0.1, 0, 0);
+
+    return m;
+}
+
+void compare_layer(const metric_map_t& a, const metric_map_t& b, const char* n)
+{
+    const auto pa = a.point_layer(n);
+    const auto pb = b.point_layer(n);
+    ASSERT_(pa && pb);
+    ASSERT_EQUAL_(
+        std::string(pa->GetRuntimeClass()->className),
+        std::string(pb->GetRuntimeClass()->className));
+    ASSERT_EQUAL_(pa->size(), pb->size());
+    ASSERT_(pa->getPointsBufferRef_x() == pb->getPointsBufferRef_x());
+    ASSERT_(pa->getPointsBufferRef_y() == pb->getPointsBufferRef_y());
+    ASSERT_(pa->getPointsBufferRef_z() == pb->getPointsBufferRef_z());
+}
+
+void compare_maps(const metric_map_t& a, const metric_map_t& b)
+{
+    ASSERT_EQUAL_(a.layers.size(), b.layers.size());
+    for (const auto& [name, _] : a.layers) compare_layer(a, b, name.c_str());
+
+    ASSERT_(a.id == b.id);
+    ASSERT_(a.label == b.label);
+    ASSERT_(a.georeferencing.has_value() && b.georeferencing.has_value());
+    ASSERT_EQUAL_(
+        a.georeferencing->geo_coord.lat.decimal_value,
+        b.georeferencing->geo_coord.lat.decimal_value);
+    ASSERT_EQUAL_(
+        a.georeferencing->T_enu_to_map.mean.asString(),
+        b.georeferencing->T_enu_to_map.mean.asString());
+}
+
+void save(const mrpt::serialization::CSerializable& o, const std::string& f)
+{
+    mrpt::io::CFileGZOutputStream out(f);
+    ASSERT_(out.is_open());
+    auto arch = mrpt::serialization::archiveFrom(out);
+    arch << o;
+}
+
+void test_round_trip(bool v4)
+{
+    const metric_map_t m = make_map();
+
+    const std::string file = mrpt::system::getTempFileName() + ".mm";
+    if (v4) { save(MapWriterV4(m), file); }
+    else { save(m, file); }
+
+    // Full load:
+    metric_map_t full;
+    ASSERT_(full.load_from_file(file));
+    compare_maps(m, full);
+
+    // Only one layer, plus the directory of all of them:
+    metric_map_t                            partial;
+    std::vector<metric_map_t::layer_info_t> info;
+    ASSERT_(partial.load_from_file(file, {"b", "missing"}, info));
+
+    ASSERT_EQUAL_(partial.layers.size(), 1UL);
+    compare_layer(m, partial, "b");
+    ASSERT_(partial.id == m.id);
+    ASSERT_(partial.label == m.label);
+    ASSERT_(partial.georeferencing.has_value());
+
+    ASSERT_EQUAL_(info.size(), 2UL);
+    ASSERT_EQUAL_(info.at(0).name, std::string("a"));
+    ASSERT_EQUAL_(info.at(0).pointCount, 10'000UL);
+    ASSERT_EQUAL_(info.at(1).name, std::string("b"));
+    ASSERT_EQUAL_(info.at(1).pointCount, 2'000UL);
+    ASSERT_EQUAL_(
+        info.at(1).className,
+        std::string(m.layers.at("b")->GetRuntimeClass()->className));
+    // Layer sizes are only stored since v5:
+    for (const auto& li : info) ASSERT_EQUAL_(li.serializedBytes > 0, !v4);
+
+    // No layer at all:
+    metric_map_t none;
+    ASSERT_(none.load_from_file(file, {} /*no layer*/));
+    ASSERT_(none.layers.empty());
+    ASSERT_(none.id == m.id);
+
+    // The load context is not left behind for other loads:
+    metric_map_t fullAgain;
+    ASSERT_(fullAgain.load_from_file(file));
+    compare_maps(m, fullAgain);
+
+    mrpt::system::deleteFile(file);
+
+    std::cout << "Round trip " << (v4 ? "v4" : "v5") << ": OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_round_trip(false);
+        test_round_trip(true);
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
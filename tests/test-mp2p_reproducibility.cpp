@@ -0,0 +1,117 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_reproducibility.cpp
+ * @brief  Unit tests for the reproducibility mode and counter-based RNGs
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/Matcher_Points_Base.h>
+#include <mp2p_icp/reproducibility.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+
+namespace
+{
+void test_philox_known_answers()
+{
+    // Known-answer vectors of Philox4x32-10 (Random123):
+    using R = mp2p_icp::CounterRNG;
+
+    const R::block_t r0 = R::philox({0, 0, 0, 0}, {0, 0});
+    const R::block_t e0 = {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8};
+    ASSERT_(r0 == e0);
+
+    const R::block_t r1 = R::philox(
+        {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+        {0xffffffff, 0xffffffff});
+    const R::block_t e1 = {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd};
+    ASSERT_(r1 == e1);
+}
+
+void test_counter_rng_streams()
+{
+    const mp2p_icp::CounterRNG rng(1234);
+
+    // Draws do not depend on the order in which they are requested:
+    std::vector<uint64_t> fwd, bwd;
+    for (uint64_t s = 0; s < 100; s++) fwd.push_back(rng(s, 7));
+    for (uint64_t s = 100; s-- > 0;) bwd.push_back(rng(s, 7));
+    std::reverse(bwd.begin(), bwd.end());
+    ASSERT_(fwd == bwd);
+
+    // ...and differ for different streams, counters and seeds:
+    ASSERT_(std::set<uint64_t>(fwd.begin(), fwd.end()).size() == fwd.size());
+    ASSERT_NOT_EQUAL_(rng(3, 0), rng(3, 1));
+    ASSERT_NOT_EQUAL_(rng(3, 0), mp2p_icp::CounterRNG(1235)(3, 0));
+
+    for (uint64_t s = 0; s < 1000; s++)
+    {
+        ASSERT_LT_(rng.index(13, s), 13UL);
+        const double u = rng.uniform(s);
+        ASSERT_(u >= 0.0 && u < 1.0);
+    }
+}
+
+void test_reproducible_local_sampling()
+{
+    mrpt::maps::CSimplePointsMap pc;
+    for (int i = 0; i < 1000; i++) pc.insertPoint(i * 0.1f, 0, 0);
+
+    const mrpt::poses::CPose3D pose(1.0, 2.0, 0, 0, 0, 0);
+    constexpr std::size_t      N = 100;
+
+    mp2p_icp::set_reproducible_mode(true);
+
+    const auto tl1 =
+        mp2p_icp::Matcher_Points_Base::transform_local_to_global(pc, pose, N);
+    const auto tl2 =
+        mp2p_icp::Matcher_Points_Base::transform_local_to_global(pc, pose, N);
+
+    ASSERT_(tl1.idxs.has_value() && tl2.idxs.has_value());
+    ASSERT_EQUAL_(tl1.idxs->size(), N);
+    ASSERT_(*tl1.idxs == *tl2.idxs);
+    ASSERT_(tl1.x_locals == tl2.x_locals);
+
+    // Unique indices, picked from the whole cloud:
+    const std::set<std::size_t> uniqueIdxs(tl1.idxs->begin(), tl1.idxs->end());
+    ASSERT_EQUAL_(uniqueIdxs.size(), N);
+    ASSERT_LT_(*uniqueIdxs.rbegin(), pc.size());
+    ASSERT_GT_(*uniqueIdxs.rbegin(), N);
+
+    // An explicit seed overrides the default one:
+    const auto tl3 = mp2p_icp::Matcher_Points_Base::transform_local_to_global(
+        pc, pose, N, 42);
+    ASSERT_(*tl1.idxs != *tl3.idxs);
+
+    mp2p_icp::set_reproducible_mode(false);
+    ASSERT_EQUAL_(mp2p_icp::resolve_random_seed(42), 42U);
+    ASSERT_NOT_EQUAL_(mp2p_icp::resolve_random_seed(0), 0U);
+}
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_philox_known_answers();
+        test_counter_rng_streams();
+        test_reproducible_local_sampling();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
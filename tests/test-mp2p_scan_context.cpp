@@ -0,0 +1,115 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_scan_context.cpp
+ * @brief  Unit tests for Scan Context-like place recognition descriptors
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp/ScanContext.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+// A synthetic scene: a number of vertical pillars of random heights.
+mrpt::maps::CSimplePointsMap::Ptr generate_scene(unsigned int seed)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(seed);
+
+    auto pts = mrpt::maps::CSimplePointsMap::Create();
+
+    for (int pillar = 0; pillar < 60; pillar++)
+    {
+        const double x = rng.drawUniform(-40.0, 40.0);
+        const double y = rng.drawUniform(-40.0, 40.0);
+        const double h = rng.drawUniform(0.5, 8.0);
+
+        for (double z = -1.5; z < h; z += 0.1) pts->insertPoint(x, y, z);
+    }
+    return pts;
+}
+
+mp2p_icp::metric_map_t::Ptr as_metric_map(
+    const mrpt::maps::CSimplePointsMap& pts, const mrpt::poses::CPose3D& pose,
+    uint64_t id)
+{
+    auto m = mp2p_icp::metric_map_t::Create();
+
+    auto tf = mrpt::maps::CSimplePointsMap::Create();
+    tf->insertAnotherMap(&pts, -pose);  // points as seen from "pose"
+
+    m->layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = tf;
+    m->id                                           = id;
+    return m;
+}
+
+void test_rotation_invariance()
+{
+    const auto scene = generate_scene(123);
+
+    const mp2p_icp::ScanContextParameters p;
+
+    const auto yaw  = mrpt::DEG2RAD(36.0);
+    const auto mRef = as_metric_map(*scene, {}, 0);
+    const auto mRot =
+        as_metric_map(*scene, mrpt::poses::CPose3D(0, 0, 0, yaw, 0, 0), 1);
+
+    const auto dRef = mp2p_icp::scan_context_descriptor(*mRef, "raw", p);
+    const auto dRot = mp2p_icp::scan_context_descriptor(*mRot, "raw", p);
+
+    const auto r = mp2p_icp::scan_context_distance(dRot, dRef);
+
+    ASSERT_LT_(r.distance, 0.05);
+    ASSERT_NEAR_(r.yaw, yaw, mrpt::DEG2RAD(6.0 + 1e-3));
+}
+
+void test_database_query()
+{
+    mp2p_icp::ScanContextDatabase db;
+
+    constexpr unsigned int N = 20;
+    for (unsigned int i = 0; i < N; i++)
+        db.add(*as_metric_map(*generate_scene(1000 + i), {}, i), "raw");
+
+    ASSERT_EQUAL_(db.size(), N);
+
+    // Query with a slightly displaced and rotated view of scene #7:
+    const auto query = as_metric_map(
+        *generate_scene(1000 + 7),
+        mrpt::poses::CPose3D(0.3, -0.2, 0, mrpt::DEG2RAD(-100.0), 0, 0), 999);
+
+    const auto matches = db.query(
+        mp2p_icp::scan_context_descriptor(*query, "raw", db.params), 3);
+
+    ASSERT_EQUAL_(matches.size(), 3UL);
+    ASSERT_(matches.at(0).id.has_value());
+    ASSERT_EQUAL_(*matches.at(0).id, 7U);
+    ASSERT_LT_(matches.at(0).distance.distance, matches.at(1).distance.distance);
+}
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_rotation_invariance();
+        test_database_query();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,180 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_voxel_keys.cpp
+ * @brief  Unit tests for voxel index and packed key policies
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/PointCloudToVoxelGrid.h>
+#include <mp2p_icp_filters/PointCloudToVoxelGridSingle.h>
+#include <mp2p_icp_filters/voxel_keys.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+
+#include <iostream>
+#include <limits>
+#include <set>
+#include <vector>
+
+namespace
+{
+using mp2p_icp_filters::VoxelIndices;
+namespace vk = mp2p_icp_filters::voxel_keys;
+
+void test_floor_rounding()
+{
+    const vk::LinearMapping m(0.5f);
+
+    ASSERT_EQUAL_(m.coord2idx(0.0f), 0);
+    ASSERT_EQUAL_(m.coord2idx(0.1f), 0);
+    ASSERT_EQUAL_(m.coord2idx(0.49f), 0);
+    ASSERT_EQUAL_(m.coord2idx(0.5f), 1);
+    // Negative coordinates round towards -infinity, so [-0.5,0) is a voxel
+    // of its own, not merged with [0,0.5):
+    ASSERT_EQUAL_(m.coord2idx(-0.0f), 0);
+    ASSERT_EQUAL_(m.coord2idx(-0.01f), -1);
+    ASSERT_EQUAL_(m.coord2idx(-0.49f), -1);
+    ASSERT_EQUAL_(m.coord2idx(-0.5f), -1);
+    ASSERT_EQUAL_(m.coord2idx(-0.51f), -2);
+
+    // The quadratic mapping is odd and monotonic:
+    const vk::QuadraticMapping q(0.5f, 10.0f);
+    ASSERT_EQUAL_(q.coord2idx(0.0f), 0);
+    ASSERT_EQUAL_(q.coord2idx(-0.01f), -1);
+    int32_t last = q.coord2idx(-30.0f);
+    for (float x = -30.0f; x <= 30.0f; x += 0.05f)
+    {
+        const int32_t i = q.coord2idx(x);
+        ASSERT_GE_(i, last);
+        last = i;
+    }
+}
+
+template <class Packing>
+void test_round_trips(const char* name)
+{
+    const std::vector<int32_t> values = {
+        0,     1,     -1,    2,     -2,    7,     -8,    100,   -1000,
+        12345, -54321, vk::INDEX_MIN, vk::INDEX_MIN + 1, vk::INDEX_MAX - 1,
+        vk::INDEX_MAX};
+
+    std::set<uint64_t> keys;
+    size_t             n = 0;
+    for (const int32_t x : values)
+    {
+        for (const int32_t y : values)
+        {
+            for (const int32_t z : values)
+            {
+                const VoxelIndices idx(x, y, z);
+                const uint64_t     k = Packing::pack(idx);
+                ASSERT_(Packing::unpack(k) == idx);
+                // Keys only use the lower 63 bits:
+                ASSERT_EQUAL_(k >> 63, 0UL);
+                keys.insert(k);
+                n++;
+            }
+        }
+    }
+    // No collisions:
+    ASSERT_EQUAL_(keys.size(), n);
+
+    std::cout << name << ": " << n << " round trips OK\n";
+}
+
+void test_far_keys()
+{
+    // Indices out of the exact packing range are hashed, not aliased into
+    // voxels near the origin, and never throw:
+    std::set<uint64_t> keys;
+    size_t             n = 0;
+    for (const int32_t bad :
+         {vk::INDEX_MAX + 1, vk::INDEX_MIN - 1, vk::INDEX_MAX * 2,
+          std::numeric_limits<int32_t>::max(),
+          std::numeric_limits<int32_t>::min()})
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            VoxelIndices idx(0, 0, 0);
+            (axis == 0 ? idx.cx_ : axis == 1 ? idx.cy_ : idx.cz_) = bad;
+
+            const uint64_t kPlain  = vk::PlainPacking::pack(idx);
+            const uint64_t kMorton = vk::MortonPacking::pack(idx);
+            ASSERT_(vk::is_far_key(kPlain));
+            ASSERT_(vk::is_far_key(kMorton));
+            ASSERT_(kPlain != std::numeric_limits<uint64_t>::max());
+            keys.insert(kPlain);
+            n++;
+        }
+    }
+    ASSERT_EQUAL_(keys.size(), n);
+    ASSERT_(!vk::is_far_key(vk::PlainPacking::pack({0, 0, 0})));
+
+    // Points in a georeferenced (UTM-like) map, 2 cm voxels:
+    mp2p_icp_filters::LinearVoxelKeys kp;
+    kp.mapping.setResolution(0.02f);
+    const float x0 = 430000.0f, y0 = 4500000.0f;
+
+    const uint64_t k1 = kp.key(x0, y0, 0.01f);
+    ASSERT_(vk::is_far_key(k1));
+    ASSERT_EQUAL_(kp.key(x0, y0, 0.015f), k1);  // same voxel
+    ASSERT_(kp.key(x0 + 0.5f, y0, 0.01f) != k1);
+    ASSERT_(kp.key(x0, y0, 0.05f) != k1);
+    ASSERT_(kp.key(0, 0, 0) != k1);
+
+    // The voxel grids report the right indices for far voxels:
+    auto pc = mrpt::maps::CSimplePointsMap::Create();
+    for (int i = 0; i < 10; i++)
+        pc->insertPoint(x0 + i * 0.5f, y0 - i * 0.5f, i * 0.1f);
+    pc->insertPoint(0.01f, 0.01f, 0.01f);
+
+    mp2p_icp_filters::PointCloudToVoxelGridSingle single;
+    single.setResolution(0.02f);
+    single.processPointCloud(*pc);
+    ASSERT_EQUAL_(single.size(), pc->size());
+    single.visit_voxels(
+        [&](const VoxelIndices& idx, const auto& vxl)
+        {
+            const auto& p = vxl.point.value();
+            ASSERT_(idx == kp.indices(p.x, p.y, p.z));
+        });
+
+    mp2p_icp_filters::PointCloudToVoxelGrid grid;
+    grid.setResolution(0.02f);
+    grid.processPointCloud(*pc);
+    ASSERT_EQUAL_(grid.size(), pc->size());
+    grid.visit_voxels(
+        [&](const VoxelIndices& idx, const auto& vxl)
+        {
+            ASSERT_EQUAL_(vxl.indices.size(), 1UL);
+            float x, y, z;
+            pc->getPoint(vxl.indices.at(0), x, y, z);
+            ASSERT_(idx == kp.indices(x, y, z));
+        });
+
+    std::cout << "Far voxel keys: OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_floor_rounding();
+        test_round_trips<vk::PlainPacking>("PlainPacking");
+        test_round_trips<vk::MortonPacking>("MortonPacking");
+        test_far_keys();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
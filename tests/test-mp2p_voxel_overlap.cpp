@@ -0,0 +1,139 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_voxel_overlap.cpp
+ * @brief  Unit tests for estimate_voxel_overlap() and VoxelOverlapIndex
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mp2p_icp_filters/estimate_voxel_overlap.h>
+#include <mp2p_icp_filters/voxel_keys.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <iostream>
+#include <set>
+
+namespace
+{
+using mp2p_icp_filters::VoxelOverlapIndex;
+using mp2p_icp_filters::VoxelOverlapParameters;
+
+mp2p_icp::metric_map_t make_map(size_t n, float size, float dx)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+
+    auto pc = mrpt::maps::CSimplePointsMap::Create();
+    for (size_t i = 0; i < n; i++)
+    {
+        pc->insertPoint(
+            dx + rng.drawUniform<float>(-size, size),
+            rng.drawUniform<float>(-size, size),
+            rng.drawUniform<float>(-2.0f, 2.0f));
+    }
+    mp2p_icp::metric_map_t m;
+    m.layers["raw"] = pc;
+    return m;
+}
+
+// Reference implementation with std::set:
+std::set<uint64_t> voxel_set(
+    const mp2p_icp::metric_map_t& m, const mrpt::poses::CPose3D& pose,
+    float voxelSize)
+{
+    mp2p_icp_filters::LinearVoxelKeys kp;
+    kp.mapping.setResolution(voxelSize);
+
+    std::set<uint64_t> s;
+    const auto         pc = m.point_layer("raw");
+    for (size_t i = 0; i < pc->size(); i++)
+    {
+        float lx, ly, lz;
+        pc->getPoint(i, lx, ly, lz);
+        mrpt::math::TPoint3Df g;
+        pose.composePoint(lx, ly, lz, g.x, g.y, g.z);
+        s.insert(kp.key(g.x, g.y, g.z));
+    }
+    return s;
+}
+
+void test_index_queries()
+{
+    mrpt::random::getRandomGenerator().randomize(1234);
+
+    const auto global = make_map(50'000, 50.0f, 0.0f);
+    const auto local  = make_map(5'000, 10.0f, 20.0f);
+
+    VoxelOverlapParameters params;
+    params.voxel_size = 1.0f;
+
+    const VoxelOverlapIndex index(global, params);
+
+    const auto globalSet = voxel_set(global, {}, params.voxel_size);
+    ASSERT_EQUAL_(index.size(), globalSet.size());
+
+    const std::vector<mrpt::poses::CPose3D> candidates = {
+        mrpt::poses::CPose3D(),
+        mrpt::poses::CPose3D(-10.0, 5.0, 0.0, 0.3, 0, 0),
+        mrpt::poses::CPose3D(25.0, -30.0, 1.0, -1.0, 0, 0),
+        mrpt::poses::CPose3D(500.0, 0.0, 0.0, 0, 0, 0)};
+
+    for (const auto& pose : candidates)
+    {
+        const auto r = mp2p_icp_filters::estimate_voxel_overlap(
+            index, local, pose);
+        const auto rOneShot = mp2p_icp_filters::estimate_voxel_overlap(
+            global, local, pose, params);
+
+        // Reference values:
+        const auto localSet = voxel_set(local, pose, params.voxel_size);
+        size_t     common   = 0;
+        for (const auto k : localSet) common += globalSet.count(k);
+
+        ASSERT_EQUAL_(r.globalVoxels, globalSet.size());
+        ASSERT_EQUAL_(r.localVoxels, localSet.size());
+        ASSERT_EQUAL_(r.commonVoxels, common);
+        ASSERT_NEAR_(
+            r.overlap, static_cast<double>(common) / localSet.size(), 1e-12);
+
+        ASSERT_EQUAL_(rOneShot.globalVoxels, r.globalVoxels);
+        ASSERT_EQUAL_(rOneShot.localVoxels, r.localVoxels);
+        ASSERT_EQUAL_(rOneShot.commonVoxels, r.commonVoxels);
+        ASSERT_EQUAL_(rOneShot.jaccard, r.jaccard);
+    }
+
+    // Far away: no overlap at all:
+    const auto rFar = mp2p_icp_filters::estimate_voxel_overlap(
+        index, local, candidates.back());
+    ASSERT_EQUAL_(rFar.commonVoxels, 0UL);
+    ASSERT_EQUAL_(rFar.overlap, 0.0);
+
+    // A map against itself:
+    const auto rSelf = mp2p_icp_filters::estimate_voxel_overlap(
+        index, global, mrpt::poses::CPose3D());
+    ASSERT_EQUAL_(rSelf.overlap, 1.0);
+    ASSERT_EQUAL_(rSelf.jaccard, 1.0);
+
+    std::cout << "VoxelOverlapIndex: " << index.size() << " voxels, OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_index_queries();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}